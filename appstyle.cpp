@@ -0,0 +1,157 @@
+#include "appstyle.h"
+#include <QApplication>
+
+namespace {
+
+/// Таблица стилей всех виджетов приложения
+constexpr char STYLE_SHEET[] = R"(
+QWidget#centralWidget {
+    background-color: #fafafa;
+}
+
+QLabel#titleLabel {
+    font-size: 24px;
+    font-weight: bold;
+    color: #333;
+    margin-bottom: 10px;
+}
+
+QLineEdit#taskInput {
+    border: 2px solid #ddd;
+    border-radius: 20px;
+    padding: 5px 15px;
+    font-size: 13px;
+}
+QLineEdit#taskInput:focus {
+    border: 2px solid #4CAF50;
+}
+
+QPushButton#addButton, QPushButton#importButton, QPushButton#deleteButton {
+    background-color: #2196F3;
+    color: white;
+    border: none;
+    border-radius: 20px;
+    font-weight: bold;
+    font-size: 13px;
+}
+QPushButton#addButton:hover, QPushButton#importButton:hover {
+    background-color: #0b7dda;
+}
+QPushButton#selectAllButton, QPushButton#startSelectedButton, QPushButton#stopSelectedButton {
+    background-color: #e3f2fd;
+    color: #1976D2;
+    border: 1px solid #90caf9;
+    border-radius: 17px;
+    font-weight: bold;
+    font-size: 12px;
+}
+QPushButton#selectAllButton:hover, QPushButton#startSelectedButton:hover, QPushButton#stopSelectedButton:hover {
+    background-color: #bbdefb;
+}
+QPushButton#deleteButton {
+    background-color: #f44336;
+}
+QPushButton#deleteButton:hover {
+    background-color: #da190b;
+}
+
+QLabel#filterLabel, QLabel#sortLabel, QCheckBox#groupsCheck {
+    font-weight: bold;
+    font-size: 13px;
+}
+
+QComboBox#filterCombo, QComboBox#sortCombo, QSpinBox#staggerSpin {
+    border: 1px solid #ddd;
+    border-radius: 8px;
+    padding: 5px 15px;
+    background-color: white;
+    font-size: 13px;
+}
+QComboBox#filterCombo:focus, QComboBox#sortCombo:focus, QSpinBox#staggerSpin:focus {
+    border: 1px solid #2196F3;
+}
+QComboBox#filterCombo::drop-down, QComboBox#sortCombo::drop-down {
+    border: none;
+}
+QComboBox#filterCombo QAbstractItemView, QComboBox#sortCombo QAbstractItemView {
+    outline: none;
+    border: 1px solid #ddd;
+    border-radius: 8px;
+    background-color: white;
+    selection-background-color: #E3F2FD;
+    selection-color: #1976D2;
+    padding: 4px;
+}
+QComboBox#filterCombo QAbstractItemView::item, QComboBox#sortCombo QAbstractItemView::item {
+    border-radius: 6px;
+}
+QComboBox#filterCombo QAbstractItemView::item:hover, QComboBox#sortCombo QAbstractItemView::item:hover {
+    background-color: #F5F5F5;
+}
+QComboBox#filterCombo QAbstractItemView::item:selected, QComboBox#sortCombo QAbstractItemView::item:selected {
+    background-color: #E3F2FD;
+    color: #1976D2;
+}
+
+QListView#taskList, QTreeView#taskTree {
+    background-color: #f0f0f0;
+    border: none;
+    border-radius: 15px;
+    outline: none;
+}
+QListView#taskList::item, QTreeView#taskTree::item {
+    border: none;
+    background: transparent;
+}
+QListView#taskList::item:hover, QTreeView#taskTree::item:hover {
+    background: transparent;
+}
+QListView#taskList QScrollBar:vertical, QTreeView#taskTree QScrollBar:vertical {
+    border: none;
+    background: #f0f0f0;
+    width: 8px;
+    margin: 0px;
+    border-radius: 4px;
+}
+QListView#taskList QScrollBar::handle:vertical, QTreeView#taskTree QScrollBar::handle:vertical {
+    background: #bbb;
+    min-height: 20px;
+    border-radius: 4px;
+}
+QListView#taskList QScrollBar::handle:vertical:hover, QTreeView#taskTree QScrollBar::handle:vertical:hover {
+    background: #999;
+}
+QListView#taskList QScrollBar::add-line:vertical, QListView#taskList QScrollBar::sub-line:vertical,
+QTreeView#taskTree QScrollBar::add-line:vertical, QTreeView#taskTree QScrollBar::sub-line:vertical {
+    height: 0px;
+}
+
+QLabel#statusLabel {
+    color: #555;
+    font-size: 12px;
+    padding: 2px 10px;
+}
+
+QLabel#performanceOverlay {
+    background-color: rgba(33, 33, 33, 200);
+    color: #e0e0e0;
+    font-family: monospace;
+    font-size: 11px;
+    padding: 8px;
+    border-radius: 8px;
+}
+)";
+
+} // namespace
+
+QString AppStyle::styleSheet()
+{
+    return QString::fromUtf8(STYLE_SHEET);
+}
+
+void AppStyle::apply()
+{
+    const QString sheet = styleSheet();
+    if (qApp->styleSheet() != sheet)
+        qApp->setStyleSheet(sheet);
+}
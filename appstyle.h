@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QString>
+
+/**
+ * @class AppStyle
+ * @brief Единая таблица стилей приложения
+ *
+ * Стили всех виджетов собраны в одну таблицу уровня приложения с
+ * селекторами по objectName. Таблица разбирается один раз при установке,
+ * а виджеты получают оформление при первом показе без отдельного разбора
+ * и повторной полировки для каждого виджета.
+ */
+class AppStyle
+{
+public:
+    AppStyle() = delete;
+
+    /**
+     * @brief Получить таблицу стилей приложения
+     * @return Текст QSS
+     */
+    static QString styleSheet();
+
+    /**
+     * @brief Установить таблицу стилей приложения
+     *
+     * Вызывается до создания виджетов; повторная установка той же
+     * таблицы не выполняется.
+     */
+    static void apply();
+};
@@ -0,0 +1,1549 @@
+#include "benchmarkrunner.h"
+#include "controlprotocol.h"
+#include "instrumentation.h"
+#include "metricsexporter.h"
+#include "monotonicclock.h"
+#include "processinfo.h"
+#include "sessionsnapshot.h"
+#include "taskarchive.h"
+#include "taskdelegate.h"
+#include "taskimporter.h"
+#include "taskmanager.h"
+#include "taskmodel.h"
+#include "taskpool.h"
+#include "taskproxymodel.h"
+#include "tasktreemodel.h"
+#include "workloadreplayer.h"
+#include "workloadtrace.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QIdentityProxyModel>
+#include <QListView>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTimer>
+#ifdef DRW_MODEL_TESTER
+#include <QAbstractItemModelTester>
+#endif
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+
+namespace {
+
+/// Перевести байты в мегабайты для вывода
+double toMegabytes(qint64 bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+/// Получить перцентиль отсортированной выборки
+qint64 percentile(const QList<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty())
+        return 0;
+    const int index = qBound(0, static_cast<int>(fraction * (sorted.count() - 1) + 0.5),
+                             static_cast<int>(sorted.count()) - 1);
+    return sorted.at(index);
+}
+
+/// Название формата файла импорта для вывода
+QString importFormatName(const QString &path)
+{
+    return path.endsWith(".csv") ? "CSV   " : "NDJSON";
+}
+
+/// Вывести перцентили гистограммы длительностей (нс) в миллисекундах
+QString histogramSummary(const LatencyHistogram &histogram)
+{
+    return QString("p50 %1 мс, p90 %2 мс, p99 %3 мс, max %4 мс (%5 замеров)")
+        .arg(histogram.percentile(0.50) / 1e6, 0, 'f', 2)
+        .arg(histogram.percentile(0.90) / 1e6, 0, 'f', 2)
+        .arg(histogram.percentile(0.99) / 1e6, 0, 'f', 2)
+        .arg(histogram.max() / 1e6, 0, 'f', 2)
+        .arg(histogram.count());
+}
+
+/// Проверить, что текст соответствует формату Prometheus exposition
+bool isValidExposition(const QByteArray &body)
+{
+    static const QRegularExpression sample(
+        "^[a-zA-Z_:][a-zA-Z0-9_:]*(\\{[^}]*\\})? [-+0-9.eEInfa]+$");
+
+    int samples = 0;
+    for (const QByteArray &line : body.split('\n'))
+    {
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        if (!sample.match(QString::fromUtf8(line)).hasMatch())
+            return false;
+        ++samples;
+    }
+    return samples > 0;
+}
+
+/// Сформировать запрос с идентификаторами задач
+QByteArray taskIdsPayload(quint8 opcode, const QList<quint64> &ids)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(ControlProtocol::STREAM_VERSION);
+    out << opcode << static_cast<quint32>(ids.count());
+    for (quint64 id : ids)
+        out << id;
+    return payload;
+}
+
+/// Сообщения QAbstractItemModelTester о нарушениях, накопленные обработчиком
+int modelTesterFailures = 0;
+
+/// Прежний обработчик сообщений Qt
+QtMessageHandler previousMessageHandler = nullptr;
+
+/// Считать сообщения QAbstractItemModelTester и передавать их прежнему обработчику
+void countModelTesterMessages(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (type != QtDebugMsg && context.category && qstrcmp(context.category, "qt.modeltest") == 0)
+        ++modelTesterFailures;
+    if (previousMessageHandler)
+        previousMessageHandler(type, context, message);
+}
+
+/// Проверить согласованность модели, прокси и дерева групп; пустая строка - нарушений нет
+QString checkModelInvariants(const TaskModel &model, const TaskProxyModel &proxy, const TaskTreeModel &tree)
+{
+    const TaskStatistics &statistics = model.statistics();
+    const int liveRows = model.rowCount() - model.coldTasks().count() - model.archivedRowCount();
+
+    if (statistics.total != liveRows + model.coldTasks().count())
+        return QString("total %1 != строк %2").arg(statistics.total).arg(liveRows + model.coldTasks().count());
+    if (statistics.running + statistics.stopped + statistics.completed != statistics.total)
+        return "running + stopped + completed != total";
+
+    int histogramTotal = 0;
+    for (int count : statistics.histogram)
+        histogramTotal += count;
+    if (histogramTotal != statistics.total)
+        return QString("гистограмма %1 != total %2").arg(histogramTotal).arg(statistics.total);
+
+    int running = 0;
+    int completed = model.coldTasks().count();
+    QSet<quint64> ids;
+    for (int row = 0; row < liveRows; ++row)
+    {
+        const Task *task = model.getTask(row);
+        if (!task)
+            return QString("нет задачи в строке %1").arg(row);
+        if (task->modelRow() != row || model.rowOfTask(task->getId()) != row)
+            return QString("строка задачи %1: modelRow %2, rowOfTask %3")
+                .arg(row).arg(task->modelRow()).arg(model.rowOfTask(task->getId()));
+        if (!model.hasTaskWithName(task->getName()))
+            return QString("название задачи в строке %1 отсутствует в индексе").arg(row);
+        if (ids.contains(task->getId()))
+            return QString("повтор идентификатора %1").arg(task->getId());
+        ids.insert(task->getId());
+        running += task->isRunning() ? 1 : 0;
+        completed += !task->isRunning() && task->reportedProgress() >= Task::MAX_PROGRESS ? 1 : 0;
+    }
+    for (int index = 0; index < model.coldTasks().count(); ++index)
+    {
+        if (model.rowOfTask(model.coldTasks().id(index)) != liveRows + index)
+            return QString("строка хранилища %1 не найдена по идентификатору").arg(index);
+    }
+    if (running != statistics.running || completed != statistics.completed)
+        return QString("пересчёт: running %1/%2, completed %3/%4")
+            .arg(running).arg(statistics.running).arg(completed).arg(statistics.completed);
+
+    int accepted = 0;
+    for (int row = 0; row < model.rowCount(); ++row)
+    {
+        const bool isRunning = model.data(model.index(row), TaskModel::RunningRole).toBool();
+        accepted += proxy.filterType() == TaskProxyModel::All
+            || (proxy.filterType() == TaskProxyModel::Active) == isRunning ? 1 : 0;
+    }
+    if (proxy.rowCount() != accepted)
+        return QString("строк прокси %1, проходят фильтр %2").arg(proxy.rowCount()).arg(accepted);
+
+    QSet<int> sourceRows;
+    for (int row = 0; row < proxy.rowCount(); ++row)
+    {
+        const QModelIndex source = proxy.mapToSource(proxy.index(row, 0));
+        if (!source.isValid() || proxy.mapFromSource(source).row() != row || sourceRows.contains(source.row()))
+            return QString("отображение строки прокси %1 -> %2").arg(row).arg(source.row());
+        sourceRows.insert(source.row());
+    }
+
+    const QString aggregates = tree.verifyAggregates();
+    if (!aggregates.isEmpty())
+        return QString("сводки дерева групп: %1").arg(aggregates);
+    return QString();
+}
+
+/// Строки исходной модели в порядке строк прокси
+QList<int> proxySourceRows(const TaskProxyModel &proxy)
+{
+    QList<int> rows;
+    rows.reserve(proxy.rowCount());
+    for (int row = 0; row < proxy.rowCount(); ++row)
+        rows.append(proxy.mapToSource(proxy.index(row, 0)).row());
+    return rows;
+}
+
+#ifdef DRW_COROUTINES
+/// Этап ожидания: несколько пауз с сообщением доли выполнения
+StagedWork waitSteps(StageContext &context, int steps)
+{
+    for (int step = 1; step <= steps; ++step)
+    {
+        co_await context.sleep(QRandomGenerator::global()->bounded(50, 250));
+        context.setStageProgress(double(step) / steps);
+    }
+}
+
+/// Этап вычислений в пуле потоков
+StagedWork computeChecksum(StageContext &context)
+{
+    const quint64 seed = QRandomGenerator::global()->generate64();
+    const quint64 checksum = co_await context.inPool([seed]() {
+        quint64 value = seed;
+        for (int i = 0; i < 4096; ++i)
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        return value;
+    });
+    context.setStageProgress(checksum != 0 ? 1.0 : 0.5);
+}
+#endif
+
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner()
+    : m_out(stdout)
+{
+}
+
+int BenchmarkRunner::run(const QString &name, const QStringList &arguments)
+{
+    if (name == "churn")
+        return runChurn();
+    if (name == "control-load")
+        return runControlLoad(arguments);
+    if (name == "import")
+        return runImport(arguments);
+    if (name == "latency")
+        return runLatency(arguments);
+    if (name == "metrics")
+        return runMetrics(arguments);
+    if (name == "progress-modes")
+        return runProgressModes(arguments);
+    if (name == "archive")
+        return runArchive(arguments);
+    if (name == "cold-tier")
+        return runColdTier(arguments);
+    if (name == "startup")
+        return runStartup(arguments);
+    if (name == "processes")
+        return runProcesses(arguments);
+    if (name == "chatter")
+        return runChatter(arguments);
+    if (name == "stages")
+        return runStages(arguments);
+    if (name == "replay")
+        return runReplay(arguments);
+    if (name == "soak")
+        return runSoak(arguments);
+    if (name == "filter")
+        return runFilter(arguments);
+    if (name == "row-access")
+        return runRowAccess(arguments);
+
+    m_out << "Неизвестный бенчмарк: " << name << Qt::endl
+          << "Доступные: " << availableBenchmarks().join(", ") << Qt::endl;
+    return 1;
+}
+
+QStringList BenchmarkRunner::availableBenchmarks()
+{
+    return {"churn", "control-load", "import", "latency", "metrics", "progress-modes", "archive", "cold-tier", "startup", "processes", "stages", "replay", "soak", "filter", "row-access"};
+}
+
+int BenchmarkRunner::runChurn()
+{
+    QStringList names;
+    names.reserve(CHURN_BATCH_SIZE);
+    for (int i = 0; i < CHURN_BATCH_SIZE; ++i)
+        names.append(QString("Задача %1").arg(i));
+
+    const qint64 total = qint64(CHURN_BATCH_SIZE) * CHURN_CYCLES;
+    QList<Task*> tasks;
+    tasks.reserve(CHURN_BATCH_SIZE);
+
+    // Создание через new/delete
+    const qint64 heapRssBefore = ProcessInfo::residentMemory();
+    QElapsedTimer timer;
+    timer.start();
+    for (int cycle = 0; cycle < CHURN_CYCLES; ++cycle)
+    {
+        for (const QString &name : names)
+            tasks.append(new Task(name));
+        qDeleteAll(tasks);
+        tasks.clear();
+    }
+    const qint64 heapNs = timer.nsecsElapsed();
+    const qint64 heapRssAfter = ProcessInfo::residentMemory();
+
+    // Создание через пул
+    TaskPool pool;
+    const qint64 poolRssBefore = ProcessInfo::residentMemory();
+    timer.restart();
+    for (int cycle = 0; cycle < CHURN_CYCLES; ++cycle)
+    {
+        for (const QString &name : names)
+            tasks.append(pool.acquire(name));
+        for (Task *task : tasks)
+            pool.release(task);
+        tasks.clear();
+    }
+    const qint64 poolNs = timer.nsecsElapsed();
+    const qint64 poolRssAfter = ProcessInfo::residentMemory();
+
+    const auto rate = [total](qint64 ns) { return total * 1e9 / qMax<qint64>(ns, 1); };
+    const TaskPool::Statistics stats = pool.statistics();
+
+    m_out << "churn: " << CHURN_CYCLES << " циклов по " << CHURN_BATCH_SIZE << " задач" << Qt::endl;
+    m_out << QString("  new/delete: %1 задач/с, прирост RSS %2 МБ")
+                 .arg(rate(heapNs), 0, 'f', 0)
+                 .arg(toMegabytes(heapRssAfter - heapRssBefore), 0, 'f', 2) << Qt::endl;
+    m_out << QString("  TaskPool:   %1 задач/с, прирост RSS %2 МБ")
+                 .arg(rate(poolNs), 0, 'f', 0)
+                 .arg(toMegabytes(poolRssAfter - poolRssBefore), 0, 'f', 2) << Qt::endl;
+    m_out << QString("  пул: выдано %1, создано %2, повторно %3, слэбов %4, свободно %5")
+                 .arg(stats.acquired).arg(stats.constructed).arg(stats.reused)
+                 .arg(stats.slabs).arg(stats.free) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runControlLoad(const QStringList &arguments)
+{
+    const QString serverName = arguments.value(0, "drw-control");
+    const int batchSize = qMax(1, arguments.value(1).toInt() > 0 ? arguments.value(1).toInt()
+                                                                  : CONTROL_BATCH_SIZE);
+    const int rounds = qMax(1, arguments.value(2).toInt() > 0 ? arguments.value(2).toInt()
+                                                               : CONTROL_ROUNDS);
+
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(CONTROL_TIMEOUT))
+    {
+        m_out << "Не удалось подключиться к " << serverName << ": "
+              << socket.errorString() << Qt::endl;
+        return 1;
+    }
+
+    QByteArray buffer;
+    QByteArray reply;
+    qint64 deltas = 0;
+    QList<qint64> latencies;
+    latencies.reserve(rounds * 4);
+
+    // Подписываемся, чтобы нагрузка включала рассылку изменений прогресса
+    QByteArray subscribe;
+    {
+        QDataStream out(&subscribe, QIODevice::WriteOnly);
+        out.setVersion(ControlProtocol::STREAM_VERSION);
+        out << static_cast<quint8>(ControlProtocol::Subscribe) << static_cast<quint8>(1);
+    }
+    if (!controlRequest(socket, buffer, subscribe, reply, deltas))
+        return 1;
+
+    const QString prefix = QString("load-%1").arg(QCoreApplication::applicationPid());
+    qint64 commands = 0;
+    QElapsedTimer total;
+    total.start();
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        QByteArray add;
+        {
+            QDataStream out(&add, QIODevice::WriteOnly);
+            out.setVersion(ControlProtocol::STREAM_VERSION);
+            out << static_cast<quint8>(ControlProtocol::AddTasks) << static_cast<quint32>(batchSize);
+            for (int i = 0; i < batchSize; ++i)
+                out << QString("%1-%2-%3").arg(prefix).arg(round).arg(i);
+        }
+
+        QElapsedTimer request;
+        request.start();
+        if (!controlRequest(socket, buffer, add, reply, deltas))
+            return 1;
+        latencies.append(request.nsecsElapsed());
+
+        // Ответ: код, количество, идентификаторы
+        QList<quint64> ids;
+        {
+            QDataStream in(reply);
+            in.setVersion(ControlProtocol::STREAM_VERSION);
+            quint8 opcode = 0;
+            quint32 count = 0;
+            in >> opcode >> count;
+            for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+            {
+                quint64 id = 0;
+                in >> id;
+                if (id != 0)
+                    ids.append(id);
+            }
+        }
+
+        for (quint8 opcode : {quint8(ControlProtocol::StartTasks),
+                              quint8(ControlProtocol::StopTasks),
+                              quint8(ControlProtocol::RemoveTasks)})
+        {
+            request.restart();
+            if (!controlRequest(socket, buffer, taskIdsPayload(opcode, ids), reply, deltas))
+                return 1;
+            latencies.append(request.nsecsElapsed());
+        }
+
+        commands += qint64(batchSize) + 3 * ids.count();
+    }
+
+    const double seconds = total.nsecsElapsed() / 1e9;
+    std::sort(latencies.begin(), latencies.end());
+
+    m_out << "control-load: " << rounds << " раундов по " << batchSize << " задач" << Qt::endl;
+    m_out << QString("  %1 команд/с, %2 запросов/с, уведомлений о прогрессе: %3")
+                 .arg(commands / seconds, 0, 'f', 0)
+                 .arg(latencies.count() / seconds, 0, 'f', 1)
+                 .arg(deltas) << Qt::endl;
+    m_out << QString("  задержка запроса: p50 %1 мс, p99 %2 мс")
+                 .arg(percentile(latencies, 0.50) / 1e6, 0, 'f', 2)
+                 .arg(percentile(latencies, 0.99) / 1e6, 0, 'f', 2) << Qt::endl;
+    return 0;
+}
+
+bool BenchmarkRunner::controlRequest(QLocalSocket &socket, QByteArray &buffer,
+                                     const QByteArray &payload, QByteArray &reply,
+                                     qint64 &deltas)
+{
+    const quint8 expected = static_cast<quint8>(payload.at(0)) | ControlProtocol::REPLY_FLAG;
+    socket.write(ControlProtocol::frame(payload));
+
+    for (;;)
+    {
+        int offset = 0;
+        QByteArray frame;
+        bool found = false;
+        while (!found && ControlProtocol::readFrame(buffer, offset, frame))
+        {
+            const quint8 opcode = frame.isEmpty() ? 0 : static_cast<quint8>(frame.at(0));
+            if (opcode == ControlProtocol::ProgressDeltas)
+                ++deltas;
+            else if (opcode == expected)
+                found = true;
+            else if (opcode == ControlProtocol::Error)
+            {
+                m_out << "Сервер вернул ошибку" << Qt::endl;
+                return false;
+            }
+        }
+        buffer.remove(0, offset);
+
+        if (found)
+        {
+            reply = frame;
+            return true;
+        }
+
+        if (!socket.waitForReadyRead(CONTROL_TIMEOUT))
+        {
+            m_out << "Нет ответа сервера: " << socket.errorString() << Qt::endl;
+            return false;
+        }
+        buffer.append(socket.readAll());
+    }
+}
+
+int BenchmarkRunner::runImport(const QStringList &arguments)
+{
+    const int rows = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : IMPORT_ROWS;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        m_out << "Не удалось создать временный каталог" << Qt::endl;
+        return 1;
+    }
+
+    const QString csvPath = dir.filePath("tasks.csv");
+    const QString jsonPath = dir.filePath("tasks.ndjson");
+    {
+        QFile csv(csvPath);
+        QFile json(jsonPath);
+        if (!csv.open(QIODevice::WriteOnly) || !json.open(QIODevice::WriteOnly))
+        {
+            m_out << "Не удалось создать файлы импорта" << Qt::endl;
+            return 1;
+        }
+
+        csv.write("name,priority\n");
+        for (int i = 0; i < rows; ++i)
+        {
+            const QByteArray name = "Задача импорта " + QByteArray::number(i);
+            csv.write(name + "," + QByteArray::number(i % 5) + "\n");
+            json.write("{\"name\": \"" + name + "\", \"priority\": " + QByteArray::number(i % 5) + "}\n");
+        }
+    }
+
+    m_out << "import: " << rows << " строк" << Qt::endl;
+    for (const QString &path : {csvPath, jsonPath})
+    {
+        qint64 received = 0;
+        QElapsedTimer timer;
+        timer.start();
+        const TaskImporter::Result result = TaskImporter::importFile(
+            path, {}, [&received](const QStringList &names) {
+                received += names.size();
+                return true;
+            });
+        const double seconds = qMax<qint64>(timer.nsecsElapsed(), 1) / 1e9;
+
+        if (!result.error.isEmpty() || received != rows)
+        {
+            m_out << "  " << path << ": ошибка импорта " << result.error
+                  << " (получено " << received << ")" << Qt::endl;
+            return 1;
+        }
+
+        m_out << QString("  %1: %2 строк/с, %3 МБ/с")
+                     .arg(importFormatName(path))
+                     .arg(rows / seconds, 0, 'f', 0)
+                     .arg(toMegabytes(result.bytes) / seconds, 0, 'f', 1) << Qt::endl;
+    }
+    return 0;
+}
+
+int BenchmarkRunner::runLatency(const QStringList &arguments)
+{
+    if (!Instrumentation::isEnabled())
+    {
+        m_out << "latency: приложение собрано без DRW_INSTRUMENTATION" << Qt::endl;
+        return 1;
+    }
+
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : LATENCY_TASKS;
+    const int seconds = arguments.value(1).toInt() > 0 ? arguments.value(1).toInt() : LATENCY_SECONDS;
+
+    TaskModel model;
+    TaskProxyModel proxy;
+    proxy.setSourceModel(&model);
+    TaskDelegate delegate;
+
+    QListView view;
+    view.setModel(&proxy);
+    view.setItemDelegate(&delegate);
+    view.resize(900, 800);
+    view.show();
+
+    QStringList names;
+    names.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        names.append(QString("Задача %1").arg(i));
+    model.addTasks(names);
+
+    QList<int> rows;
+    rows.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        rows.append(i);
+
+    const LatencyHistogram tickToPixelBefore = Instrumentation::section(Instrumentation::TickToPixelSection);
+    const LatencyHistogram paintBefore = Instrumentation::section(Instrumentation::PaintSection);
+    const quint64 ticksBefore = Instrumentation::counter(Instrumentation::Ticks);
+    model.startTasks(rows);
+
+    QEventLoop loop;
+    QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    const LatencyHistogram tickToPixel = Instrumentation::section(Instrumentation::TickToPixelSection)
+                                             .difference(tickToPixelBefore);
+    const LatencyHistogram paint = Instrumentation::section(Instrumentation::PaintSection)
+                                       .difference(paintBefore);
+    const quint64 ticks = Instrumentation::counter(Instrumentation::Ticks) - ticksBefore;
+
+    m_out << "latency: " << taskCount << " задач, " << seconds << " с, тактов: " << ticks << Qt::endl;
+    m_out << "  tick-to-pixel: " << histogramSummary(tickToPixel) << Qt::endl;
+    m_out << "  paint:         " << histogramSummary(paint) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runMetrics(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : METRICS_TASKS;
+    const int scrapes = arguments.value(1).toInt() > 0 ? arguments.value(1).toInt() : METRICS_SCRAPES;
+
+    TaskModel model;
+    QStringList names;
+    names.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        names.append(QString("Задача %1").arg(i));
+    model.addTasks(names);
+
+    // Запускаем каждую вторую задачу, чтобы счётчики менялись во время опроса
+    QList<int> rows;
+    rows.reserve(taskCount / 2 + 1);
+    for (int i = 0; i < taskCount; i += 2)
+        rows.append(i);
+    model.startTasks(rows);
+
+    MetricsExporter exporter(&model);
+    if (!exporter.listen(0))
+    {
+        m_out << "Не удалось запустить сервер показателей: " << exporter.errorString() << Qt::endl;
+        return 1;
+    }
+
+    QList<qint64> renderTimes;
+    QList<qint64> scrapeTimes;
+    renderTimes.reserve(scrapes);
+    scrapeTimes.reserve(scrapes);
+    qint64 bodyBytes = 0;
+
+    for (int i = 0; i < scrapes; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        const QByteArray rendered = exporter.render();
+        renderTimes.append(timer.nsecsElapsed());
+
+        // Сервер и сборщик работают в одном потоке, поэтому ждём ответ в цикле событий
+        QTcpSocket socket;
+        QByteArray response;
+        QEventLoop loop;
+        QObject::connect(&socket, &QTcpSocket::connected, &socket, [&socket]() {
+            socket.write("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        });
+        QObject::connect(&socket, &QTcpSocket::readyRead, &socket, [&socket, &response]() {
+            response.append(socket.readAll());
+        });
+        QObject::connect(&socket, &QTcpSocket::disconnected, &loop, &QEventLoop::quit);
+        QObject::connect(&socket, &QTcpSocket::errorOccurred, &loop, &QEventLoop::quit);
+        QTimer::singleShot(METRICS_TIMEOUT, &loop, &QEventLoop::quit);
+
+        timer.restart();
+        socket.connectToHost(QHostAddress::LocalHost, exporter.serverPort());
+        loop.exec();
+        scrapeTimes.append(timer.nsecsElapsed());
+
+        const int headerEnd = response.indexOf("\r\n\r\n");
+        const QByteArray body = headerEnd >= 0 ? response.mid(headerEnd + 4) : QByteArray();
+        if (!response.startsWith("HTTP/1.1 200") || !isValidExposition(body) || !isValidExposition(rendered))
+        {
+            m_out << "metrics: некорректный ответ на опрос " << i << Qt::endl
+                  << response.left(512) << Qt::endl;
+            return 1;
+        }
+        bodyBytes = body.size();
+    }
+
+    std::sort(renderTimes.begin(), renderTimes.end());
+    std::sort(scrapeTimes.begin(), scrapeTimes.end());
+
+    m_out << "metrics: " << taskCount << " задач, " << scrapes << " опросов, "
+          << bodyBytes << " байт" << Qt::endl;
+    m_out << QString("  формирование: p50 %1 мкс, p99 %2 мкс")
+                 .arg(percentile(renderTimes, 0.50) / 1000.0, 0, 'f', 1)
+                 .arg(percentile(renderTimes, 0.99) / 1000.0, 0, 'f', 1) << Qt::endl;
+    m_out << QString("  опрос по HTTP: p50 %1 мкс, p99 %2 мкс")
+                 .arg(percentile(scrapeTimes, 0.50) / 1000.0, 0, 'f', 1)
+                 .arg(percentile(scrapeTimes, 0.99) / 1000.0, 0, 'f', 1) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runProgressModes(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : PROGRESS_TASKS;
+    const int seconds = arguments.value(1).toInt() > 0 ? arguments.value(1).toInt() : PROGRESS_SECONDS;
+
+    QStringList names;
+    names.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        names.append(QString("Задача %1").arg(i));
+
+    QList<int> rows;
+    rows.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+        rows.append(i);
+
+    m_out << "progress-modes: " << taskCount << " задач, " << seconds << " с на режим" << Qt::endl;
+    for (const bool computed : {false, true})
+    {
+        TaskModel model;
+        model.setComputedProgress(computed);
+        model.addTasks(names);
+        // Ни одна строка не видна: измеряем стоимость выполнения без наблюдателей
+        model.setViewportRows({});
+
+        qint64 notifications = 0;
+        QObject::connect(&model, &QAbstractItemModel::dataChanged, &model, [&notifications]() {
+            ++notifications;
+        });
+
+        const std::clock_t cpuBefore = std::clock();
+        model.startTasks(rows);
+
+        QEventLoop loop;
+        QTimer::singleShot(seconds * 1000, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        qint64 progressSum = 0;
+        for (int row = 0; row < taskCount; ++row)
+            progressSum += model.getTask(row)->getProgress();
+        const double cpuMs = (std::clock() - cpuBefore) * 1000.0 / CLOCKS_PER_SEC;
+
+        model.stopTasks(rows);
+
+        m_out << QString("  %1 процессор %2 мс, уведомлений %3, средний прогресс %4%")
+                     .arg(computed ? "вычисляемый:" : "такты:     ")
+                     .arg(cpuMs, 0, 'f', 0)
+                     .arg(notifications)
+                     .arg(double(progressSum) / taskCount, 0, 'f', 1) << Qt::endl;
+    }
+    return 0;
+}
+
+int BenchmarkRunner::runArchive(const QStringList &arguments)
+{
+    const int rows = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : ARCHIVE_ROWS;
+    const int cacheMb = arguments.value(1).toInt() > 0 ? arguments.value(1).toInt() : ARCHIVE_CACHE_MB;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        m_out << "Не удалось создать временный каталог" << Qt::endl;
+        return 1;
+    }
+
+    // Архив пишется порциями, как при периодической архивации завершённых задач
+    const QString path = dir.filePath("tasks.archive");
+    const QDateTime origin = QDateTime::currentDateTime().addDays(-365);
+    constexpr int chunk = 100000;
+    QList<TaskArchive::Record> records;
+    records.reserve(chunk);
+    for (int first = 0; first < rows; first += chunk)
+    {
+        records.clear();
+        for (int i = first; i < qMin(rows, first + chunk); ++i)
+            records.append({quint64(i) + 1, QString("Архивная задача %1").arg(i), origin.addSecs(i), 100});
+
+        QString error;
+        if (!TaskArchive::append(path, records, &error))
+        {
+            m_out << "Не удалось записать архив: " << error << Qt::endl;
+            return 1;
+        }
+    }
+
+    const qint64 rssBefore = ProcessInfo::residentMemory();
+
+    TaskModel model;
+    model.setArchiveMemoryLimit(qint64(cacheMb) * 1024 * 1024);
+    if (!model.openArchive(path))
+    {
+        m_out << "Не удалось открыть архив: " << model.archive().errorString() << Qt::endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while (model.canFetchMore(QModelIndex()))
+        model.fetchMore(QModelIndex());
+    const qint64 fetchNs = timer.nsecsElapsed();
+
+    // Последовательное чтение - прокрутка списка от начала до конца
+    qint64 checksum = 0;
+    timer.restart();
+    for (int row = 0; row < model.rowCount(); ++row)
+        checksum += model.data(model.index(row), TaskModel::NameRole).toString().size();
+    const qint64 sequentialNs = timer.nsecsElapsed();
+    const qint64 sequentialLoads = model.archive().pageLoads();
+
+    timer.restart();
+    for (int i = 0; i < ARCHIVE_RANDOM_READS; ++i)
+    {
+        const int row = static_cast<int>(QRandomGenerator::global()->bounded(model.rowCount()));
+        checksum += model.data(model.index(row), TaskModel::ProgressRole).toInt();
+    }
+    const qint64 randomNs = timer.nsecsElapsed();
+    const qint64 rssAfter = ProcessInfo::residentMemory();
+
+    const auto rate = [](qint64 count, qint64 ns) { return count * 1e9 / qMax<qint64>(ns, 1); };
+
+    m_out << "archive: " << rows << " записей, кэш " << cacheMb << " МБ (контрольная сумма "
+          << checksum << ")" << Qt::endl;
+    m_out << QString("  fetchMore:     %1 мс до полной загрузки строк")
+                 .arg(fetchNs / 1e6, 0, 'f', 1) << Qt::endl;
+    m_out << QString("  прокрутка:     %1 строк/с, загрузок страниц %2")
+                 .arg(rate(rows, sequentialNs), 0, 'f', 0)
+                 .arg(sequentialLoads) << Qt::endl;
+    m_out << QString("  случайно:      %1 строк/с, загрузок страниц %2, в кэше %3 страниц")
+                 .arg(rate(ARCHIVE_RANDOM_READS, randomNs), 0, 'f', 0)
+                 .arg(model.archive().pageLoads() - sequentialLoads)
+                 .arg(model.archive().residentPages()) << Qt::endl;
+    m_out << QString("  прирост RSS:   %1 МБ")
+                 .arg(toMegabytes(rssAfter - rssBefore), 0, 'f', 1) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runColdTier(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : COLD_TASKS;
+
+    QStringList names;
+    names.reserve(taskCount);
+    QList<int> rows;
+    rows.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+    {
+        names.append(QString("Задача %1").arg(i));
+        rows.append(i);
+    }
+
+    // Во время выполнения перенос откладывается, чтобы измерить обе формы хранения
+    TaskModel model;
+    model.setComputedProgress(true);
+    model.setColdStorageDelay(std::numeric_limits<int>::max());
+    model.setViewportRows({});
+    model.addTasks(names);
+    model.startTasks(rows);
+
+    QEventLoop loop;
+    QObject::connect(&model, &TaskModel::statisticsChanged, &loop, [&loop](const TaskStatistics &statistics) {
+        if (statistics.completed == statistics.total)
+            loop.quit();
+    });
+    QTimer::singleShot(COLD_COMPLETION_TIMEOUT * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    if (model.statistics().completed != taskCount)
+    {
+        m_out << "Задачи не завершились за " << COLD_COMPLETION_TIMEOUT << " с" << Qt::endl;
+        return 1;
+    }
+
+    const auto readAll = [&model]() {
+        qint64 checksum = 0;
+        for (int row = 0; row < model.rowCount(); ++row)
+        {
+            const QModelIndex index = model.index(row);
+            checksum += model.data(index, TaskModel::NameRole).toString().size()
+                + model.data(index, TaskModel::ProgressRole).toInt();
+        }
+        return checksum;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 checksum = readAll();
+    const qint64 liveReadNs = timer.nsecsElapsed();
+    const TaskPool::Statistics liveStats = model.poolStatistics();
+    const qint64 rssBefore = ProcessInfo::residentMemory();
+
+    model.setColdStorageDelay(0);
+    timer.restart();
+    const int migrated = model.migrateCompletedTasks();
+    const qint64 migrateNs = timer.nsecsElapsed();
+    const TaskPool::Statistics coldStats = model.poolStatistics();
+    const qint64 rssAfter = ProcessInfo::residentMemory();
+
+    timer.restart();
+    checksum -= readAll();
+    const qint64 coldReadNs = timer.nsecsElapsed();
+
+    const auto rate = [](qint64 count, qint64 ns) { return count * 1e9 / qMax<qint64>(ns, 1); };
+
+    m_out << "cold-tier: " << taskCount << " завершённых задач (расхождение чтения "
+          << checksum << ")" << Qt::endl;
+    m_out << QString("  перенос:       %1 задач за %2 мс")
+                 .arg(migrated).arg(migrateNs / 1e6, 0, 'f', 1) << Qt::endl;
+    m_out << QString("  объекты Task:  %1 в %2 слэбах -> %3 в %4 слэбах")
+                 .arg(liveStats.inUse + liveStats.free).arg(liveStats.slabs)
+                 .arg(coldStats.inUse + coldStats.free).arg(coldStats.slabs) << Qt::endl;
+    m_out << QString("  хранилище:     %1 МБ (%2 байт на задачу)")
+                 .arg(toMegabytes(model.coldTasks().memoryUsage()), 0, 'f', 2)
+                 .arg(model.coldTasks().memoryUsage() / qMax(1, migrated)) << Qt::endl;
+    m_out << QString("  RSS:           %1 МБ -> %2 МБ")
+                 .arg(toMegabytes(rssBefore), 0, 'f', 1)
+                 .arg(toMegabytes(rssAfter), 0, 'f', 1) << Qt::endl;
+    m_out << QString("  чтение строк:  %1 строк/с -> %2 строк/с")
+                 .arg(rate(taskCount, liveReadNs), 0, 'f', 0)
+                 .arg(rate(taskCount, coldReadNs), 0, 'f', 0) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runStartup(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : STARTUP_TASKS;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        m_out << "Не удалось создать временный каталог" << Qt::endl;
+        return 1;
+    }
+
+    // Снимок прошлой сессии
+    const QString path = dir.filePath("session.snapshot");
+    {
+        QStringList names;
+        names.reserve(taskCount);
+        for (int i = 0; i < taskCount; ++i)
+            names.append(QString("Задача %1").arg(i));
+
+        TaskModel model;
+        model.setColdStorageDelay(-1);
+        model.addTasks(names);
+
+        QString error;
+        if (!SessionSnapshot::save(path, model, {}, &error))
+        {
+            m_out << "Не удалось записать снимок: " << error << Qt::endl;
+            return 1;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    TaskManager window;
+    window.setSessionFile(path);
+    const qint64 constructedNs = timer.nsecsElapsed();
+
+    qint64 firstFrameNs = -1;
+    qint64 interactiveNs = -1;
+    int restored = 0;
+    QEventLoop loop;
+    QObject::connect(&window, &TaskManager::firstFrameShown, &loop, [&]() {
+        firstFrameNs = timer.nsecsElapsed();
+    });
+    QObject::connect(&window, &TaskManager::sessionRestored, &loop, [&](int count) {
+        interactiveNs = timer.nsecsElapsed();
+        restored = count;
+        loop.quit();
+    });
+    QTimer::singleShot(STARTUP_TIMEOUT * 1000, &loop, &QEventLoop::quit);
+    window.show();
+    loop.exec();
+
+    // Снимок временный - при закрытии окна не перезаписываем
+    window.setSessionFile(QString());
+
+    if (interactiveNs < 0)
+    {
+        m_out << "Окно не стало готово к работе за " << STARTUP_TIMEOUT << " с" << Qt::endl;
+        return 1;
+    }
+
+    m_out << "startup: снимок сессии " << taskCount << " задач" << Qt::endl;
+    m_out << QString("  создание окна:      %1 мс").arg(constructedNs / 1e6, 0, 'f', 1) << Qt::endl;
+    m_out << QString("  первый кадр:        %1 мс").arg(firstFrameNs / 1e6, 0, 'f', 1) << Qt::endl;
+    m_out << QString("  готовность:         %1 мс (восстановлено %2 задач)")
+                 .arg(interactiveNs / 1e6, 0, 'f', 1).arg(restored) << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runProcesses(const QStringList &arguments)
+{
+    const int count = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : PROCESS_COUNT;
+    const int lines = arguments.value(1).toInt() > 0 ? arguments.value(1).toInt() : PROCESS_LINES;
+
+    // Дочерние копии приложения не открывают окон
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    TaskModel model;
+    model.setColdStorageDelay(-1);
+    model.setViewportRows({});
+    const QString program = QCoreApplication::applicationFilePath();
+    QList<int> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        // Номер процесса делает названия задач уникальными
+        model.addProcessTask(QString("\"%1\" --benchmark chatter %2 %3").arg(program).arg(lines).arg(i));
+        rows.append(i);
+    }
+
+    qint64 progressUpdates = 0;
+    QObject::connect(&model, &TaskModel::statisticsChanged, &model, [&progressUpdates](const TaskStatistics &) {
+        ++progressUpdates;
+    });
+
+    // Задержка срабатывания таймера показывает, успевает ли поток GUI
+    LatencyHistogram lag;
+    QElapsedTimer lagClock;
+    QTimer lagProbe;
+    lagProbe.setTimerType(Qt::PreciseTimer);
+    lagProbe.setInterval(PROCESS_LAG_PROBE_INTERVAL);
+    QObject::connect(&lagProbe, &QTimer::timeout, &lagProbe, [&lag, &lagClock]() {
+        lag.record(qMax<qint64>(0, lagClock.nsecsElapsed() - qint64(PROCESS_LAG_PROBE_INTERVAL) * 1000000));
+        lagClock.restart();
+    });
+
+    const quint64 readsBefore = Instrumentation::counter(Instrumentation::ProcessOutputReads);
+    QElapsedTimer timer;
+    timer.start();
+    lagClock.start();
+    lagProbe.start();
+    model.startTasks(rows);
+
+    QEventLoop loop;
+    QTimer poll;
+    poll.setInterval(100);
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&model, &loop]() {
+        if (model.statistics().running == 0)
+            loop.quit();
+    });
+    poll.start();
+    QTimer::singleShot(PROCESS_TIMEOUT * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    lagProbe.stop();
+
+    const TaskStatistics &stats = model.statistics();
+    qint64 outputBytes = 0;
+    for (int row = 0; row < count; ++row)
+        outputBytes += model.getTask(row)->processOutput().size();
+
+    m_out << "processes: " << count << " процессов по " << lines << " строк" << Qt::endl;
+    m_out << QString("  завершено:        %1 из %2 за %3 с (остановлено %4, выполняется %5)")
+                 .arg(stats.completed).arg(count).arg(elapsedNs / 1e9, 0, 'f', 2)
+                 .arg(stats.stopped).arg(stats.running) << Qt::endl;
+    m_out << QString("  чтений вывода:    %1 (уведомлений статистики %2, хвост вывода %3 КБ)")
+                 .arg(Instrumentation::counter(Instrumentation::ProcessOutputReads) - readsBefore)
+                 .arg(progressUpdates)
+                 .arg(outputBytes / 1024) << Qt::endl;
+    m_out << "  задержка цикла событий: " << histogramSummary(lag) << Qt::endl;
+    return stats.completed == count ? 0 : 1;
+}
+
+int BenchmarkRunner::runChatter(const QStringList &arguments)
+{
+    const int lines = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : PROCESS_LINES;
+
+    for (int i = 1; i <= lines; ++i)
+    {
+        const int permille = static_cast<int>(qint64(i) * 1000 / lines);
+        std::printf("chatter: step %d of %d, %d.%d%% complete, writing block %08x\n",
+                    i, lines, permille / 10, permille % 10, i * 2654435761u);
+    }
+    std::fflush(stdout);
+    return 0;
+}
+
+int BenchmarkRunner::runStages(const QStringList &arguments)
+{
+#ifdef DRW_COROUTINES
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : STAGED_TASKS;
+
+    QStringList names;
+    names.reserve(taskCount);
+    QList<int> rows;
+    rows.reserve(taskCount);
+    for (int i = 0; i < taskCount; ++i)
+    {
+        names.append(QString("Задача %1").arg(i));
+        rows.append(i);
+    }
+
+    const StagedTask::Definition definition{{1, 2, 1}, [](StageContext &context) -> StagedWork {
+        co_await context.stage(waitSteps(context, 10));
+        co_await context.stage(computeChecksum(context));
+        co_await context.stage(waitSteps(context, 5));
+    }};
+
+    m_out << "stages: " << taskCount << " задач" << Qt::endl;
+
+    // Тела измеряются первыми: освобождённая ими память занижает оценку режима тактов
+    {
+        const qint64 rssBefore = ProcessInfo::residentMemory();
+        TaskModel model;
+        model.setColdStorageDelay(-1);
+        model.setViewportRows({});
+        for (const QString &name : std::as_const(names))
+            model.addStagedTask(name, definition);
+
+        QElapsedTimer timer;
+        timer.start();
+        const std::clock_t cpuBefore = std::clock();
+        model.startTasks(rows);
+        const qint64 rssSuspended = ProcessInfo::residentMemory();
+
+        QEventLoop loop;
+        QObject::connect(&model, &TaskModel::statisticsChanged, &loop, [&loop](const TaskStatistics &statistics) {
+            if (statistics.completed == statistics.total)
+                loop.quit();
+        });
+        QTimer::singleShot(STAGED_TIMEOUT * 1000, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        const double cpuMs = (std::clock() - cpuBefore) * 1000.0 / CLOCKS_PER_SEC;
+        if (model.statistics().completed != taskCount)
+        {
+            m_out << "Задачи не завершились за " << STAGED_TIMEOUT << " с" << Qt::endl;
+            return 1;
+        }
+
+        m_out << QString("  этапы:  %1 байт RSS на приостановленную задачу")
+                     .arg((rssSuspended - rssBefore) / taskCount) << Qt::endl;
+        m_out << QString("          завершение за %1 мс, процессор %2 мс")
+                     .arg(timer.elapsed()).arg(cpuMs, 0, 'f', 0) << Qt::endl;
+    }
+
+    {
+        const qint64 rssBefore = ProcessInfo::residentMemory();
+        TaskModel model;
+        model.setColdStorageDelay(-1);
+        model.setViewportRows({});
+        model.addTasks(names);
+        model.startTasks(rows);
+        const qint64 rssRunning = ProcessInfo::residentMemory();
+        model.stopTasks(rows);
+
+        m_out << QString("  такты:  %1 байт RSS на выполняющуюся задачу")
+                     .arg((rssRunning - rssBefore) / taskCount) << Qt::endl;
+    }
+    return 0;
+#else
+    Q_UNUSED(arguments);
+    m_out << "stages: приложение собрано без DRW_COROUTINES" << Qt::endl;
+    return 1;
+#endif
+}
+
+int BenchmarkRunner::runReplay(const QStringList &arguments)
+{
+    QString path = arguments.value(0);
+    const auto speed = arguments.value(1) == "original" ? WorkloadReplayer::Original : WorkloadReplayer::Maximum;
+
+    QTemporaryDir dir;
+    if (path.isEmpty())
+    {
+        if (!dir.isValid())
+        {
+            m_out << "Не удалось создать временный каталог" << Qt::endl;
+            return 1;
+        }
+
+        // Синтетическая трасса записывается теми же точками записи, что и в окне
+        path = dir.filePath("workload.trace");
+        WorkloadTrace trace(path);
+        if (!trace.start())
+        {
+            m_out << "Не удалось записать трассу: " << trace.errorString() << Qt::endl;
+            return 1;
+        }
+
+        TaskModel model;
+        model.setColdStorageDelay(-1);
+        for (int round = 0; round < REPLAY_ROUNDS; ++round)
+        {
+            QStringList names;
+            names.reserve(REPLAY_BATCH_SIZE);
+            for (int i = 0; i < REPLAY_BATCH_SIZE; ++i)
+                names.append(QString("Задача %1-%2").arg(round).arg(i));
+            model.addTasks(names);
+
+            QList<int> all;
+            QList<int> scattered;
+            all.reserve(model.rowCount());
+            for (int row = 0; row < model.rowCount(); ++row)
+            {
+                all.append(row);
+                if (row % 3 == 0)
+                    scattered.append(row);
+            }
+            model.startTasks(all);
+            WorkloadTrace::record(WorkloadTrace::Filter, TaskProxyModel::Active);
+            WorkloadTrace::record(WorkloadTrace::Scroll, model.rowCount() / 2);
+            model.stopTasks(all.mid(0, all.count() / 2));
+            WorkloadTrace::record(WorkloadTrace::Filter, TaskProxyModel::All);
+            model.removeTasks(scattered);
+        }
+        trace.stop();
+        m_out << "replay: записана синтетическая трасса, операций " << trace.recorded()
+              << ", " << QFileInfo(path).size() << " байт" << Qt::endl;
+    }
+
+    TaskModel model;
+    model.setColdStorageDelay(-1);
+    TaskProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    WorkloadReplayer replayer(&model, &proxy);
+    QString error;
+    if (!replayer.start(path, speed, &error))
+    {
+        m_out << "Не удалось прочитать трассу: " << error << Qt::endl;
+        return 1;
+    }
+    if (!error.isEmpty())
+        m_out << "replay: " << error << Qt::endl;
+
+    QEventLoop loop;
+    QObject::connect(&replayer, &WorkloadReplayer::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    m_out << "replay (" << (speed == WorkloadReplayer::Original ? "original" : "max") << "): ";
+    for (const QString &line : WorkloadReplayer::formatReport(replayer.report()))
+        m_out << line << Qt::endl;
+    return 0;
+}
+
+int BenchmarkRunner::runSoak(const QStringList &arguments)
+{
+    const int operations = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : SOAK_OPERATIONS;
+    const quint32 seed = arguments.count() > 1 ? arguments.value(1).toUInt()
+                                               : QRandomGenerator::global()->generate();
+    QRandomGenerator random(seed);
+
+    enum SoakOperation { SoakAdd, SoakRemove, SoakStart, SoakStop, SoakFilter, SoakSort, SoakMigrate, SoakOperationCount };
+    const char *const operationNames[SoakOperationCount] = {"add", "remove", "start", "stop", "filter", "sort", "migrate"};
+    std::array<LatencyHistogram, SoakOperationCount> durations{};
+
+    // Задачи завершаются по общему планировщику, без таймера на задачу
+    TaskModel model;
+    model.setComputedProgress(true);
+    model.setColdStorageDelay(0);
+    TaskProxyModel proxy;
+    proxy.setParallelFilterThreshold(SOAK_PARALLEL_FILTER_ROWS);
+    proxy.setSourceModel(&model);
+    TaskTreeModel tree(&model);
+
+#ifdef DRW_MODEL_TESTER
+    modelTesterFailures = 0;
+    previousMessageHandler = qInstallMessageHandler(countModelTesterMessages);
+    const QAbstractItemModelTester modelTester(&model, QAbstractItemModelTester::FailureReportingMode::Warning);
+    const QAbstractItemModelTester proxyTester(&proxy, QAbstractItemModelTester::FailureReportingMode::Warning);
+    const QAbstractItemModelTester treeTester(&tree, QAbstractItemModelTester::FailureReportingMode::Warning);
+    const bool testerAttached = true;
+#else
+    const bool testerAttached = false;
+#endif
+
+    m_out << "soak: " << operations << " операций, зерно " << seed
+          << (testerAttached ? ", QAbstractItemModelTester подключён" : ", без QAbstractItemModelTester (нет Qt Test)")
+          << Qt::endl;
+
+    const auto randomRows = [&random](int rowCount) {
+        QList<int> rows;
+        if (rowCount <= 0)
+            return rows;
+        const int count = 1 + random.bounded(qMin(SOAK_MAX_SELECTION, rowCount));
+        if (random.bounded(2) == 0)
+        {
+            // Непрерывное выделение
+            const int first = random.bounded(rowCount - count + 1);
+            for (int row = first; row < first + count; ++row)
+                rows.append(row);
+        }
+        else
+        {
+            for (int i = 0; i < count; ++i)
+                rows.append(random.bounded(rowCount));
+        }
+        return rows;
+    };
+
+    QString failure;
+    int nextName = 0;
+    QElapsedTimer timer;
+    timer.start();
+    int done = 0;
+    while (done < operations && failure.isEmpty())
+    {
+        const int batchEnd = qMin(operations, done + SOAK_BATCH_SIZE);
+        for (; done < batchEnd; ++done)
+        {
+            const int liveRows = model.rowCount() - model.coldTasks().count() - model.archivedRowCount();
+            const int dice = random.bounded(100);
+            SoakOperation operation = SoakAdd;
+            if (dice < 25)
+                operation = liveRows < SOAK_MAX_TASKS ? SoakAdd : SoakRemove;
+            else if (dice < 45)
+                operation = SoakRemove;
+            else if (dice < 65)
+                operation = SoakStart;
+            else if (dice < 85)
+                operation = SoakStop;
+            else if (dice < 95)
+                operation = SoakFilter;
+            else if (dice < 98)
+                operation = SoakSort;
+            else
+                operation = SoakMigrate;
+
+            const qint64 start = MonotonicClock::nsecs();
+            switch (operation)
+            {
+            case SoakAdd:
+            {
+                // Каждое восьмое название повторяет уже выданное; две трети задач
+                // попадают в группы двух уровней дерева
+                QStringList names;
+                const int count = 1 + random.bounded(SOAK_MAX_SELECTION);
+                for (int i = 0; i < count; ++i)
+                {
+                    const int number = nextName > 0 && random.bounded(8) == 0
+                        ? random.bounded(nextName) : nextName++;
+                    names.append(number % 3 == 0
+                        ? QString("Задача %1").arg(number)
+                        : QString("Группа %1/Этап %2/Задача %3").arg(number % 5).arg(number % 2).arg(number));
+                }
+                model.addTasks(names);
+                break;
+            }
+            case SoakRemove:
+            {
+                // Как deleteSelectedTasks(): выделение в строках прокси
+                QList<int> sourceRows;
+                for (int row : randomRows(proxy.rowCount()))
+                    sourceRows.append(proxy.mapToSource(proxy.index(row, 0)).row());
+                model.removeTasks(sourceRows);
+                break;
+            }
+            case SoakStart:
+                model.startTasks(randomRows(liveRows));
+                break;
+            case SoakStop:
+                model.stopTasks(randomRows(liveRows));
+                break;
+            case SoakFilter:
+                proxy.setFilterType(static_cast<TaskProxyModel::FilterType>(random.bounded(3)));
+                break;
+            case SoakSort:
+                proxy.setSortMode(static_cast<TaskProxyModel::SortMode>(random.bounded(2)));
+                break;
+            default:
+                model.migrateCompletedTasks();
+                break;
+            }
+            durations[operation].record(MonotonicClock::nsecs() - start);
+        }
+
+        // Отложенные удаления, завершения задач и обновления выполняются между пакетами
+        QCoreApplication::processEvents();
+        failure = checkModelInvariants(model, proxy, tree);
+#ifdef DRW_MODEL_TESTER
+        if (failure.isEmpty() && modelTesterFailures > 0)
+            failure = QString("QAbstractItemModelTester: %1 нарушений").arg(modelTesterFailures);
+#endif
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+#ifdef DRW_MODEL_TESTER
+    qInstallMessageHandler(previousMessageHandler);
+#endif
+
+    if (!failure.isEmpty())
+    {
+        m_out << "soak: нарушение в пакете до операции " << done << " (зерно " << seed << "): "
+              << failure << Qt::endl;
+        return 1;
+    }
+
+    m_out << QString("  %1 операций/с, задач в конце: %2 текущих, %3 в хранилище")
+                 .arg(done * 1e9 / qMax<qint64>(elapsedNs, 1), 0, 'f', 0)
+                 .arg(model.rowCount() - model.coldTasks().count() - model.archivedRowCount())
+                 .arg(model.coldTasks().count()) << Qt::endl;
+    for (int operation = 0; operation < SoakOperationCount; ++operation)
+    {
+        if (durations[operation].count() > 0)
+            m_out << QString("  %1 ").arg(operationNames[operation], -8) << histogramSummary(durations[operation]) << Qt::endl;
+    }
+    return 0;
+}
+
+int BenchmarkRunner::runFilter(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : FILTER_TASKS;
+
+    QStringList names;
+    names.reserve(taskCount);
+    QList<int> rows;
+    rows.reserve(taskCount / 2 + 1);
+    for (int i = 0; i < taskCount; ++i)
+    {
+        names.append(QString("Задача %1").arg(i));
+        if (i % 2 == 0)
+            rows.append(i);
+    }
+
+    // Цикл событий не выполняется, поэтому состояние задач не меняется между замерами
+    TaskModel model;
+    model.setComputedProgress(true);
+    model.setViewportRows({});
+    model.addTasks(names);
+    model.startTasks(rows);
+    TaskProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    m_out << "filter: " << taskCount << " задач, выполняется " << rows.count() << Qt::endl;
+
+    const TaskProxyModel::FilterType types[] = {TaskProxyModel::Active, TaskProxyModel::Inactive, TaskProxyModel::All};
+    const char *const typeNames[] = {"Active", "Inactive", "All"};
+    std::array<QList<int>, 3> serialRows{};
+    for (const bool parallel : {false, true})
+    {
+        // Порог 1 включает параллельный проход при любом количестве задач
+        proxy.setParallelFilterThreshold(parallel ? 1 : 0);
+
+        std::array<LatencyHistogram, 3> durations{};
+        for (int round = 0; round < FILTER_ROUNDS; ++round)
+        {
+            for (int type = 0; type < 3; ++type)
+            {
+                const qint64 start = MonotonicClock::nsecs();
+                proxy.setFilterType(types[type]);
+                durations[type].record(MonotonicClock::nsecs() - start);
+
+                // Строки прокси сравниваются вне замера, по последнему циклу
+                if (round != FILTER_ROUNDS - 1)
+                    continue;
+                if (!parallel)
+                {
+                    serialRows[type] = proxySourceRows(proxy);
+                }
+                else if (proxySourceRows(proxy) != serialRows[type])
+                {
+                    m_out << "filter: строки прокси " << typeNames[type]
+                          << " при параллельном проходе отличаются от последовательного" << Qt::endl;
+                    return 1;
+                }
+            }
+        }
+
+        m_out << (parallel ? "  параллельно (битовая карта и ключи сортировки):" : "  последовательно (filterAcceptsRow()):") << Qt::endl;
+        for (int type = 0; type < 3; ++type)
+            m_out << QString("    -> %1 ").arg(typeNames[type], -8) << histogramSummary(durations[type]) << Qt::endl;
+    }
+    return 0;
+}
+
+int BenchmarkRunner::runRowAccess(const QStringList &arguments)
+{
+    const int taskCount = arguments.value(0).toInt() > 0 ? arguments.value(0).toInt() : ROW_ACCESS_TASKS;
+
+    QStringList names;
+    names.reserve(taskCount);
+    QList<int> rows;
+    rows.reserve(taskCount / 2 + 1);
+    for (int i = 0; i < taskCount; ++i)
+    {
+        names.append(QString("Задача %1").arg(i));
+        if (i % 2 == 0)
+            rows.append(i);
+    }
+
+    // Цикл событий не выполняется, поэтому данные строк не меняются между замерами
+    TaskModel model;
+    model.setComputedProgress(true);
+    model.setViewportRows({});
+    model.addTasks(names);
+    model.startTasks(rows);
+
+    TaskProxyModel proxy;
+    proxy.setParallelFilterThreshold(0);
+    proxy.setSourceModel(&model);
+
+    // Прокси над промежуточной моделью не видит TaskModel и читает роли
+    QIdentityProxyModel identity;
+    identity.setSourceModel(&model);
+    TaskProxyModel roleProxy;
+    roleProxy.setParallelFilterThreshold(0);
+    roleProxy.setSourceModel(&identity);
+
+    m_out << "row-access: " << taskCount << " задач, выполняется " << rows.count() << Qt::endl;
+
+    const auto perRow = [this](const char *label, const LatencyHistogram &durations, int rowCount) {
+        m_out << QString("  %1 ").arg(label, -28)
+              << QString("%1 нс/строку, ").arg(durations.percentile(0.50) / static_cast<double>(qMax(1, rowCount)), 0, 'f', 1)
+              << histogramSummary(durations) << Qt::endl;
+    };
+
+    // Данные, которые делегат читает для отрисовки строки
+    qint64 checksum = 0;
+    LatencyHistogram roleReads;
+    LatencyHistogram snapshotReads;
+    for (int round = 0; round < ROW_ACCESS_ROUNDS; ++round)
+    {
+        qint64 start = MonotonicClock::nsecs();
+        for (int row = 0; row < proxy.rowCount(); ++row)
+        {
+            const QModelIndex index = proxy.index(row, 0);
+            checksum += index.data(TaskModel::NameRole).toString().size();
+            checksum += index.data(TaskModel::DateRole).toDateTime().toMSecsSinceEpoch() & 1;
+            checksum += index.data(TaskModel::ProgressRole).toInt();
+            checksum += index.data(TaskModel::RunningRole).toBool();
+            checksum += index.data(TaskModel::HistoryRole).value<ProgressHistory>().count();
+            checksum += index.data(TaskModel::ArchivedRole).toBool();
+            checksum += index.data(TaskModel::ProgressStampRole).toLongLong() & 1;
+        }
+        roleReads.record(MonotonicClock::nsecs() - start);
+
+        start = MonotonicClock::nsecs();
+        TaskModel::RowSnapshot snapshot;
+        for (int row = 0; row < proxy.rowCount(); ++row)
+        {
+            proxy.rowSnapshot(proxy.index(row, 0), snapshot);
+            checksum += snapshot.name.size();
+            checksum += snapshot.dateMs & 1;
+            checksum += snapshot.progress;
+            checksum += snapshot.running;
+            checksum += snapshot.history ? snapshot.history->count() : 0;
+            checksum += snapshot.archived;
+            checksum += snapshot.progressStampNs & 1;
+        }
+        snapshotReads.record(MonotonicClock::nsecs() - start);
+    }
+    m_out << "  чтение строки делегатом:" << Qt::endl;
+    perRow("роли (7 x data())", roleReads, taskCount);
+    perRow("rowSnapshot()", snapshotReads, taskCount);
+
+    // Полная пересортировка и проход фильтра прокси
+    LatencyHistogram roleSorts;
+    LatencyHistogram snapshotSorts;
+    LatencyHistogram roleFilters;
+    LatencyHistogram snapshotFilters;
+    for (int round = 0; round < ROW_ACCESS_ROUNDS; ++round)
+    {
+        const TaskProxyModel::SortMode mode = round % 2 == 0 ? TaskProxyModel::ByEta : TaskProxyModel::ByDate;
+        for (TaskProxyModel *target : {&roleProxy, &proxy})
+        {
+            qint64 start = MonotonicClock::nsecs();
+            target->setSortMode(mode);
+            (target == &proxy ? snapshotSorts : roleSorts).record(MonotonicClock::nsecs() - start);
+
+            start = MonotonicClock::nsecs();
+            target->setFilterType(TaskProxyModel::Active);
+            target->setFilterType(TaskProxyModel::Inactive);
+            (target == &proxy ? snapshotFilters : roleFilters).record(MonotonicClock::nsecs() - start);
+            target->setFilterType(TaskProxyModel::All);
+        }
+    }
+    m_out << "  сортировка прокси:" << Qt::endl;
+    perRow("роли (lessThan() через data())", roleSorts, taskCount);
+    perRow("rowSnapshot()", snapshotSorts, taskCount);
+    m_out << "  фильтр Active + Inactive:" << Qt::endl;
+    perRow("роли", roleFilters, 2 * taskCount);
+    perRow("rowSnapshot()", snapshotFilters, 2 * taskCount);
+
+    m_out << "  контрольная сумма: " << checksum << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <QStringList>
+#include <QTextStream>
+
+class QLocalSocket;
+
+/**
+ * @class BenchmarkRunner
+ * @brief Запуск встроенных бенчмарков без показа главного окна
+ *
+ * BenchmarkRunner выполняет сценарии измерения производительности,
+ * выбираемые параметром командной строки --benchmark, и выводит
+ * результаты в стандартный поток вывода.
+ */
+class BenchmarkRunner
+{
+    /// Количество задач, создаваемых за один цикл churn-бенчмарка
+    static constexpr int CHURN_BATCH_SIZE = 10000;
+
+    /// Количество циклов создания и удаления задач
+    static constexpr int CHURN_CYCLES = 50;
+
+    /// Размер пакета команд генератора нагрузки по умолчанию
+    static constexpr int CONTROL_BATCH_SIZE = 1000;
+
+    /// Количество раундов генератора нагрузки по умолчанию
+    static constexpr int CONTROL_ROUNDS = 100;
+
+    /// Таймаут ожидания ответа сервера управления (мс)
+    static constexpr int CONTROL_TIMEOUT = 10000;
+
+    /// Количество строк файла импорта по умолчанию
+    static constexpr int IMPORT_ROWS = 1000000;
+
+    /// Количество выполняющихся задач в бенчмарке задержки отрисовки по умолчанию
+    static constexpr int LATENCY_TASKS = 500;
+
+    /// Длительность бенчмарка задержки отрисовки по умолчанию (с)
+    static constexpr int LATENCY_SECONDS = 10;
+
+    /// Количество задач в бенчмарке публикации показателей по умолчанию
+    static constexpr int METRICS_TASKS = 100000;
+
+    /// Количество опросов показателей по умолчанию
+    static constexpr int METRICS_SCRAPES = 200;
+
+    /// Таймаут одного опроса показателей (мс)
+    static constexpr int METRICS_TIMEOUT = 5000;
+
+    /// Количество выполняющихся задач в бенчмарке режимов прогресса по умолчанию
+    static constexpr int PROGRESS_TASKS = 100000;
+
+    /// Длительность замера каждого режима прогресса по умолчанию (с)
+    static constexpr int PROGRESS_SECONDS = 5;
+
+    /// Количество записей архива в бенчмарке по умолчанию
+    static constexpr int ARCHIVE_ROWS = 10000000;
+
+    /// Ограничение кэша страниц архива в бенчмарке по умолчанию (МБ)
+    static constexpr int ARCHIVE_CACHE_MB = 16;
+
+    /// Количество случайных обращений к строкам архива
+    static constexpr int ARCHIVE_RANDOM_READS = 100000;
+
+    /// Количество задач в бенчмарке хранилища завершённых задач по умолчанию
+    static constexpr int COLD_TASKS = 100000;
+
+    /// Максимальное ожидание завершения всех задач (с)
+    static constexpr int COLD_COMPLETION_TIMEOUT = 180;
+
+    /// Количество задач в снимке сессии бенчмарка запуска по умолчанию
+    static constexpr int STARTUP_TASKS = 100000;
+
+    /// Максимальное ожидание готовности окна (с)
+    static constexpr int STARTUP_TIMEOUT = 60;
+
+    /// Количество одновременных процессов в бенчмарке задач-команд по умолчанию
+    static constexpr int PROCESS_COUNT = 200;
+
+    /// Количество строк вывода каждого процесса по умолчанию
+    static constexpr int PROCESS_LINES = 20000;
+
+    /// Максимальное ожидание завершения процессов (с)
+    static constexpr int PROCESS_TIMEOUT = 300;
+
+    /// Интервал проверки задержки цикла событий (мс)
+    static constexpr int PROCESS_LAG_PROBE_INTERVAL = 10;
+
+    /// Количество задач в бенчмарке задач из этапов по умолчанию
+    static constexpr int STAGED_TASKS = 100000;
+
+    /// Максимальное ожидание завершения задач из этапов (с)
+    static constexpr int STAGED_TIMEOUT = 180;
+
+    /// Количество раундов синтетической трассы бенчмарка воспроизведения
+    static constexpr int REPLAY_ROUNDS = 20;
+
+    /// Количество задач, добавляемых за раунд синтетической трассы
+    static constexpr int REPLAY_BATCH_SIZE = 10000;
+
+    /// Количество случайных операций soak-прогона по умолчанию
+    static constexpr int SOAK_OPERATIONS = 1000000;
+
+    /// Количество операций между проверками инвариантов
+    static constexpr int SOAK_BATCH_SIZE = 1000;
+
+    /// Ограничение числа текущих задач soak-прогона
+    static constexpr int SOAK_MAX_TASKS = 5000;
+
+    /// Наибольшее количество задач в одной операции soak-прогона
+    static constexpr int SOAK_MAX_SELECTION = 32;
+
+    /// Порог параллельного фильтра soak-прогона: ниже него проверяется последовательный проход
+    static constexpr int SOAK_PARALLEL_FILTER_ROWS = SOAK_MAX_TASKS / 2;
+
+    /// Количество задач в бенчмарке смены фильтра по умолчанию
+    static constexpr int FILTER_TASKS = 1000000;
+
+    /// Количество циклов смены фильтра All -> Active -> Inactive
+    static constexpr int FILTER_ROUNDS = 3;
+
+    /// Количество задач в бенчмарке доступа к данным строк по умолчанию
+    static constexpr int ROW_ACCESS_TASKS = 100000;
+
+    /// Количество проходов каждого способа доступа к данным строк
+    static constexpr int ROW_ACCESS_ROUNDS = 5;
+
+public:
+    BenchmarkRunner();
+
+    /**
+     * @brief Запустить бенчмарк
+     * @param name Название бенчмарка
+     * @param arguments Дополнительные аргументы бенчмарка
+     * @return Код завершения процесса (0 при успехе)
+     */
+    int run(const QString &name, const QStringList &arguments = {});
+
+    /**
+     * @brief Получить список доступных бенчмарков
+     * @return Названия бенчмарков
+     */
+    static QStringList availableBenchmarks();
+
+private:
+    /**
+     * @brief Бенчмарк создания и удаления задач
+     * @return Код завершения
+     *
+     * Сравнивает создание задач через new/delete и через пул TaskPool:
+     * количество выделений в секунду и прирост резидентной памяти.
+     */
+    int runChurn();
+
+    /**
+     * @brief Генератор нагрузки на сервер управления
+     * @param arguments [имя сокета] [размер пакета] [количество раундов]
+     * @return Код завершения
+     *
+     * Подключается к запущенному с параметром --control приложению и в
+     * каждом раунде добавляет, запускает, останавливает и удаляет пакет
+     * задач. Выводит пропускную способность в командах над задачами в
+     * секунду и задержки запросов.
+     */
+    int runControlLoad(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк потокового импорта
+     * @param arguments [количество строк]
+     * @return Код завершения
+     *
+     * Генерирует временные файлы CSV и NDJSON и измеряет скорость их
+     * разбора с проверкой дубликатов (строк в секунду и МБ/с).
+     */
+    int runImport(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк задержки от изменения прогресса до отрисовки
+     * @param arguments [количество задач] [длительность, с]
+     * @return Код завершения
+     *
+     * Показывает список задач с TaskDelegate, запускает все задачи и
+     * выводит перцентили задержки tick-to-pixel и времени отрисовки строки
+     * из гистограмм Instrumentation. Без дисплея запускается с
+     * QT_QPA_PLATFORM=offscreen.
+     */
+    int runLatency(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк публикации показателей с имитацией сборщика
+     * @param arguments [количество задач] [количество опросов]
+     * @return Код завершения
+     *
+     * Заполняет модель задачами, запускает MetricsExporter на свободном
+     * порту localhost и опрашивает /metrics по HTTP, как Prometheus.
+     * Проверяет формат ответа и выводит время формирования показателей
+     * и задержку опроса.
+     */
+    int runMetrics(const QStringList &arguments);
+
+    /**
+     * @brief Сравнение режимов прогресса: такты таймеров и вычисление по времени
+     * @param arguments [количество задач] [длительность замера, с]
+     * @return Код завершения
+     *
+     * Запускает задачи в каждом режиме без видимых строк и выводит
+     * процессорное время, количество уведомлений модели и средний
+     * вычисленный прогресс.
+     */
+    int runProgressModes(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк страничной загрузки архива
+     * @param arguments [количество записей] [ограничение кэша, МБ]
+     * @return Код завершения
+     *
+     * Создаёт временный архив, подгружает все строки в модель через
+     * fetchMore(), затем читает их последовательно (прокрутка) и в
+     * случайном порядке. Выводит скорость чтения, количество загрузок
+     * страниц и прирост RSS при заданном ограничении кэша.
+     */
+    int runArchive(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк переноса завершённых задач в ColdTaskStore
+     * @param arguments [количество задач]
+     * @return Код завершения
+     *
+     * Выполняет задачи до завершения в режиме вычисляемого прогресса,
+     * затем переносит их в хранилище завершённых. Выводит время переноса,
+     * изменение RSS и числа объектов Task, а также скорость чтения строк
+     * до и после переноса.
+     */
+    int runColdTier(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк холодного запуска главного окна
+     * @param arguments [количество задач в снимке сессии]
+     * @return Код завершения
+     *
+     * Создаёт снимок сессии, затем создаёт и показывает TaskManager и
+     * выводит время создания окна, время до первой отрисовки списка и
+     * до завершения восстановления сессии (готовности к работе). Без
+     * дисплея запускается с QT_QPA_PLATFORM=offscreen.
+     */
+    int runStartup(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк задач, выполняющих внешние процессы
+     * @param arguments [количество процессов] [строк вывода на процесс]
+     * @return Код завершения
+     *
+     * Запускает одновременно указанное количество копий приложения в
+     * режиме chatter и выводит время до завершения всех задач, объём
+     * разобранного вывода и задержку цикла событий потока GUI.
+     */
+    int runProcesses(const QStringList &arguments);
+
+    /**
+     * @brief Источник вывода для бенчмарка processes
+     * @param arguments [количество строк]
+     * @return Код завершения
+     *
+     * Быстро печатает строки с процентом выполнения, как утилиты
+     * командной строки.
+     */
+    int runChatter(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк задач, выполняющих тело-сопрограмму из этапов
+     * @param arguments [количество задач]
+     * @return Код завершения
+     *
+     * Сравнивает прирост RSS на выполняющуюся задачу в режиме тактов и у
+     * приостановленных тел StagedTask, затем выполняет тела до завершения
+     * и выводит время и процессорное время. Требует сборки с
+     * DRW_COROUTINES.
+     */
+    int runStages(const QStringList &arguments);
+
+    /**
+     * @brief Воспроизведение трассы операций без окна
+     * @param arguments [файл трассы] [original|max]
+     * @return Код завершения
+     *
+     * Воспроизводит трассу, записанную с параметром --record, над моделью
+     * и прокси-моделью без представления и выводит время операций по
+     * типам. Без файла трассы сначала записывает синтетическую трассу:
+     * пакетные добавления, массовые запуск и остановка, смена фильтра,
+     * прокрутка и удаление разрозненного выделения. По умолчанию темп
+     * максимальный.
+     */
+    int runReplay(const QStringList &arguments);
+
+    /**
+     * @brief Случайный soak-прогон модели и прокси-модели с проверкой согласованности
+     * @param arguments [количество операций] [зерно]
+     * @return Код завершения (1 при нарушении инвариантов)
+     *
+     * Выполняет случайно перемежающиеся добавления (в том числе дубликатов),
+     * удаления выделения через mapToSource, запуск, остановку, смену фильтра
+     * и сортировки и перенос завершённых задач в хранилище. После каждого
+     * пакета из SOAK_BATCH_SIZE операций обрабатывает события и проверяет
+     * инварианты: статистику, строки и идентификаторы задач, индекс названий,
+     * отображение строк прокси и суммы деревьев Фенвика дерева групп
+     * TaskTreeModel против пересчёта по задачам. Порог параллельного фильтра
+     * снижен до SOAK_PARALLEL_FILTER_ROWS, чтобы проверялись оба прохода.
+     * При сборке с Qt Test к модели, прокси и дереву групп подключается
+     * QAbstractItemModelTester. Выводит пропускную способность
+     * и перцентили длительности операций по типам.
+     */
+    int runSoak(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк смены фильтра прокси-модели
+     * @param arguments [количество задач]
+     * @return Код завершения
+     *
+     * Запускает каждую вторую задачу и переключает фильтр между All, Active
+     * и Inactive при последовательном вычислении filterAcceptsRow() и при
+     * параллельном вычислении битовой карты и ключей сортировки (порог 1,
+     * поэтому параллельный проход выполняется при любом размере модели).
+     * Выводит время смены фильтра по каждому типу; если строки прокси
+     * параллельного прохода отличаются от последовательного, завершается
+     * с кодом 1.
+     */
+    int runFilter(const QStringList &arguments);
+
+    /**
+     * @brief Бенчмарк доступа к данным строк через роли и через RowSnapshot
+     * @param arguments [количество задач]
+     * @return Код завершения
+     *
+     * Читает все строки прокси-модели набором ролей, который использовал
+     * делегат, и одним вызовом TaskProxyModel::rowSnapshot(), затем
+     * сортирует и фильтрует прокси над TaskModel и над QIdentityProxyModel,
+     * скрывающей TaskModel, то есть с чтением через роли. Выводит время на
+     * строку для каждого способа.
+     */
+    int runRowAccess(const QStringList &arguments);
+
+    /**
+     * @brief Отправить запрос серверу управления и дождаться ответа
+     * @param socket Подключённый сокет
+     * @param buffer Буфер принятых данных между вызовами
+     * @param payload Полезная нагрузка запроса
+     * @param reply Полезная нагрузка ответа (выходной параметр)
+     * @param deltas Счётчик принятых уведомлений ProgressDeltas
+     * @return true если ответ получен
+     */
+    bool controlRequest(QLocalSocket &socket, QByteArray &buffer, const QByteArray &payload,
+                        QByteArray &reply, qint64 &deltas);
+
+    QTextStream m_out;  ///< Поток вывода результатов
+};
@@ -0,0 +1,140 @@
+#include "coldtaskstore.h"
+#include <algorithm>
+#include <iterator>
+
+QString ColdTaskStore::name(int index) const
+{
+    const Record &record = m_records[index];
+    return QString::fromUtf8(m_names.constData() + record.nameOffset, record.nameLength);
+}
+
+QDateTime ColdTaskStore::date(int index) const
+{
+    return QDateTime::fromMSecsSinceEpoch(m_records[index].dateMs);
+}
+
+int ColdTaskStore::indexOf(quint64 id) const
+{
+    const auto it = std::lower_bound(m_records.cbegin(), m_records.cend(), id,
+                                     [](const Record &record, quint64 value) { return record.id < value; });
+    if (it == m_records.cend() || it->id != id)
+        return -1;
+    return static_cast<int>(it - m_records.cbegin());
+}
+
+void ColdTaskStore::insert(const QList<Entry> &entries)
+{
+    if (entries.isEmpty())
+        return;
+
+    std::vector<Record> added;
+    added.reserve(entries.count());
+    for (const Entry &entry : entries)
+    {
+        const QByteArray name = entry.name.toUtf8();
+        added.push_back({entry.id, entry.date.toMSecsSinceEpoch(),
+                         internName(name), static_cast<quint32>(name.size())});
+    }
+
+    // Обычно задачи завершаются позже более старых - тогда достаточно дописать в конец
+    const auto byId = [](const Record &left, const Record &right) { return left.id < right.id; };
+    if (m_records.empty() || m_records.back().id < added.front().id)
+    {
+        m_records.insert(m_records.end(), added.cbegin(), added.cend());
+        return;
+    }
+
+    std::vector<Record> merged;
+    merged.reserve(m_records.size() + added.size());
+    std::merge(m_records.cbegin(), m_records.cend(), added.cbegin(), added.cend(),
+               std::back_inserter(merged), byId);
+    m_records.swap(merged);
+}
+
+void ColdTaskStore::remove(const QList<int> &indices)
+{
+    if (indices.isEmpty())
+        return;
+
+    // Уплотняем записи за один проход
+    auto out = m_records.begin() + indices.first();
+    int next = 0;
+    for (auto it = out; it != m_records.end(); ++it)
+    {
+        const int index = static_cast<int>(it - m_records.begin());
+        if (next < indices.count() && indices.at(next) == index)
+        {
+            releaseName(*it);
+            ++next;
+            continue;
+        }
+        *out++ = *it;
+    }
+    m_records.erase(out, m_records.end());
+
+    compactNames();
+}
+
+qint64 ColdTaskStore::memoryUsage() const
+{
+    return qint64(m_records.capacity() * sizeof(Record)) + m_names.capacity()
+        + qint64(m_nameRefs.capacity()) * qint64(sizeof(size_t) + sizeof(NameRef));
+}
+
+quint32 ColdTaskStore::internName(const QByteArray &name)
+{
+    const size_t hash = qHash(QByteArrayView(name));
+    for (auto it = m_nameRefs.find(hash); it != m_nameRefs.end() && it.key() == hash; ++it)
+    {
+        if (it->length == static_cast<quint32>(name.size())
+            && QByteArrayView(m_names.constData() + it->offset, it->length) == QByteArrayView(name))
+        {
+            ++it->refs;
+            return it->offset;
+        }
+    }
+
+    const quint32 offset = static_cast<quint32>(m_names.size());
+    m_names.append(name);
+    m_nameRefs.insert(hash, {offset, static_cast<quint32>(name.size()), 1});
+    return offset;
+}
+
+void ColdTaskStore::releaseName(const Record &record)
+{
+    const size_t hash = qHash(QByteArrayView(m_names.constData() + record.nameOffset, record.nameLength));
+    for (auto it = m_nameRefs.find(hash); it != m_nameRefs.end() && it.key() == hash; ++it)
+    {
+        if (it->offset != record.nameOffset)
+            continue;
+        if (--it->refs == 0)
+        {
+            m_wastedNameBytes += it->length;
+            m_nameRefs.erase(it);
+        }
+        return;
+    }
+}
+
+void ColdTaskStore::compactNames()
+{
+    if (m_wastedNameBytes * 2 < m_names.size())
+        return;
+
+    // Каждое название с ссылками переносится один раз, записи следуют за ним
+    QByteArray names;
+    names.reserve(m_names.size() - static_cast<int>(m_wastedNameBytes));
+    QHash<quint32, quint32> moved;
+    moved.reserve(m_nameRefs.size());
+    for (NameRef &ref : m_nameRefs)
+    {
+        const quint32 offset = static_cast<quint32>(names.size());
+        names.append(m_names.constData() + ref.offset, ref.length);
+        moved.insert(ref.offset, offset);
+        ref.offset = offset;
+    }
+    for (Record &record : m_records)
+        record.nameOffset = moved.value(record.nameOffset);
+    m_names = names;
+    m_wastedNameBytes = 0;
+}
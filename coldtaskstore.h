@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QMultiHash>
+#include <QString>
+#include <vector>
+
+/**
+ * @class ColdTaskStore
+ * @brief Компактное хранилище завершённых задач
+ *
+ * Завершённые задачи хранятся без QObject: упакованная запись с
+ * идентификатором, датой создания и ссылкой на название в общей области
+ * названий (UTF-8). Одинаковые названия хранятся в области один раз и
+ * учитываются счётчиком ссылок. Записи упорядочены по идентификатору, поэтому поиск
+ * задачи выполняется двоичным поиском без отдельного индекса.
+ */
+class ColdTaskStore
+{
+public:
+    /**
+     * @struct Entry
+     * @brief Данные задачи для переноса в хранилище
+     */
+    struct Entry
+    {
+        quint64 id{0};   ///< Идентификатор задачи
+        QString name;    ///< Название
+        QDateTime date;  ///< Дата создания
+    };
+
+    /**
+     * @brief Получить количество задач
+     * @return Количество записей
+     */
+    int count() const { return static_cast<int>(m_records.size()); }
+
+    /**
+     * @brief Получить идентификатор задачи
+     * @param index Номер записи
+     * @return Идентификатор
+     */
+    quint64 id(int index) const { return m_records[index].id; }
+
+    /**
+     * @brief Получить название задачи
+     * @param index Номер записи
+     * @return Название
+     */
+    QString name(int index) const;
+
+    /**
+     * @brief Получить дату создания задачи
+     * @param index Номер записи
+     * @return Дата создания
+     */
+    QDateTime date(int index) const;
+
+    /**
+     * @brief Получить дату создания задачи в миллисекундах
+     * @param index Номер записи
+     * @return Дата создания (мс от эпохи)
+     */
+    qint64 dateMs(int index) const { return m_records[index].dateMs; }
+
+    /**
+     * @brief Найти задачу по идентификатору
+     * @param id Идентификатор
+     * @return Номер записи или -1
+     */
+    int indexOf(quint64 id) const;
+
+    /**
+     * @brief Добавить задачи
+     * @param entries Задачи, упорядоченные по возрастанию идентификатора
+     *
+     * Записи сливаются с существующими с сохранением порядка.
+     */
+    void insert(const QList<Entry> &entries);
+
+    /**
+     * @brief Удалить задачи
+     * @param indices Номера записей по возрастанию
+     */
+    void remove(const QList<int> &indices);
+
+    /**
+     * @brief Оценить занимаемую память
+     * @return Размер записей и области названий (байт)
+     */
+    qint64 memoryUsage() const;
+
+private:
+    /**
+     * @struct Record
+     * @brief Упакованная запись задачи
+     */
+    struct Record
+    {
+        quint64 id;          ///< Идентификатор задачи
+        qint64 dateMs;       ///< Дата создания (мс от эпохи)
+        quint32 nameOffset;  ///< Смещение названия в области названий
+        quint32 nameLength;  ///< Длина названия (байт UTF-8)
+    };
+
+    /**
+     * @struct NameRef
+     * @brief Название в области названий
+     */
+    struct NameRef
+    {
+        quint32 offset;  ///< Смещение названия в области названий
+        quint32 length;  ///< Длина названия (байт UTF-8)
+        quint32 refs;    ///< Количество записей с этим названием
+    };
+
+    /**
+     * @brief Найти название в области или дописать его
+     * @param name Название (UTF-8)
+     * @return Смещение названия в области названий
+     */
+    quint32 internName(const QByteArray &name);
+
+    /**
+     * @brief Освободить ссылку записи на название
+     * @param record Удаляемая запись
+     *
+     * Байты названия без ссылок учитываются в m_wastedNameBytes.
+     */
+    void releaseName(const Record &record);
+
+    /**
+     * @brief Уплотнить область названий, если в ней много удалённых названий
+     */
+    void compactNames();
+
+    std::vector<Record> m_records;  ///< Записи по возрастанию идентификатора
+    QByteArray m_names;             ///< Область названий (UTF-8), каждое название один раз
+    QMultiHash<size_t, NameRef> m_nameRefs; ///< Названия области по хэшу их байтов
+    qint64 m_wastedNameBytes{0};    ///< Байты названий без ссылок
+};
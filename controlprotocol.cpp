@@ -0,0 +1,40 @@
+#include "controlprotocol.h"
+#include <QtEndian>
+
+QByteArray ControlProtocol::frame(const QByteArray &payload)
+{
+    QByteArray result;
+    result.reserve(sizeof(quint32) + payload.size());
+
+    char header[sizeof(quint32)];
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), header);
+    result.append(header, sizeof(header));
+    result.append(payload);
+    return result;
+}
+
+bool ControlProtocol::readFrame(const QByteArray &buffer, int &offset,
+                                QByteArray &payload, bool *ok)
+{
+    if (ok)
+        *ok = true;
+
+    const int available = buffer.size() - offset;
+    if (available < static_cast<int>(sizeof(quint32)))
+        return false;
+
+    const quint32 length = qFromBigEndian<quint32>(buffer.constData() + offset);
+    if (length > MAX_FRAME_SIZE)
+    {
+        if (ok)
+            *ok = false;
+        return false;
+    }
+
+    if (available < static_cast<int>(sizeof(quint32) + length))
+        return false;
+
+    payload = buffer.mid(offset + static_cast<int>(sizeof(quint32)), static_cast<int>(length));
+    offset += static_cast<int>(sizeof(quint32) + length);
+    return true;
+}
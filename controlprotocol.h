@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QIODevice>
+
+/**
+ * @class ControlProtocol
+ * @brief Двоичный протокол управления задачами через локальный сокет
+ *
+ * Каждый кадр состоит из длины полезной нагрузки (quint32, big-endian)
+ * и самой нагрузки: кода команды (quint8) и её аргументов в формате
+ * QDataStream (версия STREAM_VERSION).
+ *
+ * Запросы клиента:
+ * - AddTasks:    quint32 N, N x QString - названия задач
+ * - StartTasks,
+ *   StopTasks,
+ *   RemoveTasks: quint32 N, N x quint64 - идентификаторы задач
+ * - Subscribe:   quint8 - 1 для подписки на изменения прогресса, 0 для отписки
+ *
+ * Ответы сервера имеют код запроса с установленным битом REPLY_FLAG:
+ * - на AddTasks: quint32 N, N x quint64 - идентификаторы (0 - задача отклонена)
+ * - на остальные: quint32 - количество обработанных задач
+ *
+ * Уведомления сервера:
+ * - ProgressDeltas: quint32 N, N x (quint64 id, quint8 прогресс, quint8 выполняется)
+ * - Error: QString - описание ошибки
+ */
+class ControlProtocol
+{
+public:
+    ControlProtocol() = delete;
+
+    /// Версия сериализации QDataStream
+    static constexpr int STREAM_VERSION = QDataStream::Qt_5_15;
+
+    /// Максимальный размер полезной нагрузки кадра (байт)
+    static constexpr quint32 MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+    /// Бит, отличающий ответ от запроса
+    static constexpr quint8 REPLY_FLAG = 0x80;
+
+    /**
+     * @enum Opcode
+     * @brief Коды команд и уведомлений
+     */
+    enum Opcode : quint8 {
+        AddTasks = 0x01,        ///< Пакетное добавление задач
+        StartTasks = 0x02,      ///< Пакетный запуск задач
+        StopTasks = 0x03,       ///< Пакетная остановка задач
+        RemoveTasks = 0x04,     ///< Пакетное удаление задач
+        Subscribe = 0x05,       ///< Подписка на изменения прогресса
+        ProgressDeltas = 0x40,  ///< Накопленные за кадр изменения прогресса
+        Error = 0x7F            ///< Ошибка обработки запроса
+    };
+
+    /**
+     * @brief Сформировать кадр
+     * @param payload Полезная нагрузка (код команды и аргументы)
+     * @return Кадр с префиксом длины
+     */
+    static QByteArray frame(const QByteArray &payload);
+
+    /**
+     * @brief Прочитать очередной полный кадр из буфера
+     * @param buffer Накопленные данные сокета
+     * @param offset Смещение начала кадра; при успехе сдвигается за кадр
+     * @param payload Полезная нагрузка кадра (выходной параметр)
+     * @param ok Устанавливается в false, если длина кадра превышает MAX_FRAME_SIZE
+     * @return true если кадр прочитан, false если данных пока недостаточно
+     *         или длина кадра некорректна
+     *
+     * Буфер не изменяется: вызывающая сторона удаляет обработанную часть
+     * одним вызовом после разбора всех доступных кадров.
+     */
+    static bool readFrame(const QByteArray &buffer, int &offset,
+                          QByteArray &payload, bool *ok = nullptr);
+};
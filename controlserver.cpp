@@ -0,0 +1,285 @@
+#include "controlserver.h"
+#include "controlprotocol.h"
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Проверить, что заявленное количество элементов помещается в нагрузку
+ * @param in Поток нагрузки
+ * @param count Количество элементов из кадра
+ * @param minElementSize Наименьший размер закодированного элемента (байт)
+ * @return true если оставшихся байтов хватает на count элементов
+ *
+ * Количество приходит от клиента, поэтому резервировать память под него
+ * можно только после этой проверки.
+ */
+bool countFits(QDataStream &in, quint32 count, qint64 minElementSize)
+{
+    return in.status() == QDataStream::Ok && count <= in.device()->bytesAvailable() / minElementSize;
+}
+
+/**
+ * @brief Прочитать список идентификаторов задач
+ * @param in Поток нагрузки
+ * @param ids Прочитанные идентификаторы (выходной параметр)
+ * @return true если список прочитан полностью
+ */
+bool readTaskIds(QDataStream &in, QList<quint64> &ids)
+{
+    quint32 count = 0;
+    in >> count;
+    if (!countFits(in, count, sizeof(quint64)))
+        return false;
+
+    ids.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        quint64 id = 0;
+        in >> id;
+        ids.append(id);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+} // namespace
+
+ControlServer::ControlServer(TaskModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    m_server = new QLocalServer(this);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(DELTA_FLUSH_INTERVAL);
+    connect(m_flushTimer, &QTimer::timeout, this, &ControlServer::flushDeltas);
+
+    // dataChanged предназначен представлениям и молчит при скрытом окне
+    connect(m_model, &TaskModel::taskChanged, this, &ControlServer::onTaskChanged);
+}
+
+bool ControlServer::listen(const QString &name)
+{
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection())
+    {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, &ControlServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &ControlServer::onDisconnected);
+    }
+}
+
+void ControlServer::onReadyRead()
+{
+    auto *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket || !m_clients.contains(socket))
+        return;
+
+    Client &client = m_clients[socket];
+    client.buffer.append(socket->readAll());
+
+    // Разбираем все полные кадры и удаляем обработанную часть буфера разом
+    int offset = 0;
+    QByteArray payload;
+    bool ok = true;
+    while (ControlProtocol::readFrame(client.buffer, offset, payload, &ok))
+        handleCommand(socket, client, payload);
+    client.buffer.remove(0, offset);
+
+    if (!ok)
+    {
+        sendError(socket, "Превышен максимальный размер кадра");
+        socket->disconnectFromServer();
+    }
+}
+
+void ControlServer::onDisconnected()
+{
+    auto *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    const auto it = m_clients.find(socket);
+    if (it != m_clients.end())
+    {
+        if (it->subscribed)
+            setSubscriberCount(m_subscribers - 1);
+        m_clients.erase(it);
+    }
+    socket->deleteLater();
+}
+
+void ControlServer::handleCommand(QLocalSocket *socket, Client &client, const QByteArray &payload)
+{
+    QDataStream in(payload);
+    in.setVersion(ControlProtocol::STREAM_VERSION);
+
+    quint8 opcode = 0;
+    in >> opcode;
+
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out.setVersion(ControlProtocol::STREAM_VERSION);
+    out << static_cast<quint8>(opcode | ControlProtocol::REPLY_FLAG);
+
+    switch (opcode)
+    {
+    case ControlProtocol::AddTasks:
+    {
+        quint32 count = 0;
+        in >> count;
+
+        // Название занимает не меньше поля длины QString
+        if (!countFits(in, count, sizeof(quint32)))
+        {
+            sendError(socket, "Некорректная команда добавления задач");
+            return;
+        }
+
+        QStringList names;
+        names.reserve(static_cast<int>(count));
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+        {
+            QString name;
+            in >> name;
+            names.append(name.trimmed());
+        }
+
+        if (in.status() != QDataStream::Ok)
+        {
+            sendError(socket, "Некорректная команда добавления задач");
+            return;
+        }
+
+        const QList<quint64> ids = m_model->addTasks(names);
+        out << static_cast<quint32>(ids.count());
+        for (quint64 id : ids)
+            out << id;
+        break;
+    }
+    case ControlProtocol::StartTasks:
+    case ControlProtocol::StopTasks:
+    case ControlProtocol::RemoveTasks:
+    {
+        QList<quint64> ids;
+        if (!readTaskIds(in, ids))
+        {
+            sendError(socket, "Некорректный список задач");
+            return;
+        }
+
+        const QList<int> rows = rowsOfTasks(ids);
+        if (opcode == ControlProtocol::StartTasks)
+            m_model->startTasks(rows);
+        else if (opcode == ControlProtocol::StopTasks)
+            m_model->stopTasks(rows);
+        else
+            m_model->removeTasks(rows);
+
+        out << static_cast<quint32>(rows.count());
+        break;
+    }
+    case ControlProtocol::Subscribe:
+    {
+        quint8 enabled = 0;
+        in >> enabled;
+
+        const bool subscribe = enabled != 0;
+        if (client.subscribed != subscribe)
+        {
+            client.subscribed = subscribe;
+            setSubscriberCount(m_subscribers + (subscribe ? 1 : -1));
+        }
+        out << static_cast<quint32>(1);
+        break;
+    }
+    default:
+        sendError(socket, QString("Неизвестная команда 0x%1").arg(static_cast<int>(opcode), 2, 16, QChar('0')));
+        return;
+    }
+
+    socket->write(ControlProtocol::frame(reply));
+}
+
+QList<int> ControlServer::rowsOfTasks(const QList<quint64> &ids) const
+{
+    QList<int> rows;
+    rows.reserve(ids.count());
+    for (quint64 id : ids)
+    {
+        const int row = m_model->rowOfTask(id);
+        if (row != -1)
+            rows.append(row);
+    }
+    return rows;
+}
+
+void ControlServer::sendError(QLocalSocket *socket, const QString &message)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(ControlProtocol::STREAM_VERSION);
+    out << static_cast<quint8>(ControlProtocol::Error) << message;
+    socket->write(ControlProtocol::frame(payload));
+}
+
+void ControlServer::setSubscriberCount(int count)
+{
+    m_subscribers = count;
+    m_model->setProgressFeedActive(m_subscribers > 0);
+}
+
+void ControlServer::onTaskChanged(quint64 id)
+{
+    if (m_subscribers == 0)
+        return;
+
+    m_dirtyTasks.insert(id);
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void ControlServer::flushDeltas()
+{
+    if (m_dirtyTasks.isEmpty() || m_subscribers == 0)
+    {
+        m_dirtyTasks.clear();
+        return;
+    }
+
+    // Собираем только задачи, которые ещё есть в модели
+    QList<const Task*> tasks;
+    tasks.reserve(m_dirtyTasks.size());
+    for (quint64 id : std::as_const(m_dirtyTasks))
+    {
+        if (const Task *task = m_model->getTask(m_model->rowOfTask(id)))
+            tasks.append(task);
+    }
+    m_dirtyTasks.clear();
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(ControlProtocol::STREAM_VERSION);
+    out << static_cast<quint8>(ControlProtocol::ProgressDeltas)
+        << static_cast<quint32>(tasks.count());
+    for (const Task *task : tasks)
+    {
+        out << task->getId()
+            << static_cast<quint8>(task->getProgress())
+            << static_cast<quint8>(task->isRunning());
+    }
+
+    const QByteArray frame = ControlProtocol::frame(payload);
+    for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it)
+    {
+        if (it->subscribed)
+            it.key()->write(frame);
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTimer>
+#include "taskmodel.h"
+
+/**
+ * @class ControlServer
+ * @brief Локальный сервер управления задачами из других процессов
+ *
+ * ControlServer принимает подключения через QLocalServer и обрабатывает
+ * пакетные команды протокола ControlProtocol, передавая их напрямую в
+ * пакетные методы TaskModel. Подписанным клиентам рассылаются изменения
+ * прогресса, накопленные за кадр, а не отдельные такты задач.
+ */
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+    /// Интервал рассылки накопленных изменений прогресса (мс)
+    static constexpr int DELTA_FLUSH_INTERVAL = 16;
+
+public:
+    /**
+     * @brief Конструктор сервера
+     * @param model Модель задач, которой управляет сервер
+     * @param parent Родительский объект
+     */
+    explicit ControlServer(TaskModel *model, QObject *parent = nullptr);
+
+    /**
+     * @brief Начать приём подключений
+     * @param name Имя локального сокета
+     * @return true если сервер запущен
+     *
+     * Оставшийся от аварийно завершённого процесса сокет удаляется.
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief Получить описание последней ошибки сервера
+     * @return Текст ошибки
+     */
+    QString errorString() const { return m_server->errorString(); }
+
+private slots:
+    /**
+     * @brief Принять новые подключения
+     */
+    void onNewConnection();
+
+    /**
+     * @brief Прочитать и обработать кадры клиента
+     */
+    void onReadyRead();
+
+    /**
+     * @brief Освободить состояние отключившегося клиента
+     */
+    void onDisconnected();
+
+    /**
+     * @brief Запомнить изменившуюся задачу для рассылки подписчикам
+     * @param id Идентификатор задачи
+     *
+     * Подписка следует TaskModel::taskChanged(), а не dataChanged, поэтому
+     * не зависит от области просмотра и скрытия окна.
+     */
+    void onTaskChanged(quint64 id);
+
+    /**
+     * @brief Разослать подписчикам накопленные изменения прогресса
+     */
+    void flushDeltas();
+
+private:
+    /**
+     * @struct Client
+     * @brief Состояние подключения клиента
+     */
+    struct Client
+    {
+        QByteArray buffer;        ///< Принятые, но ещё не разобранные данные
+        bool subscribed{false};   ///< Подписан ли клиент на изменения прогресса
+    };
+
+    /**
+     * @brief Обработать одну команду
+     * @param socket Сокет клиента
+     * @param client Состояние клиента
+     * @param payload Полезная нагрузка кадра
+     */
+    void handleCommand(QLocalSocket *socket, Client &client, const QByteArray &payload);
+
+    /**
+     * @brief Преобразовать идентификаторы задач в строки модели
+     * @param ids Идентификаторы
+     * @return Строки существующих задач
+     */
+    QList<int> rowsOfTasks(const QList<quint64> &ids) const;
+
+    /**
+     * @brief Отправить клиенту ошибку
+     * @param socket Сокет клиента
+     * @param message Описание ошибки
+     */
+    void sendError(QLocalSocket *socket, const QString &message);
+
+    /**
+     * @brief Изменить количество подписчиков
+     * @param count Новое количество
+     *
+     * Включает ленту изменений модели, пока есть хотя бы один подписчик.
+     */
+    void setSubscriberCount(int count);
+
+    TaskModel *m_model{nullptr};               ///< Управляемая модель
+    QLocalServer *m_server{nullptr};           ///< Локальный сервер
+    QHash<QLocalSocket*, Client> m_clients{};  ///< Подключённые клиенты
+    int m_subscribers{0};                      ///< Количество подписчиков
+    QSet<quint64> m_dirtyTasks{};              ///< Задачи, изменившиеся с последней рассылки
+    QTimer *m_flushTimer{nullptr};             ///< Таймер рассылки изменений
+};
@@ -0,0 +1,28 @@
+#include "fenwicktree.h"
+
+void FenwickTree::assign(const std::vector<qint64> &values)
+{
+    // Каждый узел передаёт свою частичную сумму ближайшему покрывающему узлу
+    m_tree = values;
+    const int count = size();
+    for (int i = 0; i < count; ++i)
+    {
+        const int next = i | (i + 1);
+        if (next < count)
+            m_tree[next] += m_tree[i];
+    }
+}
+
+void FenwickTree::add(int position, qint64 delta)
+{
+    for (int i = position; i < size(); i |= i + 1)
+        m_tree[i] += delta;
+}
+
+qint64 FenwickTree::prefixSum(int end) const
+{
+    qint64 result = 0;
+    for (int i = qMin(end, size()) - 1; i >= 0; i = (i & (i + 1)) - 1)
+        result += m_tree[i];
+    return result;
+}
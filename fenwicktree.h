@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @class FenwickTree
+ * @brief Дерево Фенвика для сумм на отрезках
+ *
+ * Хранит последовательность чисел и поддерживает изменение элемента и
+ * сумму на отрезке за O(log n). Построение по готовой последовательности
+ * выполняется за O(n).
+ */
+class FenwickTree
+{
+public:
+    /**
+     * @brief Построить дерево по значениям
+     * @param values Значения элементов
+     */
+    void assign(const std::vector<qint64> &values);
+
+    /**
+     * @brief Получить количество элементов
+     * @return Количество элементов
+     */
+    int size() const { return static_cast<int>(m_tree.size()); }
+
+    /**
+     * @brief Прибавить к элементу
+     * @param position Номер элемента
+     * @param delta Приращение
+     */
+    void add(int position, qint64 delta);
+
+    /**
+     * @brief Получить сумму элементов [first, end)
+     * @param first Первый элемент
+     * @param end Элемент за последним
+     * @return Сумма (0 для пустого отрезка)
+     */
+    qint64 sum(int first, int end) const { return prefixSum(end) - prefixSum(first); }
+
+private:
+    /**
+     * @brief Получить сумму элементов [0, end)
+     * @param end Элемент за последним
+     * @return Сумма
+     */
+    qint64 prefixSum(int end) const;
+
+    std::vector<qint64> m_tree{};  ///< Частичные суммы (нумерация с нуля)
+};
@@ -0,0 +1,4 @@
+#include "instrumentation.h"
+
+std::array<quint64, Instrumentation::CounterCount> Instrumentation::s_counters{};
+std::array<LatencyHistogram, Instrumentation::SectionCount> Instrumentation::s_sections{};
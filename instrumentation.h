@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include "latencyhistogram.h"
+#include "monotonicclock.h"
+
+/**
+ * @class Instrumentation
+ * @brief Счётчики и таймеры горячих путей приложения
+ *
+ * Накопительные счётчики событий и гистограммы длительностей участков
+ * кода (обновление прогресса, обработка изменений моделью, фильтрация,
+ * отрисовка). Все точки измерения находятся в потоке GUI, поэтому
+ * синхронизация не используется.
+ *
+ * Точки измерения расставляются макросами DRW_COUNT и DRW_SCOPED_TIMER.
+ * При сборке без определения DRW_INSTRUMENTATION (опция CMake
+ * DRW_INSTRUMENTATION=OFF) макросы раскрываются в пустые операторы.
+ */
+class Instrumentation
+{
+public:
+    /**
+     * @enum Counter
+     * @brief Счётчики событий
+     */
+    enum Counter {
+        Ticks,              ///< Такты обновления прогресса задач
+        ModelDataChanged,   ///< Сигналы dataChanged модели
+        FilterEvaluations,  ///< Вызовы filterAcceptsRow прокси-модели
+        RowsPainted,        ///< Отрисованные строки
+        Frames,             ///< Кадры отрисовки списка задач
+        ProcessOutputReads, ///< Порции вывода внешних процессов, прочитанные TaskProcess
+        CounterCount
+    };
+
+    /**
+     * @enum Section
+     * @brief Измеряемые участки кода
+     */
+    enum Section {
+        TickSection,         ///< Task::updateProgress()
+        ModelUpdateSection,  ///< Обработка изменений задач в TaskModel
+        FilterPassSection,   ///< Полный проход фильтра при смене FilterType
+        PaintSection,        ///< TaskDelegate::paint()
+        TickToPixelSection,  ///< От изменения прогресса в Task до отрисовки строки
+        ProcessOutputSection, ///< Чтение и разбор вывода процесса в TaskProcess
+        SectionCount
+    };
+
+    Instrumentation() = delete;
+
+    /**
+     * @brief Проверить, собрано ли приложение с инструментированием
+     * @return true если точки измерения активны
+     */
+    static constexpr bool isEnabled()
+    {
+#ifdef DRW_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Увеличить счётчик
+     * @param counter Счётчик
+     * @param amount Величина увеличения
+     */
+    static void count(Counter counter, quint64 amount = 1) { s_counters[counter] += amount; }
+
+    /**
+     * @brief Получить значение счётчика
+     * @param counter Счётчик
+     * @return Накопленное значение
+     */
+    static quint64 counter(Counter counter) { return s_counters[counter]; }
+
+    /**
+     * @brief Записать длительность участка
+     * @param section Участок
+     * @param nsecs Длительность (нс)
+     */
+    static void record(Section section, qint64 nsecs) { s_sections[section].record(nsecs); }
+
+    /**
+     * @brief Получить накопленную гистограмму длительностей участка
+     * @param section Участок
+     * @return Гистограмма длительностей (нс)
+     */
+    static const LatencyHistogram &section(Section section) { return s_sections[section]; }
+
+    /**
+     * @class ScopedTimer
+     * @brief Измеряет длительность области видимости
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Section section)
+            : m_section(section)
+            , m_start(MonotonicClock::nsecs())
+        {
+        }
+
+        ~ScopedTimer() { record(m_section, MonotonicClock::nsecs() - m_start); }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Section m_section;  ///< Измеряемый участок
+        qint64 m_start;     ///< Время входа в область (нс)
+    };
+
+private:
+    static std::array<quint64, CounterCount> s_counters;            ///< Счётчики событий
+    static std::array<LatencyHistogram, SectionCount> s_sections;   ///< Гистограммы участков
+};
+
+#define DRW_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define DRW_INSTRUMENTATION_CONCAT(a, b) DRW_INSTRUMENTATION_CONCAT_(a, b)
+
+#ifdef DRW_INSTRUMENTATION
+/// Увеличить счётчик Instrumentation::Counter на единицу
+#define DRW_COUNT(counter) Instrumentation::count(Instrumentation::counter)
+/// Измерить длительность текущей области видимости как Instrumentation::Section
+#define DRW_SCOPED_TIMER(section) \
+    const Instrumentation::ScopedTimer DRW_INSTRUMENTATION_CONCAT(drwScopedTimer, __LINE__)(Instrumentation::section)
+#else
+#define DRW_COUNT(counter) do {} while (false)
+#define DRW_SCOPED_TIMER(section) do {} while (false)
+#endif
@@ -0,0 +1,91 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <limits>
+
+namespace {
+
+/// Количество бит, задающих положение внутри степени двойки
+constexpr int SUB_BUCKET_BITS = 3;
+
+static_assert((1 << SUB_BUCKET_BITS) == LatencyHistogram::SUB_BUCKETS,
+              "SUB_BUCKETS должно быть равно 2^SUB_BUCKET_BITS");
+
+} // namespace
+
+void LatencyHistogram::record(qint64 value)
+{
+    value = qMax<qint64>(value, 0);
+    ++m_buckets[bucketIndex(value)];
+    ++m_count;
+    m_sum += value;
+    m_max = qMax(m_max, value);
+}
+
+qint64 LatencyHistogram::percentile(double fraction) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const quint64 target = qMax<quint64>(1, static_cast<quint64>(fraction * m_count + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return qMin(bucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+quint64 LatencyHistogram::countAtOrBelow(qint64 bound) const
+{
+    quint64 result = 0;
+    for (int i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= bound; ++i)
+        result += m_buckets[i];
+    return result;
+}
+
+LatencyHistogram LatencyHistogram::difference(const LatencyHistogram &earlier) const
+{
+    LatencyHistogram result;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        result.m_buckets[i] = m_buckets[i] - earlier.m_buckets[i];
+    result.m_count = m_count - earlier.m_count;
+    result.m_sum = m_sum - earlier.m_sum;
+    result.m_max = m_max;
+    return result;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+int LatencyHistogram::bucketIndex(qint64 value)
+{
+    const quint64 v = static_cast<quint64>(value);
+    if (v < SUB_BUCKETS)
+        return static_cast<int>(v);
+
+    // Старший бит задаёт степень двойки, следующие SUB_BUCKET_BITS бит - корзину внутри неё
+    const int msb = 63 - qCountLeadingZeroBits(v);
+    const int sub = static_cast<int>((v >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return qMin((msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub, BUCKET_COUNT - 1);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+
+    const int msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const int sub = index % SUB_BUCKETS;
+    if (msb >= 62)
+        return std::numeric_limits<qint64>::max();
+
+    const quint64 lower = (quint64(1) << msb) | (quint64(sub) << (msb - SUB_BUCKET_BITS));
+    return static_cast<qint64>(lower + (quint64(1) << (msb - SUB_BUCKET_BITS)) - 1);
+}
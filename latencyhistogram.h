@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <QtGlobal>
+
+/**
+ * @class LatencyHistogram
+ * @brief Гистограмма длительностей с логарифмическими корзинами
+ *
+ * Корзины устроены по принципу HDR-гистограммы: каждая степень двойки
+ * делится на SUB_BUCKETS равных частей, что даёт относительную точность
+ * около 12% во всём диапазоне от наносекунд до часов при фиксированном
+ * объёме памяти. Запись значения выполняется за O(1).
+ */
+class LatencyHistogram
+{
+public:
+    /// Количество корзин на одну степень двойки
+    static constexpr int SUB_BUCKETS = 8;
+
+    /// Общее количество корзин
+    static constexpr int BUCKET_COUNT = 64 * SUB_BUCKETS;
+
+    /**
+     * @brief Записать значение
+     * @param value Значение (например, длительность в наносекундах)
+     */
+    void record(qint64 value);
+
+    /**
+     * @brief Получить количество записанных значений
+     * @return Количество значений
+     */
+    quint64 count() const { return m_count; }
+
+    /**
+     * @brief Получить сумму записанных значений
+     * @return Сумма значений
+     */
+    qint64 sum() const { return m_sum; }
+
+    /**
+     * @brief Получить максимальное записанное значение
+     * @return Максимум или 0 для пустой гистограммы
+     */
+    qint64 max() const { return m_max; }
+
+    /**
+     * @brief Получить перцентиль
+     * @param fraction Доля [0, 1], например 0.99
+     * @return Верхняя граница корзины, содержащей перцентиль
+     */
+    qint64 percentile(double fraction) const;
+
+    /**
+     * @brief Получить количество значений, не превышающих границу
+     * @param bound Граница
+     * @return Количество значений в корзинах, целиком лежащих не выше границы
+     *
+     * Используется для экспорта накопительных гистограмм.
+     */
+    quint64 countAtOrBelow(qint64 bound) const;
+
+    /**
+     * @brief Получить разность с более ранним снимком той же гистограммы
+     * @param earlier Снимок, сделанный раньше
+     * @return Гистограмма значений, записанных после снимка
+     *
+     * Максимум разности равен максимуму текущей гистограммы.
+     */
+    LatencyHistogram difference(const LatencyHistogram &earlier) const;
+
+    /**
+     * @brief Очистить гистограмму
+     */
+    void reset();
+
+    /**
+     * @brief Получить индекс корзины значения
+     * @param value Значение
+     * @return Индекс корзины [0, BUCKET_COUNT)
+     */
+    static int bucketIndex(qint64 value);
+
+    /**
+     * @brief Получить верхнюю границу корзины
+     * @param index Индекс корзины
+     * @return Наибольшее значение, попадающее в корзину
+     */
+    static qint64 bucketUpperBound(int index);
+
+private:
+    std::array<quint64, BUCKET_COUNT> m_buckets{};  ///< Количество значений по корзинам
+    quint64 m_count{0};                             ///< Количество значений
+    qint64 m_sum{0};                                ///< Сумма значений
+    qint64 m_max{0};                                ///< Максимальное значение
+};
@@ -1,11 +1,160 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <memory>
 
+#include "benchmarkrunner.h"
+#include "taskeventlog.h"
 #include "taskmanager.h"
+#include "workloadtrace.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption benchmarkOption(
+        "benchmark",
+        "Запустить бенчмарк без показа окна: " + BenchmarkRunner::availableBenchmarks().join(", "),
+        "name");
+    parser.addOption(benchmarkOption);
+    const QCommandLineOption controlOption(
+        "control",
+        "Запустить локальный сервер управления задачами с указанным именем сокета.",
+        "name");
+    parser.addOption(controlOption);
+    const QCommandLineOption eventLogOption(
+        "event-log",
+        "Записывать события жизненного цикла задач в указанный файл.",
+        "path");
+    parser.addOption(eventLogOption);
+    const QCommandLineOption eventLogFormatOption(
+        "event-log-format",
+        "Формат журнала событий: ndjson (по умолчанию) или trace (chrome://tracing).",
+        "format",
+        "ndjson");
+    parser.addOption(eventLogFormatOption);
+    const QCommandLineOption metricsPortOption(
+        "metrics-port",
+        "Отдавать показатели в формате Prometheus по адресу http://127.0.0.1:<port>/metrics.",
+        "port");
+    parser.addOption(metricsPortOption);
+    const QCommandLineOption metricsFileOption(
+        "metrics-file",
+        "Периодически записывать показатели в файл для textfile-коллектора node-exporter.",
+        "path");
+    parser.addOption(metricsFileOption);
+    const QCommandLineOption computedProgressOption(
+        "computed-progress",
+        "Вычислять прогресс задач по времени выполнения вместо тактов таймеров.");
+    parser.addOption(computedProgressOption);
+    const QCommandLineOption archiveOption(
+        "archive",
+        "Показывать завершённые задачи из файла архива, подгружая их при прокрутке.",
+        "path");
+    parser.addOption(archiveOption);
+    const QCommandLineOption archiveCacheOption(
+        "archive-cache-mb",
+        "Ограничение памяти кэша страниц архива в мегабайтах.",
+        "mb",
+        QString::number(TaskArchive::DEFAULT_MEMORY_LIMIT / (1024 * 1024)));
+    parser.addOption(archiveCacheOption);
+    const QCommandLineOption coldStorageOption(
+        "cold-after",
+        "Через сколько секунд после завершения переносить задачу в компактное хранилище "
+        "(отрицательное значение отключает перенос).",
+        "seconds",
+        QString::number(TaskModel::DEFAULT_COLD_STORAGE_DELAY / 1000));
+    parser.addOption(coldStorageOption);
+    const QCommandLineOption sessionOption(
+        "session",
+        "Сохранять задачи в файл снимка при закрытии и восстанавливать их после первой отрисовки.",
+        "path");
+    parser.addOption(sessionOption);
+    const QCommandLineOption progressPatternOption(
+        "progress-pattern",
+        "Шаблон прогресса в выводе задач-команд (\"$ команда\"), {} - место числа.",
+        "pattern",
+        ProgressPattern::DEFAULT_PATTERN);
+    parser.addOption(progressPatternOption);
+    const QCommandLineOption recordOption(
+        "record",
+        "Записывать операции над задачами (добавление, удаление, запуск, остановка, фильтр, прокрутка) в файл трассы.",
+        "path");
+    parser.addOption(recordOption);
+    const QCommandLineOption replayOption(
+        "replay",
+        "Воспроизвести трассу операций в пустом списке задач (без сессии) и вывести время операций.",
+        "path");
+    parser.addOption(replayOption);
+    const QCommandLineOption replaySpeedOption(
+        "replay-speed",
+        "Темп воспроизведения трассы: original (по умолчанию) или max.",
+        "speed",
+        "original");
+    parser.addOption(replaySpeedOption);
+    parser.addPositionalArgument("args", "Дополнительные аргументы бенчмарка.", "[args...]");
+    parser.process(app);
+
+    if (parser.isSet(benchmarkOption))
+        return BenchmarkRunner().run(parser.value(benchmarkOption), parser.positionalArguments());
+
+    std::unique_ptr<TaskEventLog> eventLog;
+    if (parser.isSet(eventLogOption))
+    {
+        const auto format = parser.value(eventLogFormatOption) == "trace"
+            ? TaskEventLog::ChromeTrace
+            : TaskEventLog::NdJson;
+        eventLog = std::make_unique<TaskEventLog>(parser.value(eventLogOption), format);
+        if (!eventLog->start())
+        {
+            qWarning("Не удалось открыть журнал событий: %s",
+                     qPrintable(eventLog->errorString()));
+            eventLog.reset();
+        }
+    }
+
+    std::unique_ptr<WorkloadTrace> workloadTrace;
+    if (parser.isSet(recordOption))
+    {
+        workloadTrace = std::make_unique<WorkloadTrace>(parser.value(recordOption));
+        if (!workloadTrace->start())
+        {
+            qWarning("Не удалось открыть файл трассы: %s",
+                     qPrintable(workloadTrace->errorString()));
+            workloadTrace.reset();
+        }
+    }
+
     TaskManager window;
+    window.setComputedProgress(parser.isSet(computedProgressOption));
+    const int coldStorageDelay = parser.value(coldStorageOption).toInt();
+    window.setColdStorageDelay(coldStorageDelay < 0 ? -1 : coldStorageDelay * 1000);
+    window.setProgressPattern(parser.value(progressPatternOption).toUtf8());
+    // Трасса воспроизводится в пустую модель: задачи снимка конфликтовали бы
+    // с её названиями, а результат воспроизведения не должен попасть в снимок
+    if (parser.isSet(sessionOption) && parser.isSet(replayOption))
+        qWarning("--session не действует вместе с --replay");
+    else if (parser.isSet(sessionOption))
+        window.setSessionFile(parser.value(sessionOption));
+    if (parser.isSet(archiveOption))
+        window.openArchive(parser.value(archiveOption), parser.value(archiveCacheOption).toLongLong() * 1024 * 1024);
+    if (parser.isSet(controlOption))
+        window.startControlServer(parser.value(controlOption));
+    if (parser.isSet(metricsPortOption) || parser.isSet(metricsFileOption))
+    {
+        const int port = parser.isSet(metricsPortOption) ? parser.value(metricsPortOption).toInt() : -1;
+        window.startMetricsExporter(port, parser.value(metricsFileOption));
+    }
+    if (parser.isSet(replayOption))
+    {
+        const QString path = parser.value(replayOption);
+        const auto speed = parser.value(replaySpeedOption) == "max"
+            ? WorkloadReplayer::Maximum
+            : WorkloadReplayer::Original;
+        QObject::connect(&window, &TaskManager::sessionRestored, &window, [&window, path, speed]() {
+            window.replayWorkload(path, speed);
+        });
+    }
     window.show();
 
     return app.exec();
@@ -0,0 +1,214 @@
+#include "metricsexporter.h"
+#include "instrumentation.h"
+#include "processinfo.h"
+#include <QSaveFile>
+
+namespace {
+
+/// Границы корзин гистограмм длительностей (нс) для публикации
+constexpr qint64 HISTOGRAM_BOUNDS[] = {
+    50000, 100000, 250000, 500000, 1000000, 2500000,
+    5000000, 10000000, 25000000, 50000000, 100000000, 250000000
+};
+
+/// Добавить заголовки HELP и TYPE показателя
+void writeHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+/// Добавить значение показателя
+void writeSample(QByteArray &out, const char *name, const QByteArray &labels, qint64 value)
+{
+    out += name;
+    if (!labels.isEmpty())
+        out += '{' + labels + '}';
+    out += ' ';
+    out += QByteArray::number(value);
+    out += '\n';
+}
+
+/// Добавить гистограмму длительностей в секундах
+void writeHistogram(QByteArray &out, const char *name, const char *help, const LatencyHistogram &histogram)
+{
+    writeHeader(out, name, "histogram", help);
+
+    const QByteArray base(name);
+    for (qint64 bound : HISTOGRAM_BOUNDS)
+    {
+        out += base + "_bucket{le=\"" + QByteArray::number(bound / 1e9, 'g', 6) + "\"} ";
+        out += QByteArray::number(histogram.countAtOrBelow(bound)) + '\n';
+    }
+    out += base + "_bucket{le=\"+Inf\"} " + QByteArray::number(histogram.count()) + '\n';
+    out += base + "_sum " + QByteArray::number(histogram.sum() / 1e9, 'g', 12) + '\n';
+    out += base + "_count " + QByteArray::number(histogram.count()) + '\n';
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(TaskModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+{
+}
+
+bool MetricsExporter::listen(quint16 port)
+{
+    if (!m_server)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &MetricsExporter::onNewConnection);
+    }
+
+    if (!m_server->listen(QHostAddress::LocalHost, port))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool MetricsExporter::setTextFile(const QString &path, int interval)
+{
+    m_filePath = path;
+    if (!m_fileTimer)
+    {
+        m_fileTimer = new QTimer(this);
+        connect(m_fileTimer, &QTimer::timeout, this, &MetricsExporter::writeTextFile);
+    }
+    m_fileTimer->start(interval);
+    return writeTextFile();
+}
+
+QByteArray MetricsExporter::render() const
+{
+    const TaskStatistics &stats = m_model->statistics();
+    const TaskPool::Statistics pool = m_model->poolStatistics();
+
+    QByteArray out;
+    out.reserve(4096);
+
+    writeHeader(out, "drw_tasks", "gauge", "Number of tasks by state.");
+    writeSample(out, "drw_tasks", "state=\"running\"", stats.running);
+    writeSample(out, "drw_tasks", "state=\"stopped\"", stats.stopped);
+    writeSample(out, "drw_tasks", "state=\"completed\"", stats.completed);
+
+    writeHeader(out, "drw_task_progress_average", "gauge", "Average task progress in percent.");
+    writeSample(out, "drw_task_progress_average", {}, stats.averageProgress());
+
+    writeHeader(out, "drw_removal_queue_depth", "gauge", "Tasks waiting to be released by asynchronous removal.");
+    writeSample(out, "drw_removal_queue_depth", {}, m_model->pendingRemovals());
+
+    writeHeader(out, "drw_scheduler_queue_depth", "gauge", "Pending task scheduler events.");
+    writeSample(out, "drw_scheduler_queue_depth", {}, m_model->scheduledEvents());
+
+    writeHeader(out, "drw_task_pool_tasks", "gauge", "Task objects owned by the pool.");
+    writeSample(out, "drw_task_pool_tasks", "state=\"in_use\"", pool.inUse);
+    writeSample(out, "drw_task_pool_tasks", "state=\"free\"", pool.free);
+
+    if (Instrumentation::isEnabled())
+    {
+        writeHeader(out, "drw_task_ticks_total", "counter", "Task progress updates.");
+        writeSample(out, "drw_task_ticks_total", {}, Instrumentation::counter(Instrumentation::Ticks));
+
+        writeHeader(out, "drw_model_updates_total", "counter", "Model dataChanged notifications.");
+        writeSample(out, "drw_model_updates_total", {}, Instrumentation::counter(Instrumentation::ModelDataChanged));
+
+        writeHeader(out, "drw_rows_painted_total", "counter", "Task rows painted by the delegate.");
+        writeSample(out, "drw_rows_painted_total", {}, Instrumentation::counter(Instrumentation::RowsPainted));
+
+        writeHeader(out, "drw_process_output_reads_total", "counter", "Output chunks read from task processes.");
+        writeSample(out, "drw_process_output_reads_total", {}, Instrumentation::counter(Instrumentation::ProcessOutputReads));
+
+        writeHistogram(out, "drw_paint_duration_seconds", "Time to paint one task row.",
+                       Instrumentation::section(Instrumentation::PaintSection));
+        writeHistogram(out, "drw_tick_to_pixel_seconds", "Delay from a progress change to its first paint.",
+                       Instrumentation::section(Instrumentation::TickToPixelSection));
+    }
+
+    const qint64 rss = ProcessInfo::residentMemory();
+    if (rss >= 0)
+    {
+        writeHeader(out, "drw_process_resident_memory_bytes", "gauge", "Resident memory size in bytes.");
+        writeSample(out, "drw_process_resident_memory_bytes", {}, rss);
+    }
+
+    return out;
+}
+
+void MetricsExporter::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection())
+    {
+        m_requests.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsExporter::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_requests.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MetricsExporter::onReadyRead()
+{
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || !m_requests.contains(socket))
+        return;
+
+    QByteArray &request = m_requests[socket];
+    request.append(socket->readAll());
+
+    if (request.size() > MAX_REQUEST_SIZE)
+    {
+        respond(socket, "431 Request Header Fields Too Large", {});
+        return;
+    }
+    if (!request.contains("\r\n\r\n"))
+        return;
+
+    // Строка запроса: метод, путь, версия
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    const QByteArray method = requestLine.value(0);
+    const QByteArray path = requestLine.value(1);
+
+    if (method != "GET")
+        respond(socket, "405 Method Not Allowed", {});
+    else if (path != "/metrics" && !path.startsWith("/metrics?"))
+        respond(socket, "404 Not Found", {});
+    else
+        respond(socket, "200 OK", render());
+}
+
+bool MetricsExporter::writeTextFile()
+{
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(render()) < 0 || !file.commit())
+    {
+        m_errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::respond(QTcpSocket *socket, const QByteArray &status, const QByteArray &body)
+{
+    m_requests.remove(socket);
+    disconnect(socket, &QTcpSocket::readyRead, this, &MetricsExporter::onReadyRead);
+
+    QByteArray response = "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+
+    socket->write(response);
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include "latencyhistogram.h"
+#include "taskmodel.h"
+
+/**
+ * @class MetricsExporter
+ * @brief Публикация показателей в текстовом формате Prometheus
+ *
+ * MetricsExporter формирует показатели из инкрементально поддерживаемых
+ * счётчиков (TaskStatistics модели, статистика пула, Instrumentation),
+ * поэтому стоимость одного опроса не зависит от количества задач.
+ * Пока окно скрыто и такты задач приостановлены, количество задач по
+ * состояниям остаётся точным (завершение приходит по событию таймера
+ * задачи), а средний прогресс - последним известным до скрытия окна.
+ * Показатели отдаются по HTTP на localhost (GET /metrics) и/или
+ * периодически записываются в файл для textfile-коллектора node-exporter.
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+    /// Интервал перезаписи файла показателей по умолчанию (мс)
+    static constexpr int DEFAULT_FILE_INTERVAL = 15000;
+
+    /// Максимальный размер заголовков HTTP-запроса
+    static constexpr int MAX_REQUEST_SIZE = 8192;
+
+public:
+    /**
+     * @brief Конструктор
+     * @param model Модель задач, показатели которой публикуются
+     * @param parent Родительский объект
+     */
+    explicit MetricsExporter(TaskModel *model, QObject *parent = nullptr);
+
+    /**
+     * @brief Начать приём HTTP-запросов на localhost
+     * @param port Порт (0 - выбрать свободный)
+     * @return true если сервер запущен
+     */
+    bool listen(quint16 port);
+
+    /**
+     * @brief Получить порт HTTP-сервера
+     * @return Номер порта или 0, если сервер не запущен
+     */
+    quint16 serverPort() const { return m_server ? m_server->serverPort() : 0; }
+
+    /**
+     * @brief Включить периодическую запись показателей в файл
+     * @param path Путь к файлу (*.prom)
+     * @param interval Интервал перезаписи (мс)
+     * @return true если файл успешно записан в первый раз
+     *
+     * Файл заменяется атомарно, поэтому коллектор не читает его частично.
+     */
+    bool setTextFile(const QString &path, int interval = DEFAULT_FILE_INTERVAL);
+
+    /**
+     * @brief Получить описание последней ошибки
+     * @return Текст ошибки
+     */
+    QString errorString() const { return m_errorString; }
+
+    /**
+     * @brief Сформировать текущие показатели
+     * @return Текст в формате Prometheus exposition 0.0.4
+     */
+    QByteArray render() const;
+
+private slots:
+    /**
+     * @brief Принять новые подключения
+     */
+    void onNewConnection();
+
+    /**
+     * @brief Прочитать запрос клиента и ответить на него
+     */
+    void onReadyRead();
+
+    /**
+     * @brief Перезаписать файл показателей
+     * @return true если файл записан
+     */
+    bool writeTextFile();
+
+private:
+    /**
+     * @brief Отправить HTTP-ответ и закрыть соединение
+     * @param socket Сокет клиента
+     * @param status Строка статуса ("200 OK")
+     * @param body Тело ответа
+     */
+    void respond(QTcpSocket *socket, const QByteArray &status, const QByteArray &body);
+
+    TaskModel *m_model{nullptr};                ///< Модель задач
+    QTcpServer *m_server{nullptr};              ///< HTTP-сервер (создаётся в listen())
+    QHash<QTcpSocket*, QByteArray> m_requests{}; ///< Принятые части запросов
+    QTimer *m_fileTimer{nullptr};               ///< Таймер перезаписи файла
+    QString m_filePath;                         ///< Путь к файлу показателей
+    QString m_errorString;                      ///< Описание последней ошибки
+};
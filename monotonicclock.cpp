@@ -0,0 +1,22 @@
+#include "monotonicclock.h"
+#include <QElapsedTimer>
+
+namespace {
+
+/// Запущенный при первом обращении таймер
+const QElapsedTimer &referenceTimer()
+{
+    static const QElapsedTimer timer = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+} // namespace
+
+qint64 MonotonicClock::nsecs()
+{
+    return referenceTimer().nsecsElapsed();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @class MonotonicClock
+ * @brief Общие монотонные часы приложения
+ *
+ * Отсчитывает время от первого обращения. Не зависит от перевода
+ * системных часов, поэтому подходит для измерения интервалов и
+ * временных меток событий.
+ */
+class MonotonicClock
+{
+public:
+    MonotonicClock() = delete;
+
+    /**
+     * @brief Получить текущее время в наносекундах
+     * @return Наносекунды с момента первого обращения к часам
+     */
+    static qint64 nsecs();
+
+    /**
+     * @brief Получить текущее время в миллисекундах
+     * @return Миллисекунды с момента первого обращения к часам
+     */
+    static qint64 msecs() { return nsecs() / 1000000; }
+};
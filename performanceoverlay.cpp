@@ -0,0 +1,113 @@
+#include "performanceoverlay.h"
+#include <QEvent>
+#include <QStringList>
+
+PerformanceOverlay::PerformanceOverlay(QWidget *parent, QWidget *viewport)
+    : QLabel(parent)
+    , m_viewport(viewport)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setTextFormat(Qt::PlainText);
+    setObjectName("performanceOverlay");
+
+    m_viewport->installEventFilter(this);
+    parent->installEventFilter(this);
+
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setInterval(UPDATE_INTERVAL);
+    connect(m_updateTimer, &QTimer::timeout, this, &PerformanceOverlay::updateMetrics);
+    m_updateTimer->start();
+
+    m_lagTimer = new QTimer(this);
+    m_lagTimer->setTimerType(Qt::PreciseTimer);
+    m_lagTimer->setInterval(LAG_PROBE_INTERVAL);
+    connect(m_lagTimer, &QTimer::timeout, this, &PerformanceOverlay::probeLag);
+    m_lagTimer->start();
+
+    for (int i = 0; i < Instrumentation::CounterCount; ++i)
+        m_lastCounters[i] = Instrumentation::counter(static_cast<Instrumentation::Counter>(i));
+    m_lastPaint = Instrumentation::section(Instrumentation::PaintSection);
+    m_lastTickToPixel = Instrumentation::section(Instrumentation::TickToPixelSection);
+    m_window.start();
+    m_lagClock.start();
+
+    updateMetrics();
+}
+
+bool PerformanceOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_viewport && event->type() == QEvent::Paint)
+        DRW_COUNT(Frames);
+    else if (watched == parentWidget() && event->type() == QEvent::Resize)
+        reposition();
+
+    return QLabel::eventFilter(watched, event);
+}
+
+void PerformanceOverlay::updateMetrics()
+{
+    const double seconds = qMax<qint64>(m_window.restart(), 1) / 1000.0;
+
+    std::array<quint64, Instrumentation::CounterCount> delta{};
+    for (int i = 0; i < Instrumentation::CounterCount; ++i)
+    {
+        const quint64 value = Instrumentation::counter(static_cast<Instrumentation::Counter>(i));
+        delta[i] = value - m_lastCounters[i];
+        m_lastCounters[i] = value;
+    }
+
+    const LatencyHistogram &paintTotal = Instrumentation::section(Instrumentation::PaintSection);
+    const LatencyHistogram paint = paintTotal.difference(m_lastPaint);
+    m_lastPaint = paintTotal;
+
+    const LatencyHistogram &tickToPixelTotal = Instrumentation::section(Instrumentation::TickToPixelSection);
+    const LatencyHistogram tickToPixel = tickToPixelTotal.difference(m_lastTickToPixel);
+    m_lastTickToPixel = tickToPixelTotal;
+
+    const double lagMs = m_maxLagNs / 1e6;
+    m_maxLagNs = 0;
+
+    QStringList lines;
+    if (Instrumentation::isEnabled())
+    {
+        const quint64 frames = delta[Instrumentation::Frames];
+        lines << QString("такты/с:        %1").arg(delta[Instrumentation::Ticks] / seconds, 0, 'f', 0)
+              << QString("dataChanged/с:  %1").arg(delta[Instrumentation::ModelDataChanged] / seconds, 0, 'f', 0)
+              << QString("фильтр/с:       %1").arg(delta[Instrumentation::FilterEvaluations] / seconds, 0, 'f', 0)
+              << QString("кадры/с:        %1").arg(frames / seconds, 0, 'f', 1)
+              << QString("строк/кадр:     %1").arg(frames > 0 ? double(delta[Instrumentation::RowsPainted]) / frames : 0.0, 0, 'f', 1)
+              << QString("paint p50/p99:  %1 / %2 мкс")
+                     .arg(paint.percentile(0.50) / 1000.0, 0, 'f', 1)
+                     .arg(paint.percentile(0.99) / 1000.0, 0, 'f', 1)
+              << QString("тик→пиксель:    %1 / %2 мс")
+                     .arg(tickToPixel.percentile(0.50) / 1e6, 0, 'f', 1)
+                     .arg(tickToPixel.percentile(0.99) / 1e6, 0, 'f', 1);
+    }
+    else
+    {
+        lines << "Инструментирование отключено при сборке"
+              << "(DRW_INSTRUMENTATION=OFF)";
+    }
+    lines << QString("задержка цикла: %1 мс").arg(lagMs, 0, 'f', 1);
+
+    setText(lines.join('\n'));
+    adjustSize();
+    reposition();
+}
+
+void PerformanceOverlay::probeLag()
+{
+    // Задержка - превышение фактического интервала над заданным
+    const qint64 lag = m_lagClock.nsecsElapsed() - qint64(LAG_PROBE_INTERVAL) * 1000000;
+    m_lagClock.restart();
+    m_maxLagNs = qMax(m_maxLagNs, lag);
+}
+
+void PerformanceOverlay::reposition()
+{
+    if (!parentWidget())
+        return;
+
+    move(parentWidget()->width() - width() - OVERLAY_MARGIN, OVERLAY_MARGIN);
+    raise();
+}
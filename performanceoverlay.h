@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTimer>
+#include "instrumentation.h"
+
+/**
+ * @class PerformanceOverlay
+ * @brief Панель показателей производительности поверх окна
+ *
+ * Отображает частоту тактов задач и сигналов dataChanged, количество
+ * отрисованных строк на кадр, перцентили p50/p99 времени отрисовки строки
+ * и задержки от изменения прогресса до отрисовки, задержку цикла событий. Показатели вычисляются по разности счётчиков
+ * Instrumentation за интервал обновления панели.
+ */
+class PerformanceOverlay : public QLabel
+{
+    Q_OBJECT
+
+    /// Интервал обновления показателей (мс)
+    static constexpr int UPDATE_INTERVAL = 500;
+
+    /// Интервал таймера измерения задержки цикла событий (мс)
+    static constexpr int LAG_PROBE_INTERVAL = 50;
+
+    /// Отступ панели от краёв родительского виджета
+    static constexpr int OVERLAY_MARGIN = 12;
+
+public:
+    /**
+     * @brief Конструктор панели
+     * @param parent Виджет, поверх которого отображается панель
+     * @param viewport Область отрисовки списка, кадры которой подсчитываются
+     */
+    PerformanceOverlay(QWidget *parent, QWidget *viewport);
+
+protected:
+    /**
+     * @brief Подсчитать кадры и отследить изменение размера родителя
+     * @param watched Отслеживаемый объект
+     * @param event Событие
+     * @return false - события не поглощаются
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    /**
+     * @brief Пересчитать и отобразить показатели
+     */
+    void updateMetrics();
+
+    /**
+     * @brief Измерить задержку срабатывания таймера
+     */
+    void probeLag();
+
+private:
+    /**
+     * @brief Разместить панель в правом верхнем углу родителя
+     */
+    void reposition();
+
+    QWidget *m_viewport{nullptr};           ///< Отслеживаемая область отрисовки
+    QTimer *m_updateTimer{nullptr};         ///< Таймер обновления показателей
+    QTimer *m_lagTimer{nullptr};            ///< Таймер измерения задержки
+    QElapsedTimer m_window;                 ///< Длительность текущего интервала
+    QElapsedTimer m_lagClock;               ///< Время с прошлого срабатывания m_lagTimer
+    qint64 m_maxLagNs{0};                   ///< Максимальная задержка за интервал (нс)
+    std::array<quint64, Instrumentation::CounterCount> m_lastCounters{}; ///< Счётчики на начало интервала
+    LatencyHistogram m_lastPaint;           ///< Гистограмма отрисовки на начало интервала
+    LatencyHistogram m_lastTickToPixel;     ///< Гистограмма задержки до отрисовки на начало интервала
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @class ProcessInfo
+ * @brief Сведения о ресурсах текущего процесса
+ *
+ * Предоставляет платформенно-независимый доступ к показателям процесса,
+ * используемым бенчмарками и диагностикой.
+ */
+class ProcessInfo
+{
+public:
+    ProcessInfo() = delete;
+
+    /**
+     * @brief Получить объём резидентной памяти процесса (RSS)
+     * @return Размер в байтах или -1, если платформа не поддерживается
+     */
+    static qint64 residentMemory();
+};
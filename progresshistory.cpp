@@ -0,0 +1,93 @@
+#include "progresshistory.h"
+
+namespace {
+
+/// Счётчик ревизий, общий для всех историй процесса
+quint32 g_nextRevision = 0;
+
+} // namespace
+
+void ProgressHistory::append(int progress, qint64 timestampMs)
+{
+    m_revision = ++g_nextRevision;
+
+    if (m_count == 0)
+    {
+        m_samples[m_head] = 0;
+        m_baseProgress = static_cast<quint8>(progress);
+        m_lastProgress = m_baseProgress;
+        m_lastTimestampMs = timestampMs;
+        m_count = 1;
+        return;
+    }
+
+    // Прирост ограничивается MAX_DELTA; остаток войдёт в следующий замер
+    const int delta = qBound(0, progress - m_lastProgress, MAX_DELTA);
+    const quint8 packed = static_cast<quint8>(delta << 4)
+                          | encodeInterval(timestampMs - m_lastTimestampMs);
+
+    if (m_count == CAPACITY)
+    {
+        // Вытесняем самый старый замер: базой становится следующий
+        m_head = (m_head + 1) % CAPACITY;
+        m_baseProgress += m_samples[m_head] >> 4;
+        --m_count;
+    }
+
+    m_samples[(m_head + m_count) % CAPACITY] = packed;
+    ++m_count;
+    m_lastProgress += delta;
+    m_lastTimestampMs = timestampMs;
+}
+
+void ProgressHistory::clear()
+{
+    m_revision = ++g_nextRevision;
+    m_head = 0;
+    m_count = 0;
+    m_baseProgress = 0;
+    m_lastProgress = 0;
+    m_lastTimestampMs = 0;
+}
+
+QVector<ProgressHistory::Sample> ProgressHistory::samples() const
+{
+    QVector<Sample> result;
+    result.reserve(m_count);
+
+    qint64 offset = 0;
+    int progress = m_baseProgress;
+    for (int i = 0; i < m_count; ++i)
+    {
+        // Прирост и интервал самого старого замера уже учтены в базе
+        if (i > 0)
+        {
+            const quint8 packed = m_samples[(m_head + i) % CAPACITY];
+            progress += packed >> 4;
+            offset += decodeInterval(packed & 0x0F);
+        }
+        result.append({offset, progress});
+    }
+    return result;
+}
+
+quint8 ProgressHistory::encodeInterval(qint64 intervalMs)
+{
+    if (intervalMs < TIME_QUANTUM_MS / 2)
+        return 0;
+
+    // Ближайшая степень двойки кванта
+    quint8 code = 1;
+    qint64 bound = TIME_QUANTUM_MS;
+    while (code < 15 && intervalMs > bound + bound / 2)
+    {
+        bound *= 2;
+        ++code;
+    }
+    return code;
+}
+
+qint64 ProgressHistory::decodeInterval(quint8 code)
+{
+    return code == 0 ? 0 : qint64(TIME_QUANTUM_MS) << (code - 1);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <QMetaType>
+#include <QVector>
+
+/**
+ * @class ProgressHistory
+ * @brief Компактная кольцевая история прогресса задачи
+ *
+ * Хранит последние CAPACITY замеров прогресса в дельта-кодировке:
+ * каждый замер занимает один байт, где старшие 4 бита - прирост прогресса
+ * относительно предыдущего замера, а младшие 4 бита - логарифмически
+ * квантованный интервал времени. Абсолютные значения восстанавливаются
+ * от прогресса самого старого замера.
+ */
+class ProgressHistory
+{
+public:
+    /// Количество хранимых замеров
+    static constexpr int CAPACITY = 64;
+
+    /// Базовый квант интервала времени (мс), код k соответствует TIME_QUANTUM_MS * 2^(k-1)
+    static constexpr int TIME_QUANTUM_MS = 16;
+
+    /// Максимальный прирост прогресса, кодируемый одним замером
+    static constexpr int MAX_DELTA = 15;
+
+    /**
+     * @struct Sample
+     * @brief Восстановленный замер прогресса
+     */
+    struct Sample
+    {
+        qint64 offsetMs;  ///< Время от самого старого замера (мс)
+        int progress;     ///< Значение прогресса
+    };
+
+    /**
+     * @brief Добавить замер
+     * @param progress Текущий прогресс [0, 100]
+     * @param timestampMs Время замера (мс, монотонное)
+     *
+     * При заполнении кольца самый старый замер вытесняется.
+     */
+    void append(int progress, qint64 timestampMs);
+
+    /**
+     * @brief Очистить историю
+     */
+    void clear();
+
+    /**
+     * @brief Получить количество замеров
+     * @return Количество замеров [0, CAPACITY]
+     */
+    int count() const { return m_count; }
+
+    /**
+     * @brief Получить номер ревизии истории
+     * @return Уникальный в пределах процесса номер, меняющийся при каждом замере
+     *
+     * Используется как ключ кэша отрисовки: одинаковые номера означают
+     * одинаковое содержимое.
+     */
+    quint32 revision() const { return m_revision; }
+
+    /**
+     * @brief Восстановить замеры
+     * @return Замеры от самого старого к самому новому
+     */
+    QVector<Sample> samples() const;
+
+private:
+    /**
+     * @brief Закодировать интервал времени
+     * @param intervalMs Интервал (мс)
+     * @return Код [0, 15]
+     */
+    static quint8 encodeInterval(qint64 intervalMs);
+
+    /**
+     * @brief Раскодировать интервал времени
+     * @param code Код [0, 15]
+     * @return Интервал (мс)
+     */
+    static qint64 decodeInterval(quint8 code);
+
+    std::array<quint8, CAPACITY> m_samples{};  ///< Упакованные замеры (прирост << 4 | код интервала)
+    qint64 m_lastTimestampMs{0};               ///< Время последнего замера (мс)
+    quint32 m_revision{0};                     ///< Номер ревизии
+    quint8 m_head{0};                          ///< Индекс самого старого замера
+    quint8 m_count{0};                         ///< Количество замеров
+    quint8 m_baseProgress{0};                  ///< Прогресс самого старого замера
+    quint8 m_lastProgress{0};                  ///< Восстановленный прогресс последнего замера
+};
+
+Q_DECLARE_METATYPE(ProgressHistory)
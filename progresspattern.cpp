@@ -0,0 +1,119 @@
+#include "progresspattern.h"
+
+ProgressPattern::ProgressPattern(const QByteArray &pattern)
+{
+    const int placeholder = pattern.indexOf(PLACEHOLDER);
+    if (placeholder == -1)
+    {
+        m_prefix = pattern;
+    }
+    else
+    {
+        m_prefix = pattern.left(placeholder);
+        m_suffix = pattern.mid(placeholder + int(sizeof(PLACEHOLDER)) - 1);
+    }
+
+    // Функция отказов позволяет не терять совпадения при частичных повторах префикса
+    m_prefixFailure.assign(m_prefix.size(), 0);
+    for (int i = 1, k = 0; i < m_prefix.size(); ++i)
+    {
+        while (k > 0 && m_prefix.at(i) != m_prefix.at(k))
+            k = m_prefixFailure[k - 1];
+        if (m_prefix.at(i) == m_prefix.at(k))
+            ++k;
+        m_prefixFailure[i] = k;
+    }
+
+    reset();
+}
+
+void ProgressPattern::reset()
+{
+    m_state = m_prefix.isEmpty() ? Integer : Prefix;
+    m_matched = 0;
+    m_value = 0;
+    m_digits = 0;
+}
+
+int ProgressPattern::feed(const char *data, qint64 size)
+{
+    int result = -1;
+
+    for (qint64 i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+        const bool digit = c >= '0' && c <= '9';
+
+        // Байт, не подошедший числу или суффиксу, повторно проверяется как начало префикса
+        bool again = true;
+        while (again)
+        {
+            again = false;
+            switch (m_state)
+            {
+            case Prefix:
+                while (m_matched > 0 && c != m_prefix.at(m_matched))
+                    m_matched = m_prefixFailure[m_matched - 1];
+                if (c == m_prefix.at(m_matched))
+                    ++m_matched;
+                if (m_matched == m_prefix.size())
+                {
+                    m_state = Integer;
+                    m_value = 0;
+                    m_digits = 0;
+                }
+                break;
+
+            case Integer:
+                if (digit)
+                {
+                    m_value = qMin(m_value * 10 + (c - '0'), MAX_VALUE);
+                    ++m_digits;
+                    break;
+                }
+                if (m_digits == 0)
+                {
+                    // Без префикса нечисловые байты просто пропускаются
+                    again = !m_prefix.isEmpty();
+                    reset();
+                    break;
+                }
+                if (c == '.' || c == ',')
+                {
+                    m_state = Fraction;
+                    break;
+                }
+                m_state = Suffix;
+                m_matched = 0;
+                again = true;
+                break;
+
+            case Fraction:
+                if (digit)
+                    break;
+                m_state = Suffix;
+                m_matched = 0;
+                again = true;
+                break;
+
+            case Suffix:
+                if (m_matched < m_suffix.size() && c == m_suffix.at(m_matched))
+                {
+                    if (++m_matched == m_suffix.size())
+                    {
+                        result = m_value;
+                        reset();
+                    }
+                    break;
+                }
+                if (m_suffix.isEmpty())
+                    result = m_value;
+                reset();
+                again = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QByteArray>
+#include <vector>
+
+/**
+ * @class ProgressPattern
+ * @brief Потоковый поиск значения прогресса в выводе процесса
+ *
+ * Шаблон задаётся строкой вида "префикс{}суффикс", где {} - целое число
+ * (дробная часть после '.' или ',' пропускается), например "{}%" или
+ * "progress: {}/100". Данные разбираются побайтно непосредственно в
+ * буфере чтения: строки не выделяются, а совпадение может быть разбито
+ * между порциями данных.
+ */
+class ProgressPattern
+{
+public:
+    /// Шаблон по умолчанию
+    static constexpr char DEFAULT_PATTERN[] = "{}%";
+
+    /// Место числа в шаблоне
+    static constexpr char PLACEHOLDER[] = "{}";
+
+    /// Ограничение значения числа (защита от переполнения)
+    static constexpr int MAX_VALUE = 1000000;
+
+    /**
+     * @brief Конструктор
+     * @param pattern Шаблон "префикс{}суффикс"; без {} число ищется в конце шаблона
+     */
+    explicit ProgressPattern(const QByteArray &pattern = DEFAULT_PATTERN);
+
+    /**
+     * @brief Разобрать очередную порцию данных
+     * @param data Данные
+     * @param size Размер данных
+     * @return Значение последнего совпадения в порции или -1, если совпадений нет
+     */
+    int feed(const char *data, qint64 size);
+
+    /**
+     * @brief Сбросить состояние разбора
+     */
+    void reset();
+
+private:
+    /**
+     * @enum State
+     * @brief Состояние разбора
+     */
+    enum State {
+        Prefix,    ///< Сопоставление префикса
+        Integer,   ///< Целая часть числа
+        Fraction,  ///< Дробная часть числа
+        Suffix     ///< Сопоставление суффикса
+    };
+
+    QByteArray m_prefix;             ///< Текст перед числом
+    QByteArray m_suffix;             ///< Текст после числа
+    std::vector<int> m_prefixFailure; ///< Функция отказов префикса (Кнут-Моррис-Пратт)
+    State m_state{Prefix};           ///< Текущее состояние
+    int m_matched{0};                ///< Совпавшие байты префикса или суффикса
+    int m_value{0};                  ///< Накопленное значение числа
+    int m_digits{0};                 ///< Количество цифр целой части
+};
@@ -0,0 +1,66 @@
+#include "rowranges.h"
+#include <algorithm>
+
+RowRanges RowRanges::fromRows(QList<int> rows)
+{
+    std::sort(rows.begin(), rows.end());
+
+    RowRanges ranges;
+    for (int row : std::as_const(rows))
+        ranges.append(row, row);
+    return ranges;
+}
+
+void RowRanges::append(int first, int last)
+{
+    if (first > last)
+        return;
+
+    if (!m_ranges.empty() && first <= m_ranges.back().last + 1 && last >= m_ranges.back().first - 1)
+    {
+        m_ranges.back().first = std::min(m_ranges.back().first, first);
+        m_ranges.back().last = std::max(m_ranges.back().last, last);
+        return;
+    }
+    m_ranges.push_back({first, last});
+}
+
+void RowRanges::normalize()
+{
+    std::sort(m_ranges.begin(), m_ranges.end(), [](const Range &left, const Range &right) {
+        return left.first < right.first;
+    });
+
+    std::vector<Range> ranges;
+    ranges.swap(m_ranges);
+    for (const Range &range : ranges)
+        append(range.first, range.last);
+}
+
+RowRanges RowRanges::clipped(int first, int last) const
+{
+    RowRanges result;
+    for (const Range &range : m_ranges)
+        result.append(std::max(range.first, first), std::min(range.last, last));
+    return result;
+}
+
+QList<int> RowRanges::toRows() const
+{
+    QList<int> rows;
+    rows.reserve(rowCount());
+    for (const Range &range : m_ranges)
+    {
+        for (int row = range.first; row <= range.last; ++row)
+            rows.append(row);
+    }
+    return rows;
+}
+
+int RowRanges::rowCount() const
+{
+    int count = 0;
+    for (const Range &range : m_ranges)
+        count += range.last - range.first + 1;
+    return count;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QList>
+#include <vector>
+
+/**
+ * @class RowRanges
+ * @brief Множество строк модели в виде упорядоченных диапазонов
+ *
+ * Хранит непересекающиеся диапазоны [first, last] по возрастанию.
+ * Выделение всех строк или их непрерывной части занимает один диапазон,
+ * поэтому массовые операции над выделением не разворачивают его в список
+ * отдельных строк.
+ */
+class RowRanges
+{
+public:
+    /**
+     * @struct Range
+     * @brief Диапазон строк
+     */
+    struct Range
+    {
+        int first{0};  ///< Первая строка
+        int last{0};   ///< Последняя строка (включительно)
+    };
+
+    /**
+     * @brief Построить диапазоны по списку строк
+     * @param rows Строки в любом порядке, возможны повторы
+     * @return Диапазоны
+     */
+    static RowRanges fromRows(QList<int> rows);
+
+    /**
+     * @brief Добавить диапазон
+     * @param first Первая строка
+     * @param last Последняя строка (включительно)
+     *
+     * Диапазон, примыкающий к последнему или перекрывающий его, объединяется
+     * с ним. Диапазоны, добавленные не по возрастанию, упорядочивает
+     * normalize().
+     */
+    void append(int first, int last);
+
+    /**
+     * @brief Упорядочить диапазоны и объединить пересекающиеся и смежные
+     */
+    void normalize();
+
+    /**
+     * @brief Получить часть диапазонов внутри [first, last]
+     * @param first Первая строка
+     * @param last Последняя строка (включительно)
+     * @return Диапазоны, обрезанные по границам
+     */
+    RowRanges clipped(int first, int last) const;
+
+    /**
+     * @brief Развернуть диапазоны в список строк
+     * @return Строки по возрастанию
+     */
+    QList<int> toRows() const;
+
+    /**
+     * @brief Проверить, пусто ли множество
+     * @return true если строк нет
+     */
+    bool isEmpty() const { return m_ranges.empty(); }
+
+    /**
+     * @brief Получить количество диапазонов
+     * @return Количество диапазонов
+     */
+    int rangeCount() const { return static_cast<int>(m_ranges.size()); }
+
+    /**
+     * @brief Получить количество строк
+     * @return Сумма длин диапазонов
+     */
+    int rowCount() const;
+
+    /**
+     * @brief Получить диапазон по номеру
+     * @param index Номер диапазона
+     * @return Диапазон
+     */
+    const Range &at(int index) const { return m_ranges[index]; }
+
+    std::vector<Range>::const_iterator begin() const { return m_ranges.cbegin(); }
+    std::vector<Range>::const_iterator end() const { return m_ranges.cend(); }
+
+private:
+    std::vector<Range> m_ranges{};  ///< Диапазоны по возрастанию
+};
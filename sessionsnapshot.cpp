@@ -0,0 +1,98 @@
+#include "sessionsnapshot.h"
+#include "taskmodel.h"
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+bool SessionSnapshot::save(const QString &path, const TaskModel &model,
+                           const QList<Entry> &pending, QString *error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const int liveRows = model.rowCount() - model.coldTasks().count() - model.archivedRowCount();
+    const ColdTaskStore &coldTasks = model.coldTasks();
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out.writeRawData(MAGIC, static_cast<int>(std::strlen(MAGIC)));
+    out << FORMAT_VERSION << static_cast<quint32>(liveRows + coldTasks.count() + pending.count());
+
+    for (int row = 0; row < liveRows; ++row)
+    {
+        const Task *task = model.getTask(row);
+        out << task->getName() << task->getDate() << static_cast<quint8>(task->getProgress());
+    }
+    for (int index = 0; index < coldTasks.count(); ++index)
+    {
+        out << coldTasks.name(index) << coldTasks.date(index)
+            << static_cast<quint8>(Task::MAX_PROGRESS);
+    }
+    for (const Entry &entry : pending)
+        out << entry.name << entry.date << static_cast<quint8>(entry.progress);
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QList<SessionSnapshot::Entry> SessionSnapshot::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.exists())
+        return {};
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = file.errorString();
+        return {};
+    }
+
+    QDataStream in(&file);
+    in.setVersion(STREAM_VERSION);
+
+    char magic[sizeof(MAGIC) - 1];
+    quint32 version = 0;
+    quint32 count = 0;
+    if (in.readRawData(magic, sizeof(magic)) != int(sizeof(magic))
+        || std::memcmp(magic, MAGIC, sizeof(magic)) != 0)
+    {
+        if (error)
+            *error = "Неверная сигнатура снимка";
+        return {};
+    }
+    in >> version >> count;
+    if (version != FORMAT_VERSION)
+    {
+        if (error)
+            *error = QString("Неподдерживаемая версия снимка %1").arg(version);
+        return {};
+    }
+
+    QList<Entry> entries;
+    entries.reserve(static_cast<int>(qMin<quint32>(count, file.size() / 8)));
+    for (quint32 i = 0; i < count; ++i)
+    {
+        Entry entry;
+        quint8 progress = 0;
+        in >> entry.name >> entry.date >> progress;
+        if (in.status() != QDataStream::Ok)
+        {
+            if (error)
+                *error = "Снимок повреждён";
+            return {};
+        }
+        entry.progress = qMin<int>(progress, Task::MAX_PROGRESS);
+        entries.append(entry);
+    }
+    return entries;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+class TaskModel;
+
+/**
+ * @class SessionSnapshot
+ * @brief Сохранение и восстановление списка задач между запусками
+ *
+ * Снимок - файл с сигнатурой, версией и записями QDataStream (название,
+ * дата создания, прогресс) всех задач модели, кроме строк архива.
+ * Запуск восстановленных задач не сохраняется: они восстанавливаются
+ * остановленными.
+ */
+class SessionSnapshot
+{
+public:
+    /// Сигнатура файла снимка
+    static constexpr char MAGIC[] = "DRWSESS1";
+
+    /// Версия формата
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /// Версия QDataStream записей
+    static constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_15;
+
+    /**
+     * @struct Entry
+     * @brief Задача в снимке
+     */
+    struct Entry
+    {
+        QString name;     ///< Название
+        QDateTime date;   ///< Дата создания
+        int progress{0};  ///< Прогресс [0, 100]
+    };
+
+    SessionSnapshot() = delete;
+
+    /**
+     * @brief Сохранить задачи модели
+     * @param path Путь к файлу снимка
+     * @param model Модель задач
+     * @param pending Задачи прежнего снимка, ещё не восстановленные в модель
+     * @param error Описание ошибки (выходной параметр, может быть nullptr)
+     * @return true если снимок записан
+     *
+     * Файл заменяется атомарно через QSaveFile.
+     */
+    static bool save(const QString &path, const TaskModel &model,
+                     const QList<Entry> &pending = {}, QString *error = nullptr);
+
+    /**
+     * @brief Прочитать снимок
+     * @param path Путь к файлу снимка
+     * @param error Описание ошибки (выходной параметр, может быть nullptr)
+     * @return Задачи снимка; пустой список, если файла нет или он повреждён
+     *
+     * Не обращается к модели и может вызываться из рабочего потока.
+     */
+    static QList<Entry> load(const QString &path, QString *error = nullptr);
+};
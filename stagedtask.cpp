@@ -0,0 +1,139 @@
+#include "stagedtask.h"
+#include "monotonicclock.h"
+#include "task.h"
+#include "taskscheduler.h"
+#include <numeric>
+
+std::coroutine_handle<> StagedWork::FinalAwaiter::await_suspend(Handle handle) noexcept
+{
+    // Тело без ожидающей сопрограммы возвращает управление StagedTask::resume()
+    const std::coroutine_handle<> continuation = handle.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+}
+
+StagedWork &StagedWork::operator=(StagedWork &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_handle)
+            m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+}
+
+StagedWork::~StagedWork()
+{
+    if (m_handle)
+        m_handle.destroy();
+}
+
+std::coroutine_handle<> StagedWork::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+    m_handle.promise().continuation = awaiting;
+    return m_handle;
+}
+
+void StagedWork::await_resume() const
+{
+    if (m_handle.promise().exception)
+        std::rethrow_exception(m_handle.promise().exception);
+}
+
+void StageContext::SleepAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    m_context.suspend(handle);
+    m_context.m_scheduler->schedule(m_context.m_task,
+                                    MonotonicClock::nsecs() + qint64(m_msecs) * 1000000,
+                                    m_context.m_task->scheduleGeneration());
+}
+
+StageContext::StageContext(Task *task, TaskScheduler *scheduler, const QList<int> &weights)
+    : m_task(task)
+    , m_scheduler(scheduler)
+    , m_weights(weights)
+    , m_totalWeight(std::accumulate(weights.cbegin(), weights.cend(), 0))
+{
+}
+
+StagedWork StageContext::stage(StagedWork work)
+{
+    ++m_stage;
+    m_stageFraction = 0.0;
+
+    co_await work;
+
+    m_completedWeight += m_weights.value(m_stage);
+    m_stageFraction = 0.0;
+    report();
+}
+
+void StageContext::setStageProgress(double fraction)
+{
+    m_stageFraction = qBound(0.0, fraction, 1.0);
+    report();
+}
+
+int StageContext::progress() const
+{
+    if (m_totalWeight <= 0)
+        return 0;
+
+    const double weight = m_completedWeight + m_weights.value(m_stage) * m_stageFraction;
+    return qBound(0, static_cast<int>(weight * Task::MAX_PROGRESS / m_totalWeight), Task::MAX_PROGRESS);
+}
+
+void StageContext::restart(const std::weak_ptr<StagedTask> &body)
+{
+    m_body = body;
+    m_stage = -1;
+    m_completedWeight = 0;
+    m_stageFraction = 0.0;
+    m_suspended = {};
+}
+
+void StageContext::report()
+{
+    m_task->setBodyProgress(progress());
+}
+
+void StageContext::wakeFromPool(const std::weak_ptr<StagedTask> &body)
+{
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [body]() {
+        if (const std::shared_ptr<StagedTask> task = body.lock())
+            task->m_task->wakeBody();
+    }, Qt::QueuedConnection);
+}
+
+StagedTask::StagedTask(Task *task, TaskScheduler *scheduler, Definition definition)
+    : m_task(task)
+    , m_definition(std::move(definition))
+    , m_context(task, scheduler, m_definition.weights)
+{
+}
+
+void StagedTask::resume()
+{
+    // Первый запуск и запуск после ошибки выполняют тело с начала
+    if (!m_work)
+    {
+        m_context.restart(weak_from_this());
+        m_work.emplace(m_definition.body(m_context));
+        m_context.suspend(m_work->handle());
+    }
+
+    const std::coroutine_handle<> handle = std::exchange(m_context.m_suspended, {});
+    if (!handle)
+        return;
+    handle.resume();
+
+    if (!m_work->done())
+        return;
+
+    // Кадры завершённого тела больше не нужны
+    const std::exception_ptr exception = m_work->exception();
+    m_work.reset();
+    if (exception)
+        qWarning("Тело задачи %llu завершилось с ошибкой", static_cast<unsigned long long>(m_task->getId()));
+    m_task->finishBody(!exception);
+}
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QList>
+#include <QThreadPool>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "taskbody.h"
+
+class StageContext;
+class StagedTask;
+class Task;
+class TaskScheduler;
+
+/**
+ * @class StagedWork
+ * @brief Сопрограмма тела задачи или одного его этапа
+ *
+ * Создаётся приостановленной и выполняется, когда её ожидают через
+ * co_await (этап) или продолжает StagedTask (тело). По завершении
+ * управление передаётся ожидающей сопрограмме без роста стека.
+ * Исключение сопрограммы передаётся ожидающей через co_await.
+ */
+class StagedWork
+{
+public:
+    struct promise_type;
+
+    /// Дескриптор сопрограммы
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /**
+     * @struct FinalAwaiter
+     * @brief Передача управления ожидающей сопрограмме при завершении
+     */
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @struct promise_type
+     * @brief Состояние сопрограммы
+     */
+    struct promise_type
+    {
+        std::coroutine_handle<> continuation;  ///< Ожидающая сопрограмма (пусто для тела)
+        std::exception_ptr exception;          ///< Необработанное исключение
+
+        StagedWork get_return_object() { return StagedWork(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    StagedWork(StagedWork &&other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    StagedWork &operator=(StagedWork &&other) noexcept;
+    StagedWork(const StagedWork &) = delete;
+    StagedWork &operator=(const StagedWork &) = delete;
+
+    /**
+     * @brief Деструктор
+     *
+     * Уничтожает кадр сопрограммы вместе с кадрами ожидаемых этапов.
+     */
+    ~StagedWork();
+
+    /**
+     * @brief Проверить, завершена ли сопрограмма
+     * @return true если сопрограмма выполнена до конца
+     */
+    bool done() const { return m_handle.done(); }
+
+    /**
+     * @brief Получить исключение завершившейся сопрограммы
+     * @return Исключение или пустой указатель
+     */
+    std::exception_ptr exception() const { return m_handle.promise().exception; }
+
+    /**
+     * @brief Получить дескриптор сопрограммы
+     * @return Дескриптор
+     */
+    Handle handle() const { return m_handle; }
+
+    bool await_ready() const noexcept { return m_handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept;
+    void await_resume() const;
+
+private:
+    explicit StagedWork(Handle handle) : m_handle(handle) {}
+
+    Handle m_handle;  ///< Кадр сопрограммы
+};
+
+/**
+ * @class StageContext
+ * @brief Окружение тела задачи: этапы, ожидание и переходы в пул потоков
+ *
+ * Передаётся телу StagedTask по ссылке. Прогресс задачи складывается из
+ * весов этапов: завершённые этапы учитываются полностью, текущий - в доле,
+ * заданной setStageProgress().
+ *
+ * Ожидание sleep() планируется в общем TaskScheduler, поэтому
+ * приостановленное тело не держит ни таймера, ни потока. Функция inPool()
+ * выполняется в QThreadPool, а тело продолжается в потоке GUI.
+ */
+class StageContext
+{
+public:
+    /**
+     * @class SleepAwaiter
+     * @brief Ожидание интервала в общем планировщике
+     */
+    class SleepAwaiter
+    {
+    public:
+        SleepAwaiter(StageContext &context, int msecs) : m_context(context), m_msecs(msecs) {}
+
+        bool await_ready() const noexcept { return m_msecs <= 0; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+
+    private:
+        StageContext &m_context;  ///< Окружение тела
+        int m_msecs;              ///< Интервал ожидания (мс)
+    };
+
+    /**
+     * @class PoolAwaiter
+     * @brief Выполнение функции в QThreadPool с возвратом результата
+     *
+     * Функция и её результат хранятся в общем состоянии, поэтому
+     * уничтожение тела во время работы функции безопасно: результат
+     * отбрасывается.
+     */
+    template<typename Work>
+    class PoolAwaiter
+    {
+        using Result = std::invoke_result_t<Work>;
+        using Value = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+        /**
+         * @struct State
+         * @brief Состояние, разделяемое с потоком пула
+         */
+        struct State
+        {
+            Work work;                    ///< Функция
+            std::optional<Value> value;   ///< Результат
+            std::exception_ptr exception; ///< Исключение функции
+        };
+
+    public:
+        PoolAwaiter(StageContext &context, Work work)
+            : m_context(context)
+            , m_state(std::make_shared<State>(State{std::move(work), std::nullopt, nullptr}))
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_context.suspend(handle);
+            QThreadPool::globalInstance()->start([state = m_state, body = m_context.m_body]() {
+                try
+                {
+                    if constexpr (std::is_void_v<Result>)
+                    {
+                        state->work();
+                        state->value.emplace(true);
+                    }
+                    else
+                    {
+                        state->value.emplace(state->work());
+                    }
+                }
+                catch (...)
+                {
+                    state->exception = std::current_exception();
+                }
+                StageContext::wakeFromPool(body);
+            });
+        }
+
+        Result await_resume()
+        {
+            if (m_state->exception)
+                std::rethrow_exception(m_state->exception);
+            if constexpr (!std::is_void_v<Result>)
+                return std::move(*m_state->value);
+        }
+
+    private:
+        StageContext &m_context;        ///< Окружение тела
+        std::shared_ptr<State> m_state; ///< Состояние, разделяемое с потоком пула
+    };
+
+    /**
+     * @brief Конструктор
+     * @param task Задача
+     * @param scheduler Планировщик ожиданий
+     * @param weights Веса этапов в порядке выполнения
+     */
+    StageContext(Task *task, TaskScheduler *scheduler, const QList<int> &weights);
+
+    /**
+     * @brief Выполнить следующий этап
+     * @param work Сопрограмма этапа
+     * @return Сопрограмма, завершающаяся вместе с этапом
+     *
+     * Этапы нумеруются по порядку вызова; после завершения этапа его вес
+     * полностью учитывается в прогрессе.
+     */
+    StagedWork stage(StagedWork work);
+
+    /**
+     * @brief Приостановить тело на интервал
+     * @param msecs Интервал (мс)
+     * @return Объект ожидания для co_await
+     *
+     * Время остановки задачи засчитывается в интервал: если он истёк, тело
+     * продолжается сразу при следующем запуске.
+     */
+    SleepAwaiter sleep(int msecs) { return SleepAwaiter(*this, msecs); }
+
+    /**
+     * @brief Выполнить функцию в QThreadPool
+     * @param work Функция без аргументов
+     * @return Объект ожидания; co_await возвращает результат функции
+     *
+     * Функция выполняется в другом потоке и не должна обращаться к
+     * переменным сопрограммы и к задаче: данные передаются копиями в
+     * захвате, результат - возвращаемым значением.
+     */
+    template<typename Work>
+    PoolAwaiter<Work> inPool(Work work) { return PoolAwaiter<Work>(*this, std::move(work)); }
+
+    /**
+     * @brief Сообщить долю выполнения текущего этапа
+     * @param fraction Доля [0, 1]
+     */
+    void setStageProgress(double fraction);
+
+    /**
+     * @brief Получить номер текущего этапа
+     * @return Номер этапа или -1 до начала первого этапа
+     */
+    int stage() const { return m_stage; }
+
+    /**
+     * @brief Получить прогресс по весам этапов
+     * @return Прогресс [0, 100]
+     */
+    int progress() const;
+
+private:
+    friend class StagedTask;
+
+    /**
+     * @brief Запомнить приостановленную сопрограмму
+     * @param handle Сопрограмма, которую следует продолжить
+     */
+    void suspend(std::coroutine_handle<> handle) { m_suspended = handle; }
+
+    /**
+     * @brief Начать выполнение тела заново
+     * @param body Тело, которому принадлежит окружение
+     */
+    void restart(const std::weak_ptr<StagedTask> &body);
+
+    /**
+     * @brief Сообщить прогресс задаче
+     */
+    void report();
+
+    /**
+     * @brief Продолжить тело в потоке GUI после работы в пуле
+     * @param body Тело (уже уничтоженное тело не продолжается)
+     */
+    static void wakeFromPool(const std::weak_ptr<StagedTask> &body);
+
+    Task *m_task;                        ///< Задача
+    TaskScheduler *m_scheduler;          ///< Планировщик ожиданий
+    QList<int> m_weights;                ///< Веса этапов
+    int m_totalWeight{0};                ///< Сумма весов этапов
+    int m_stage{-1};                     ///< Текущий этап
+    int m_completedWeight{0};            ///< Вес завершённых этапов
+    double m_stageFraction{0.0};         ///< Доля выполнения текущего этапа
+    std::coroutine_handle<> m_suspended; ///< Сопрограмма, ожидающая продолжения
+    std::weak_ptr<StagedTask> m_body;    ///< Тело, которому принадлежит окружение
+};
+
+/**
+ * @class StagedTask
+ * @brief Тело задачи в виде сопрограммы из взвешенных этапов
+ *
+ * Связывает сопрограмму StagedWork с задачей Task: продолжает её по
+ * Task::wakeBody() и сообщает прогресс и завершение. Приостановленное тело
+ * занимает только кадры сопрограмм. Тело, завершившееся исключением,
+ * останавливает задачу и при следующем запуске выполняется заново.
+ *
+ * Пример тела:
+ * @code
+ * StagedTask::Definition definition{{1, 3}, [](StageContext &context) -> StagedWork {
+ *     co_await context.stage(download(context));
+ *     const int checksum = co_await context.inPool([]() { return compute(); });
+ *     co_await context.stage(upload(context, checksum));
+ * }};
+ * @endcode
+ */
+class StagedTask : public TaskBody, public std::enable_shared_from_this<StagedTask>
+{
+public:
+    /**
+     * @struct Definition
+     * @brief Описание тела задачи
+     */
+    struct Definition
+    {
+        QList<int> weights;                            ///< Веса этапов в порядке выполнения
+        std::function<StagedWork(StageContext&)> body; ///< Фабрика сопрограммы тела
+    };
+
+    /**
+     * @brief Конструктор
+     * @param task Задача, которой назначается тело
+     * @param scheduler Планировщик ожиданий
+     * @param definition Описание тела
+     *
+     * Тело создаётся через std::make_shared и назначается задаче через
+     * Task::setBody().
+     */
+    StagedTask(Task *task, TaskScheduler *scheduler, Definition definition);
+
+    void resume() override;
+
+    /**
+     * @brief Получить окружение тела
+     * @return Этапы и прогресс
+     */
+    const StageContext &context() const { return m_context; }
+
+private:
+    friend class StageContext;
+
+    Task *m_task;                     ///< Задача
+    Definition m_definition;          ///< Описание тела
+    StageContext m_context;           ///< Окружение тела
+    std::optional<StagedWork> m_work; ///< Сопрограмма текущего выполнения тела
+};
@@ -1,15 +1,60 @@
 #include "task.h"
+#include "monotonicclock.h"
+#include "instrumentation.h"
+#include "taskbody.h"
+#include "taskeventlog.h"
+#include "taskprocess.h"
+#include "taskscheduler.h"
 #include <QRandomGenerator>
+#include <limits>
+
+namespace {
+
+/// Следующее значение генератора splitmix64
+quint64 nextRandom(quint64 &state)
+{
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+} // namespace
 
 Task::Task(const QString &name, QObject *parent)
     : QObject(parent)
     , m_name(name)
     , m_date(QDateTime::currentDateTime())
+    , m_dateMs(m_date.toMSecsSinceEpoch())
     , m_progress(0)
     , m_running(false)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &Task::updateProgress);
+}
+
+int Task::getProgress() const
+{
+    if (m_ticksSuspended)
+    {
+        quint64 state = 0;
+        qint64 tickNs = 0;
+        qint64 nextTickNs = 0;
+        return replaySuspendedTicks(MonotonicClock::nsecs(), state, tickNs, nextTickNs);
+    }
+    if (!m_scheduler)
+        return m_progress;
+
+    advanceSchedule(runtimeNs(MonotonicClock::nsecs()));
+    return m_scheduleProgress;
+}
+
+double Task::getRate() const
+{
+    if (!m_scheduler)
+        return m_rate;
+
+    // Средняя скорость за всё время выполнения
+    const qint64 runtime = runtimeNs(MonotonicClock::nsecs());
+    return runtime > 0 ? getProgress() * 1e9 / runtime : 0.0;
 }
 
 void Task::start()
@@ -17,35 +62,486 @@ void Task::start()
     if (!m_running && m_progress < MAX_PROGRESS)
     {
         m_running = true;
-        m_timer->start(getRandomInterval());
+        m_lastTickNs = MonotonicClock::nsecs();
+        m_history.append(m_progress, m_lastTickNs / 1000000);
+        if (m_process)
+        {
+            m_process->start();
+        }
+        else if (m_body)
+        {
+            // Тело продолжается после сообщения о запуске
+        }
+        else if (m_scheduler)
+        {
+            m_runStartNs = m_lastTickNs;
+            m_scheduler->schedule(this, m_runStartNs + m_completionRuntimeNs - m_runtimeNs,
+                                  m_scheduleGeneration);
+        }
+        else
+        {
+            ensureTimer();
+            m_timer->start(getRandomInterval());
+        }
+        TaskEventLog::record(TaskEventLog::Started, m_id, m_progress);
+        emit runningChanged(true);
         emit dataChanged();
+
+        if (m_body)
+            resumeBody();
     }
 }
 
 void Task::stop()
 {
+    // Сначала учитываем прогресс, накопленный за время приостановки тактов
+    if (m_ticksSuspended)
+        resumeTicks();
+
+    if (m_running && m_scheduler)
+    {
+        // Сообщаем вычисленный прогресс; при достижении 100% задача остановится сама
+        syncProgress();
+        if (!m_running)
+            return;
+
+        m_runtimeNs = runtimeNs(MonotonicClock::nsecs());
+        ++m_scheduleGeneration;
+    }
+
     if (m_running)
     {
         m_running = false;
-        m_timer->stop();
+        if (m_timer)
+            m_timer->stop();
+        if (m_process)
+            m_process->terminate();
+        TaskEventLog::record(TaskEventLog::Stopped, m_id, m_progress);
+        emit runningChanged(false);
         emit dataChanged();
     }
 }
 
+void Task::halt()
+{
+    m_running = false;
+    m_ticksSuspended = false;
+    if (m_timer)
+        m_timer->stop();
+    if (m_process)
+        m_process->terminate();
+
+    // События планировщика и продолжения тела задачи становятся устаревшими
+    ++m_scheduleGeneration;
+}
+
+void Task::detach()
+{
+    m_detached = true;
+    ++m_scheduleGeneration;
+}
+
+void Task::reset(const QString &name)
+{
+    if (m_timer)
+        m_timer->stop();
+    m_name = name;
+    m_date = QDateTime::currentDateTime();
+    m_dateMs = m_date.toMSecsSinceEpoch();
+    m_progress = 0;
+    m_running = false;
+    m_rate = 0.0;
+    m_lastTickNs = 0;
+    m_progressStampNs = 0;
+    m_ticksSuspended = false;
+    m_detached = false;
+    m_history.clear();
+
+    // Запланированные события прежней задачи становятся устаревшими
+    ++m_scheduleGeneration;
+    m_scheduler = nullptr;
+    m_runtimeNs = 0;
+
+    delete m_process;
+    m_process = nullptr;
+
+    m_body.reset();
+    m_bodyReady = false;
+    m_bodyActive = false;
+}
+
+void Task::restore(const QDateTime &date, int progress)
+{
+    m_date = date;
+    m_dateMs = date.toMSecsSinceEpoch();
+    m_progress = qBound(0, progress, MAX_PROGRESS);
+    m_scheduleProgress = m_progress;
+}
+
+qint64 Task::getEtaMs() const
+{
+    if (m_scheduler)
+    {
+        // Момент завершения известен точно из расписания
+        if (getProgress() >= MAX_PROGRESS)
+            return 0;
+        if (!m_running)
+            return -1;
+        return (m_completionRuntimeNs - runtimeNs(MonotonicClock::nsecs())) / 1000000;
+    }
+
+    if (m_progress >= MAX_PROGRESS)
+        return 0;
+    if (!m_running || m_rate <= 0.0)
+        return -1;
+    return static_cast<qint64>((MAX_PROGRESS - m_progress) * 1000.0 / m_rate);
+}
+
+qint64 Task::projectedFinishMs() const
+{
+    if (m_scheduler)
+        return m_running ? (m_runStartNs + m_completionRuntimeNs - m_runtimeNs) / 1000000 : -1;
+
+    const qint64 eta = getEtaMs();
+    if (eta < 0)
+        return -1;
+    return m_lastTickNs / 1000000 + eta;
+}
+
+void Task::suspendTicks()
+{
+    // В режиме вычисляемого прогресса, у внешних процессов и тел задач тактов нет
+    if (m_running && !m_ticksSuspended && !m_scheduler && !m_process && !m_body)
+    {
+        m_ticksSuspended = true;
+        m_suspendState = QRandomGenerator::global()->generate64();
+        armSuspendedCompletion();
+    }
+}
+
+void Task::resumeTicks()
+{
+    if (!m_ticksSuspended)
+        return;
+
+    const qint64 now = MonotonicClock::nsecs();
+    quint64 state = 0;
+    qint64 tickNs = 0;
+    qint64 nextTickNs = 0;
+    const int progress = replaySuspendedTicks(now, state, tickNs, nextTickNs);
+    m_ticksSuspended = false;
+
+    if (progress != m_progress)
+        advance(progress, tickNs);
+
+    if (m_running)
+        m_timer->start(static_cast<int>((nextTickNs - now) / 1000000));
+}
+
+void Task::syncSuspendedTicks()
+{
+    if (!m_ticksSuspended)
+        return;
+
+    quint64 state = 0;
+    qint64 tickNs = 0;
+    qint64 nextTickNs = 0;
+    const int progress = replaySuspendedTicks(MonotonicClock::nsecs(), state, tickNs, nextTickNs);
+    if (progress != m_progress)
+    {
+        // Применённые такты больше не воспроизводятся
+        m_suspendState = state;
+        advance(progress, tickNs);
+    }
+
+    // Таймер мог сработать раньше срока - взводим его снова
+    if (m_running && m_ticksSuspended)
+        armSuspendedCompletion();
+}
+
+int Task::replaySuspendedTicks(qint64 now, quint64 &state, qint64 &tickNs, qint64 &nextTickNs) const
+{
+    state = m_suspendState;
+    tickNs = m_lastTickNs;
+    int progress = m_progress;
+
+    quint64 next = state;
+    int interval = 0;
+    int increment = 0;
+    scheduleStep(next, interval, increment);
+    nextTickNs = tickNs + qint64(interval) * 1000000;
+    while (progress < MAX_PROGRESS && nextTickNs <= now)
+    {
+        progress = qMin(progress + increment, MAX_PROGRESS);
+        tickNs = nextTickNs;
+        state = next;
+        scheduleStep(next, interval, increment);
+        nextTickNs = tickNs + qint64(interval) * 1000000;
+    }
+    return progress;
+}
+
+void Task::armSuspendedCompletion()
+{
+    quint64 state = 0;
+    qint64 completionNs = 0;
+    qint64 nextTickNs = 0;
+    replaySuspendedTicks(std::numeric_limits<qint64>::max(), state, completionNs, nextTickNs);
+
+    const qint64 delayMs = (completionNs - MonotonicClock::nsecs()) / 1000000;
+    m_timer->start(static_cast<int>(qBound<qint64>(0, delayMs + 1, std::numeric_limits<int>::max())));
+}
+
 void Task::updateProgress()
 {
+    DRW_SCOPED_TIMER(TickSection);
+    DRW_COUNT(Ticks);
+
+    if (m_detached)
+        return;
+
+    // Во время приостановки таймер срабатывает только к моменту завершения
+    if (m_ticksSuspended)
+    {
+        syncSuspendedTicks();
+        return;
+    }
+
     if (m_progress < MAX_PROGRESS)
     {
-        // Увеличиваем прогресс
-        m_progress = qMin(m_progress + getRandomIncrement(), 100);
+        advance(qMin(m_progress + getRandomIncrement(), MAX_PROGRESS), MonotonicClock::nsecs());
+        if (m_running)
+            m_timer->setInterval(getRandomInterval());
+    }
+}
 
-        emit progressChanged(m_progress);
+void Task::advance(int progress, qint64 now)
+{
+    const int previous = m_progress;
+    m_progress = progress;
 
-        if (m_progress >= 100)
-            stop();
-        else
-            m_timer->setInterval(getRandomInterval());
+    // Обновляем сглаженную скорость по интервалу с прошлого шага
+    const qint64 elapsed = now - m_lastTickNs;
+    if (elapsed > 0)
+    {
+        const double rate = (m_progress - previous) * 1e9 / elapsed;
+        m_rate = (m_rate > 0.0) ? RATE_SMOOTHING * rate + (1.0 - RATE_SMOOTHING) * m_rate
+                                : rate;
+    }
+    m_lastTickNs = now;
+    m_history.append(m_progress, now / 1000000);
+
+    // Задержка до отрисовки отсчитывается от первого неотрисованного изменения
+    if (m_progressStampNs == 0)
+        m_progressStampNs = now;
+
+    TaskEventLog::record(TaskEventLog::Progress, m_id, m_progress);
+    emit progressChanged(m_progress, previous);
+
+    if (m_progress >= MAX_PROGRESS)
+    {
+        TaskEventLog::record(TaskEventLog::Completed, m_id, m_progress);
+        stop();
+    }
+}
+
+void Task::setProgressScheduler(TaskScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+    m_seed = QRandomGenerator::global()->generate64();
+    m_scheduleState = m_seed;
+    m_scheduleRuntimeNs = 0;
+    m_scheduleProgress = m_progress;
+    m_runtimeNs = 0;
+
+    // Длительность выполнения до завершения определяется зерном
+    quint64 state = m_seed;
+    int progress = m_progress;
+    m_completionRuntimeNs = 0;
+    while (progress < MAX_PROGRESS)
+    {
+        int interval = 0;
+        int increment = 0;
+        scheduleStep(state, interval, increment);
+        m_completionRuntimeNs += qint64(interval) * 1000000;
+        progress = qMin(progress + increment, MAX_PROGRESS);
+    }
+}
+
+void Task::syncProgress()
+{
+    if (!m_scheduler)
+        return;
+
+    const qint64 now = MonotonicClock::nsecs();
+    advanceSchedule(runtimeNs(now));
+    if (m_scheduleProgress != m_progress)
+        advance(m_scheduleProgress, now);
+}
+
+void Task::fireScheduledEvent(quint64 generation)
+{
+    if (generation != m_scheduleGeneration)
+        return;
+
+    // Тело планирует в общем планировщике своё продолжение
+    if (m_body)
+    {
+        wakeBody();
+        return;
+    }
+
+    if (!m_running || !m_scheduler)
+        return;
+
+    syncProgress();
+
+    // Таймер планировщика мог сработать чуть раньше срока
+    if (m_running)
+    {
+        m_scheduler->schedule(this, m_runStartNs + m_completionRuntimeNs - m_runtimeNs,
+                              m_scheduleGeneration);
+    }
+}
+
+void Task::scheduleStep(quint64 &state, int &intervalMs, int &increment)
+{
+    const quint64 value = nextRandom(state);
+    intervalMs = MIN_TIMER_INTERVAL
+        + static_cast<int>((value & 0xFFFFFFFFULL) % (MAX_TIMER_INTERVAL - MIN_TIMER_INTERVAL));
+    increment = MIN_PROGRESS_INCREMENT
+        + static_cast<int>((value >> 32) % (MAX_PROGRESS_INCREMENT - MIN_PROGRESS_INCREMENT));
+}
+
+qint64 Task::runtimeNs(qint64 now) const
+{
+    return m_runtimeNs + (m_running ? now - m_runStartNs : 0);
+}
+
+void Task::advanceSchedule(qint64 runtime) const
+{
+    while (m_scheduleProgress < MAX_PROGRESS)
+    {
+        quint64 state = m_scheduleState;
+        int interval = 0;
+        int increment = 0;
+        scheduleStep(state, interval, increment);
+
+        const qint64 stepNs = m_scheduleRuntimeNs + qint64(interval) * 1000000;
+        if (stepNs > runtime)
+            break;
+
+        m_scheduleState = state;
+        m_scheduleRuntimeNs = stepNs;
+        m_scheduleProgress = qMin(m_scheduleProgress + increment, MAX_PROGRESS);
+    }
+}
+
+void Task::setCommand(const QString &command, const QByteArray &pattern)
+{
+    delete m_process;
+    m_process = new TaskProcess(command, pattern, this);
+    connect(m_process, &TaskProcess::progressParsed, this, &Task::onProcessProgress);
+    connect(m_process, &TaskProcess::finished, this, &Task::onProcessFinished);
+
+    // Прогресс процесса известен только из его вывода
+    ++m_scheduleGeneration;
+    m_scheduler = nullptr;
+}
+
+QByteArray Task::processOutput() const
+{
+    return m_process ? m_process->outputTail() : QByteArray();
+}
+
+void Task::onProcessProgress(int progress)
+{
+    DRW_SCOPED_TIMER(TickSection);
+
+    // Завершение определяется кодом возврата, а не выводом
+    progress = qMin(progress, MAX_PROGRESS - 1);
+    if (m_running && !m_detached && progress > m_progress)
+        advance(progress, MonotonicClock::nsecs());
+}
+
+void Task::onProcessFinished(bool success)
+{
+    if (!m_running || m_detached)
+        return;
+
+    if (success)
+        advance(MAX_PROGRESS, MonotonicClock::nsecs());
+    else
+        stop();
+}
+
+void Task::setBody(std::shared_ptr<TaskBody> body)
+{
+    m_body = std::move(body);
+    m_bodyReady = m_body != nullptr;
+
+    // Прогресс тела сообщает само тело
+    ++m_scheduleGeneration;
+    m_scheduler = nullptr;
+}
+
+void Task::wakeBody()
+{
+    if (!m_body)
+        return;
+
+    m_bodyReady = true;
+    resumeBody();
+}
+
+void Task::setBodyProgress(int progress)
+{
+    DRW_SCOPED_TIMER(TickSection);
+
+    progress = qMin(progress, MAX_PROGRESS - 1);
+    if (m_running && !m_detached && progress > m_progress)
+        advance(progress, MonotonicClock::nsecs());
+}
+
+void Task::finishBody(bool success)
+{
+    if (!m_body)
+        return;
+
+    if (!success)
+    {
+        m_bodyReady = true;
+        stop();
     }
+    else if (m_progress < MAX_PROGRESS)
+    {
+        advance(MAX_PROGRESS, MonotonicClock::nsecs());
+    }
+}
+
+void Task::resumeBody()
+{
+    if (!m_running || m_detached || !m_bodyReady || m_bodyActive)
+        return;
+
+    m_bodyReady = false;
+    m_bodyActive = true;
+
+    // Тело может быть снято с задачи во время выполнения (reset())
+    const std::shared_ptr<TaskBody> body = m_body;
+    body->resume();
+
+    if (m_body == body)
+        m_bodyActive = false;
+}
+
+void Task::ensureTimer()
+{
+    if (m_timer)
+        return;
+
+    m_timer = new QTimer(this);
+    connect(m_timer, &QTimer::timeout, this, &Task::updateProgress);
 }
 
 int Task::getRandomInterval() const
@@ -4,6 +4,12 @@
 #include <QDateTime>
 #include <QTimer>
 #include <QObject>
+#include <memory>
+#include "progresshistory.h"
+
+class TaskBody;
+class TaskProcess;
+class TaskScheduler;
 
 /**
  * @class Task
@@ -13,6 +19,20 @@
  * которые выполняются асинхронно с автоматическим обновлением прогресса.
  * Каждая задача имеет название, дату создания и прогресс выполнения от 0 до 100%.
  *
+ * Прогресс ведётся в одном из двух режимов. По умолчанию задача изменяет
+ * прогресс по собственному таймеру. В режиме вычисляемого прогресса
+ * (setProgressScheduler()) задача хранит накопленное время выполнения и
+ * зерно детерминированного расписания приращений, а прогресс вычисляется
+ * при запросе; единственное событие задачи - её завершение, запланированное
+ * в общем TaskScheduler.
+ *
+ * Задача с командой (setCommand()) выполняет внешний процесс TaskProcess:
+ * прогресс берётся из его вывода, остановка завершает процесс, а успешное
+ * завершение процесса завершает задачу.
+ *
+ * Задача с телом (setBody()) продвигается внешним телом TaskBody, например
+ * сопрограммой StagedTask: тело само планирует своё продолжение, а задача
+ * продолжает его только во время выполнения.
  */
 class Task : public QObject {
     Q_OBJECT
@@ -29,6 +49,9 @@ class Task : public QObject {
     /// Максимальное увеличение прогресса за один шаг
     static constexpr int MAX_PROGRESS_INCREMENT = 4;
 
+    /// Коэффициент сглаживания EWMA скорости выполнения (вес нового замера)
+    static constexpr double RATE_SMOOTHING = 0.3;
+
 public:
     /// Максимальное значение прогресса
     static constexpr int MAX_PROGRESS = 100;
@@ -40,11 +63,38 @@ public:
      */
     explicit Task(const QString &name, QObject *parent = nullptr);
 
+    /**
+     * @brief Получить идентификатор задачи
+     * @return Уникальный в пределах модели идентификатор (0 - не назначен)
+     */
+    quint64 getId() const { return m_id; }
+
+    /**
+     * @brief Назначить идентификатор задачи
+     * @param id Идентификатор, выданный моделью
+     */
+    void setId(quint64 id) { m_id = id; }
+
+    /**
+     * @brief Получить строку задачи в модели
+     * @return Индекс строки или -1, если задача не принадлежит модели
+     *
+     * Поддерживается моделью TaskModel, чтобы определять строку задачи
+     * без поиска по списку.
+     */
+    int modelRow() const { return m_modelRow; }
+
+    /**
+     * @brief Установить строку задачи в модели
+     * @param row Индекс строки или -1
+     */
+    void setModelRow(int row) { m_modelRow = row; }
+
     /**
      * @brief Получить название задачи
      * @return Константная ссылка на название
      */
-    QString getName() const { return m_name; }
+    const QString &getName() const { return m_name; }
 
     /**
      * @brief Получить дату создания задачи
@@ -52,11 +102,28 @@ public:
      */
     QDateTime getDate() const { return m_date; }
 
+    /**
+     * @brief Получить дату создания задачи в миллисекундах
+     * @return Дата создания (мс от эпохи), вычисленная при её установке
+     */
+    qint64 getDateMs() const { return m_dateMs; }
+
     /**
      * @brief Получить текущий прогресс выполнения
      * @return Прогресс в диапазоне [0, 100]
+     *
+     * В режиме вычисляемого прогресса значение вычисляется по времени
+     * выполнения и может опережать reportedProgress().
      */
-    int getProgress() const { return m_progress; }
+    int getProgress() const;
+
+    /**
+     * @brief Получить прогресс, о котором сообщено сигналом progressChanged()
+     * @return Прогресс в диапазоне [0, 100]
+     *
+     * По этому значению модель ведёт статистику задач.
+     */
+    int reportedProgress() const { return m_progress; }
 
     /**
      * @brief Проверить, выполняется ли задача в данный момент
@@ -64,6 +131,44 @@ public:
      */
     bool isRunning() const { return m_running; }
 
+    /**
+     * @brief Получить сглаженную скорость выполнения
+     * @return Скорость в процентах в секунду (EWMA) или 0, если замеров ещё нет
+     */
+    double getRate() const;
+
+    /**
+     * @brief Получить оценку оставшегося времени выполнения
+     * @return Миллисекунды до завершения, 0 для завершённой задачи
+     *         или -1, если задача не выполняется либо скорость неизвестна
+     */
+    qint64 getEtaMs() const;
+
+    /**
+     * @brief Получить прогнозируемый момент завершения
+     * @return Время завершения по MonotonicClock (мс) или -1, если оценки нет
+     */
+    qint64 projectedFinishMs() const;
+
+    /**
+     * @brief Получить историю прогресса
+     * @return Кольцо последних замеров прогресса
+     */
+    const ProgressHistory &history() const { return m_history; }
+
+    /**
+     * @brief Получить момент первого ещё не отрисованного изменения прогресса
+     * @return Время изменения по MonotonicClock (нс) или 0, если все изменения отрисованы
+     */
+    qint64 progressStamp() const { return m_progressStampNs; }
+
+    /**
+     * @brief Отметить, что текущий прогресс отрисован
+     *
+     * Вызывается делегатом после записи задержки от изменения до отрисовки.
+     */
+    void markProgressPainted() { m_progressStampNs = 0; }
+
     /**
      * @brief Запустить выполнение задачи
      *
@@ -81,12 +186,188 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Прекратить работу задачи, скрытой из модели
+     *
+     * Останавливает таймер, завершает внешний процесс и делает устаревшими
+     * события планировщика без отправки сигналов и записей журнала событий.
+     * Вызывается при удалении задачи до её освобождения в пул.
+     */
+    void halt();
+
+    /**
+     * @brief Отсоединить задачу от модели за O(1)
+     *
+     * Делает устаревшими события планировщика, а такты и вывод процесса
+     * после вызова игнорируются. Таймер и процесс при этом не трогаются -
+     * их останавливает halt(), когда задача проходит очередь удаления.
+     */
+    void detach();
+
+    /**
+     * @brief Сбросить задачу в исходное состояние для повторного использования
+     * @param name Новое название задачи
+     *
+     * Останавливает таймер без отправки сигналов, обнуляет прогресс и
+     * обновляет дату создания. Используется пулом задач TaskPool.
+     */
+    void reset(const QString &name);
+
+    /**
+     * @brief Восстановить дату создания и прогресс остановленной задачи
+     * @param date Дата создания
+     * @param progress Прогресс [0, 100]
+     *
+     * Вызывается без отправки сигналов до добавления задачи в модель и до
+     * назначения планировщика вычисляемого прогресса.
+     */
+    void restore(const QDateTime &date, int progress);
+
+    /**
+     * @brief Приостановить такты выполняющейся задачи
+     *
+     * Заменяет такты детерминированным расписанием: getProgress()
+     * вычисляет по нему прогресс на момент запроса, а таймер взводится один
+     * раз на момент достижения 100%, чтобы задача завершилась вовремя.
+     */
+    void suspendTicks();
+
+    /**
+     * @brief Возобновить такты после suspendTicks()
+     *
+     * Применяет такты, прошедшие за время приостановки, одним изменением
+     * прогресса и продолжает обычные такты.
+     */
+    void resumeTicks();
+
+    /**
+     * @brief Применить такты, прошедшие за время приостановки
+     *
+     * Сообщает вычисленный прогресс, не возобновляя такты. Нужен тем, кто
+     * читает агрегированную статистику модели, пока такты приостановлены.
+     */
+    void syncSuspendedTicks();
+
+    /**
+     * @brief Проверить, приостановлены ли такты
+     * @return true если такты приостановлены через suspendTicks()
+     */
+    bool ticksSuspended() const { return m_ticksSuspended; }
+
+    /**
+     * @brief Включить режим вычисляемого прогресса
+     * @param scheduler Планировщик события завершения (nullptr - режим таймера)
+     *
+     * Задаёт новое зерно расписания приращений. Вызывается для новой
+     * задачи до её запуска.
+     */
+    void setProgressScheduler(TaskScheduler *scheduler);
+
+    /**
+     * @brief Проверить, вычисляется ли прогресс по времени
+     * @return true в режиме вычисляемого прогресса
+     */
+    bool isProgressComputed() const { return m_scheduler != nullptr; }
+
+    /**
+     * @brief Сообщить о вычисленном прогрессе
+     *
+     * В режиме вычисляемого прогресса отправляет progressChanged(), если
+     * вычисленное значение отличается от reportedProgress(). В режиме
+     * таймера ничего не делает.
+     */
+    void syncProgress();
+
+    /**
+     * @brief Обработать событие планировщика
+     * @param generation Поколение расписания, с которым событие запланировано
+     *
+     * Устаревшие события (задача остановлена, перезапущена или возвращена
+     * в пул) игнорируются.
+     */
+    void fireScheduledEvent(quint64 generation);
+
+    /**
+     * @brief Получить текущее поколение расписания
+     * @return Поколение, с которым планируются новые события задачи
+     */
+    quint64 scheduleGeneration() const { return m_scheduleGeneration; }
+
+    /**
+     * @brief Назначить задаче внешний процесс
+     * @param command Командная строка
+     * @param pattern Шаблон прогресса в выводе процесса (см. ProgressPattern)
+     *
+     * Вызывается для новой задачи до её запуска; отключает режим
+     * вычисляемого прогресса.
+     */
+    void setCommand(const QString &command, const QByteArray &pattern);
+
+    /**
+     * @brief Проверить, выполняет ли задача внешний процесс
+     * @return true если задаче назначена команда
+     */
+    bool isProcess() const { return m_process != nullptr; }
+
+    /**
+     * @brief Получить последние байты вывода процесса
+     * @return Хвост вывода или пустой массив для задачи без процесса
+     */
+    QByteArray processOutput() const;
+
+    /**
+     * @brief Назначить задаче тело
+     * @param body Тело задачи
+     *
+     * Вызывается для новой задачи до её запуска; отключает режим
+     * вычисляемого прогресса. Тело впервые продолжается при запуске задачи.
+     */
+    void setBody(std::shared_ptr<TaskBody> body);
+
+    /**
+     * @brief Проверить, выполняет ли задача тело
+     * @return true если задаче назначено тело
+     */
+    bool hasBody() const { return m_body != nullptr; }
+
+    /**
+     * @brief Сообщить, что тело готово продолжить выполнение
+     *
+     * Выполняющаяся задача продолжает тело сразу, остановленная - при
+     * следующем запуске.
+     */
+    void wakeBody();
+
+    /**
+     * @brief Применить прогресс тела
+     * @param progress Прогресс [0, 100]
+     *
+     * Прогресс не уменьшается и до finishBody() не достигает 100%.
+     */
+    void setBodyProgress(int progress);
+
+    /**
+     * @brief Обработать завершение тела
+     * @param success true если тело выполнено полностью
+     *
+     * Успешное завершение завершает задачу, неуспешное - останавливает её;
+     * при следующем запуске тело выполняется заново.
+     */
+    void finishBody(bool success);
+
 signals:
     /**
      * @brief Сигнал об изменении прогресса
      * @param progress Новое значение прогресса [0, 100]
+     * @param previous Предыдущее значение прогресса [0, 100]
      */
-    void progressChanged(int progress);
+    void progressChanged(int progress, int previous);
+
+    /**
+     * @brief Сигнал о запуске или остановке задачи
+     * @param running Новый статус выполнения
+     */
+    void runningChanged(bool running);
 
     /**
      * @brief Сигнал об изменении любых данных задачи
@@ -104,6 +385,21 @@ private slots:
      */
     void updateProgress();
 
+    /**
+     * @brief Применить прогресс из вывода процесса
+     * @param progress Найденное значение
+     *
+     * Прогресс задачи не уменьшается: после перезапуска процесса значение
+     * обновляется, когда процесс превысит достигнутый ранее прогресс.
+     */
+    void onProcessProgress(int progress);
+
+    /**
+     * @brief Обработать завершение процесса
+     * @param success true при успешном завершении
+     */
+    void onProcessFinished(bool success);
+
 private:
     /**
      * @brief Получить рандомный интервал для таймера
@@ -117,10 +413,95 @@ private:
      */
     int getRandomIncrement() const;
 
+    /**
+     * @brief Применить новое значение прогресса
+     * @param progress Новый прогресс
+     * @param now Момент изменения (MonotonicClock, нс)
+     *
+     * Обновляет скорость и историю, отправляет progressChanged() и
+     * останавливает задачу при достижении 100%.
+     */
+    void advance(int progress, qint64 now);
+
+    /**
+     * @brief Получить очередной шаг детерминированного расписания
+     * @param state Состояние генератора (изменяется)
+     * @param intervalMs Интервал до шага (мс, выходной параметр)
+     * @param increment Приращение прогресса (выходной параметр)
+     *
+     * Распределения совпадают с getRandomInterval() и getRandomIncrement().
+     */
+    static void scheduleStep(quint64 &state, int &intervalMs, int &increment);
+
+    /**
+     * @brief Получить накопленное время выполнения
+     * @param now Текущий момент (MonotonicClock, нс)
+     * @return Время выполнения с учётом текущего запуска (нс)
+     */
+    qint64 runtimeNs(qint64 now) const;
+
+    /**
+     * @brief Применить шаги расписания, наступившие к моменту выполнения
+     * @param runtime Время выполнения (нс)
+     */
+    void advanceSchedule(qint64 runtime) const;
+
+    /**
+     * @brief Воспроизвести такты приостановки до заданного момента
+     * @param now Момент (MonotonicClock, нс)
+     * @param state Состояние генератора после применённых тактов (выходной параметр)
+     * @param tickNs Момент последнего применённого такта (выходной параметр)
+     * @param nextTickNs Момент следующего такта (выходной параметр)
+     * @return Прогресс на момент now
+     */
+    int replaySuspendedTicks(qint64 now, quint64 &state, qint64 &tickNs, qint64 &nextTickNs) const;
+
+    /**
+     * @brief Взвести таймер приостановленной задачи на момент достижения 100%
+     */
+    void armSuspendedCompletion();
+
+    /**
+     * @brief Создать таймер тактов при первом запуске в режиме таймера
+     */
+    void ensureTimer();
+
+    /**
+     * @brief Продолжить тело, если задача выполняется и тело готово
+     */
+    void resumeBody();
+
+    quint64 m_id{0};            ///< Идентификатор задачи в модели
+    int m_modelRow{-1};         ///< Строка задачи в модели
     QString m_name;             ///< Название задачи
     QDateTime m_date;           ///< Дата и время создания
+    qint64 m_dateMs{0};         ///< Дата создания (мс от эпохи) для сравнения без QDateTime
     int m_progress;             ///< Текущий прогресс [0, 100]
     bool m_running;             ///< Флаг выполнения
-    QTimer *m_timer{nullptr};   ///< Таймер для обновления прогресса
+    double m_rate{0.0};         ///< Сглаженная скорость выполнения (%/с)
+    qint64 m_lastTickNs{0};     ///< Время последнего обновления прогресса (MonotonicClock, нс)
+    qint64 m_progressStampNs{0}; ///< Время первого неотрисованного изменения прогресса (нс, 0 - нет)
+    bool m_ticksSuspended{false}; ///< Такты приостановлены через suspendTicks()
+    bool m_detached{false};       ///< Задача удалена из модели и ожидает halt() и освобождения
+    quint64 m_suspendState{0};  ///< Состояние генератора тактов приостановки
+    ProgressHistory m_history;  ///< История последних замеров прогресса
+    QTimer *m_timer{nullptr};   ///< Таймер для обновления прогресса (создаётся при первом запуске)
+
+    // Режим вычисляемого прогресса
+    TaskScheduler *m_scheduler{nullptr};   ///< Планировщик завершения (nullptr - режим таймера)
+    quint64 m_seed{0};                     ///< Зерно расписания приращений
+    quint64 m_scheduleGeneration{0};       ///< Поколение расписания для отмены событий
+    qint64 m_runtimeNs{0};                 ///< Время выполнения до текущего запуска (нс)
+    qint64 m_runStartNs{0};                ///< Момент текущего запуска (MonotonicClock, нс)
+    qint64 m_completionRuntimeNs{0};       ///< Время выполнения до 100% по расписанию (нс)
+    mutable quint64 m_scheduleState{0};    ///< Состояние генератора после применённых шагов
+    mutable qint64 m_scheduleRuntimeNs{0}; ///< Время выполнения последнего применённого шага (нс)
+    mutable int m_scheduleProgress{0};     ///< Прогресс после применённых шагов
+
+    TaskProcess *m_process{nullptr};       ///< Внешний процесс (nullptr - прогресс имитируется)
+
+    std::shared_ptr<TaskBody> m_body;      ///< Тело задачи (nullptr - прогресс имитируется)
+    bool m_bodyReady{false};               ///< Тело ожидает продолжения
+    bool m_bodyActive{false};              ///< Тело выполняется (защита от повторного входа)
 };
 
@@ -0,0 +1,186 @@
+#include "taskarchive.h"
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/// Сигнатура файла архива
+constexpr char ARCHIVE_MAGIC[8] = {'D', 'R', 'W', 'T', 'A', 'R', 'C', '1'};
+
+/// Смещение поля количества записей в заголовке
+constexpr int COUNT_OFFSET = 16;
+
+/// Смещение названия в записи
+constexpr int NAME_OFFSET = 18;
+
+/**
+ * @brief Усечь UTF-8 строку, не разрывая многобайтовый символ
+ * @param utf8 Строка
+ * @param limit Максимальная длина (байт)
+ * @return Усечённая строка
+ */
+QByteArray truncateUtf8(const QByteArray &utf8, int limit)
+{
+    if (utf8.size() <= limit)
+        return utf8;
+
+    int size = limit;
+    // Байты продолжения имеют вид 10xxxxxx
+    while (size > 0 && (static_cast<quint8>(utf8.at(size)) & 0xC0) == 0x80)
+        --size;
+    return utf8.left(size);
+}
+
+} // namespace
+
+TaskArchive::TaskArchive()
+{
+    setMemoryLimit(DEFAULT_MEMORY_LIMIT);
+}
+
+bool TaskArchive::open(const QString &path)
+{
+    m_pages.clear();
+    m_count = 0;
+    m_file.close();
+    m_file.setFileName(path);
+
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    const QByteArray header = m_file.read(HEADER_SIZE);
+    if (header.size() != HEADER_SIZE
+        || std::memcmp(header.constData(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0
+        || qFromLittleEndian<quint32>(header.constData() + 8) != FORMAT_VERSION
+        || qFromLittleEndian<quint32>(header.constData() + 12) != RECORD_SIZE)
+    {
+        m_errorString = "Файл не является архивом задач";
+        m_file.close();
+        return false;
+    }
+
+    // Количество ограничиваем размером файла на случай недописанного архива
+    const qint64 declared = static_cast<qint64>(qFromLittleEndian<quint64>(header.constData() + COUNT_OFFSET));
+    m_count = qMin(declared, (m_file.size() - HEADER_SIZE) / RECORD_SIZE);
+    return true;
+}
+
+const TaskArchive::Record *TaskArchive::record(qint64 index) const
+{
+    if (index < 0 || index >= m_count)
+        return nullptr;
+
+    const qint64 page = index / PAGE_SIZE;
+    Page *records = m_pages.object(page);
+    if (!records)
+        records = loadPage(page);
+    if (!records)
+        return nullptr;
+
+    const qint64 offset = index % PAGE_SIZE;
+    return offset < records->count() ? &records->at(offset) : nullptr;
+}
+
+void TaskArchive::setMemoryLimit(qint64 bytes)
+{
+    m_pages.setMaxCost(static_cast<int>(qBound<qint64>(1, bytes, std::numeric_limits<int>::max())));
+}
+
+TaskArchive::Page *TaskArchive::loadPage(qint64 page) const
+{
+    const qint64 first = page * PAGE_SIZE;
+    const int size = static_cast<int>(qMin<qint64>(PAGE_SIZE, m_count - first));
+    if (size <= 0 || !m_file.seek(HEADER_SIZE + first * RECORD_SIZE))
+        return nullptr;
+
+    const QByteArray bytes = m_file.read(qint64(size) * RECORD_SIZE);
+    if (bytes.size() != size * RECORD_SIZE)
+        return nullptr;
+
+    auto *records = new Page();
+    records->reserve(size);
+    int cost = size * static_cast<int>(sizeof(Record));
+    for (int i = 0; i < size; ++i)
+    {
+        const char *data = bytes.constData() + i * RECORD_SIZE;
+        const int nameLength = qMin<int>(static_cast<quint8>(data[17]), MAX_NAME_BYTES);
+
+        Record record;
+        record.id = qFromLittleEndian<quint64>(data);
+        record.date = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(data + 8));
+        record.progress = qMin<int>(static_cast<quint8>(data[16]), 100);
+        record.name = QString::fromUtf8(data + NAME_OFFSET, nameLength);
+        cost += record.name.size() * static_cast<int>(sizeof(QChar));
+        records->append(record);
+    }
+
+    ++m_pageLoads;
+    m_pages.insert(page, records, cost);
+    return m_pages.object(page);
+}
+
+bool TaskArchive::append(const QString &path, const QList<Record> &records, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    quint64 count = 0;
+    if (file.size() == 0)
+    {
+        QByteArray header(HEADER_SIZE, '\0');
+        std::memcpy(header.data(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        qToLittleEndian<quint32>(FORMAT_VERSION, header.data() + 8);
+        qToLittleEndian<quint32>(RECORD_SIZE, header.data() + 12);
+        file.write(header);
+    }
+    else
+    {
+        const QByteArray header = file.read(HEADER_SIZE);
+        if (header.size() != HEADER_SIZE
+            || std::memcmp(header.constData(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0)
+        {
+            if (error)
+                *error = "Файл не является архивом задач";
+            return false;
+        }
+        count = qFromLittleEndian<quint64>(header.constData() + COUNT_OFFSET);
+    }
+
+    // Записи пишутся после последней учтённой, затем обновляется счётчик в заголовке
+    QByteArray bytes(records.count() * RECORD_SIZE, '\0');
+    for (int i = 0; i < records.count(); ++i)
+    {
+        const Record &record = records.at(i);
+        char *data = bytes.data() + i * RECORD_SIZE;
+        const QByteArray name = truncateUtf8(record.name.toUtf8(), MAX_NAME_BYTES);
+
+        qToLittleEndian<quint64>(record.id, data);
+        qToLittleEndian<qint64>(record.date.toMSecsSinceEpoch(), data + 8);
+        data[16] = static_cast<char>(qBound(0, record.progress, 100));
+        data[17] = static_cast<char>(name.size());
+        std::memcpy(data + NAME_OFFSET, name.constData(), name.size());
+    }
+
+    char countField[sizeof(quint64)];
+    qToLittleEndian<quint64>(count + records.count(), countField);
+
+    if (!file.seek(HEADER_SIZE + qint64(count) * RECORD_SIZE)
+        || file.write(bytes) != bytes.size()
+        || !file.seek(COUNT_OFFSET)
+        || file.write(countField, sizeof(countField)) != qint64(sizeof(countField)))
+    {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <QCache>
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/**
+ * @class TaskArchive
+ * @brief Страничное хранилище завершённых задач в файле
+ *
+ * Архив - файл с заголовком и записями фиксированного размера, поэтому
+ * запись с любым номером читается без индекса. Записи загружаются
+ * страницами по PAGE_SIZE и хранятся в LRU-кэше, ограниченном по памяти;
+ * давно не использованные страницы вытесняются.
+ *
+ * Формат (little-endian):
+ * - заголовок HEADER_SIZE байт: сигнатура "DRWTARC1", версия (u32),
+ *   размер записи (u32), количество записей (u64), резерв (u64);
+ * - запись RECORD_SIZE байт: идентификатор (u64), дата создания в мс
+ *   от эпохи UTC (i64), прогресс (u8), длина названия (u8), название
+ *   в UTF-8 (MAX_NAME_BYTES байт, усекается).
+ */
+class TaskArchive
+{
+public:
+    /// Размер заголовка файла
+    static constexpr int HEADER_SIZE = 32;
+
+    /// Размер одной записи
+    static constexpr int RECORD_SIZE = 64;
+
+    /// Максимальная длина названия в записи (байт UTF-8)
+    static constexpr int MAX_NAME_BYTES = 46;
+
+    /// Количество записей на странице
+    static constexpr int PAGE_SIZE = 1024;
+
+    /// Версия формата
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /// Ограничение памяти кэша страниц по умолчанию (байт)
+    static constexpr qint64 DEFAULT_MEMORY_LIMIT = 64 * 1024 * 1024;
+
+    /**
+     * @struct Record
+     * @brief Запись архива
+     */
+    struct Record
+    {
+        quint64 id{0};      ///< Идентификатор задачи
+        QString name;       ///< Название
+        QDateTime date;     ///< Дата создания
+        int progress{0};    ///< Прогресс на момент архивации [0, 100]
+    };
+
+    TaskArchive();
+
+    TaskArchive(const TaskArchive &) = delete;
+    TaskArchive &operator=(const TaskArchive &) = delete;
+
+    /**
+     * @brief Открыть архив для чтения
+     * @param path Путь к файлу архива
+     * @return true если заголовок корректен
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Получить описание последней ошибки
+     * @return Текст ошибки
+     */
+    QString errorString() const { return m_errorString; }
+
+    /**
+     * @brief Получить количество записей
+     * @return Количество записей открытого архива
+     */
+    qint64 count() const { return m_count; }
+
+    /**
+     * @brief Получить запись
+     * @param index Номер записи [0, count())
+     * @return Указатель на запись, действительный до следующего обращения
+     *         к архиву, или nullptr при ошибке чтения
+     *
+     * При отсутствии страницы в кэше она читается из файла.
+     */
+    const Record *record(qint64 index) const;
+
+    /**
+     * @brief Задать ограничение памяти кэша страниц
+     * @param bytes Максимальный объём декодированных страниц (байт)
+     */
+    void setMemoryLimit(qint64 bytes);
+
+    /**
+     * @brief Получить количество страниц, прочитанных из файла
+     * @return Счётчик загрузок (включая повторные после вытеснения)
+     */
+    qint64 pageLoads() const { return m_pageLoads; }
+
+    /**
+     * @brief Получить количество страниц в кэше
+     * @return Количество резидентных страниц
+     */
+    int residentPages() const { return m_pages.count(); }
+
+    /**
+     * @brief Дописать записи в архив
+     * @param path Путь к файлу (создаётся при отсутствии)
+     * @param records Записи
+     * @param error Описание ошибки (выходной параметр, может быть nullptr)
+     * @return true если записи сохранены
+     */
+    static bool append(const QString &path, const QList<Record> &records, QString *error = nullptr);
+
+private:
+    /// Страница декодированных записей
+    using Page = QList<Record>;
+
+    /**
+     * @brief Прочитать и декодировать страницу
+     * @param page Номер страницы
+     * @return Страница или nullptr при ошибке чтения
+     */
+    Page *loadPage(qint64 page) const;
+
+    mutable QFile m_file;                    ///< Файл архива
+    qint64 m_count{0};                       ///< Количество записей
+    mutable QCache<qint64, Page> m_pages{};  ///< LRU-кэш страниц (стоимость - байты)
+    mutable qint64 m_pageLoads{0};           ///< Счётчик чтений страниц
+    QString m_errorString;                   ///< Описание последней ошибки
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @class TaskBody
+ * @brief Тело задачи, выполняемое вне таймера тактов
+ *
+ * Интерфейс, через который задача Task продолжает выполнение внешнего
+ * тела (см. StagedTask). Тело само планирует своё продолжение и сообщает
+ * о готовности через Task::wakeBody(); задача вызывает resume() только
+ * во время выполнения, поэтому остановленная задача не продвигает тело.
+ *
+ * Задача владеет телом через std::shared_ptr, чтобы асинхронные операции
+ * тела могли проверить его существование через std::weak_ptr.
+ */
+class TaskBody
+{
+public:
+    virtual ~TaskBody() = default;
+
+    /**
+     * @brief Продолжить выполнение до следующей приостановки или завершения
+     *
+     * Вызывается в потоке GUI. О прогрессе и завершении тело сообщает
+     * через Task::setBodyProgress() и Task::finishBody().
+     */
+    virtual void resume() = 0;
+};
@@ -1,7 +1,10 @@
 #include "taskdelegate.h"
-#include "taskmodel.h"
+#include "taskproxymodel.h"
+#include "tasktreemodel.h"
 #include "task.h"
+#include "instrumentation.h"
 #include <QPainter>
+#include <QPixmapCache>
 #include <QMouseEvent>
 
 TaskDelegate::TaskDelegate(QObject *parent)
@@ -12,15 +15,25 @@ TaskDelegate::TaskDelegate(QObject *parent)
 void TaskDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
                          const QModelIndex &index) const
 {
+    DRW_SCOPED_TIMER(PaintSection);
+    DRW_COUNT(RowsPainted);
+
+    // Модель задач отдаёт строку одним вызовом, остальные модели - по ролям
+    TaskModel::RowSnapshot row;
+    ProgressHistory roleHistory;
+    if (!readSnapshot(index, row))
+    {
+        if (index.data(TaskTreeModel::GroupRole).toBool())
+        {
+            paintGroup(painter, option, index);
+            return;
+        }
+        readRoles(index, row, roleHistory);
+    }
+
     painter->save();
     painter->setRenderHint(QPainter::Antialiasing);
 
-    // Получаем данные из модели
-    const QString name = index.data(TaskModel::NameRole).toString();
-    const QDateTime date = index.data(TaskModel::DateRole).toDateTime();
-    const int progress = index.data(TaskModel::ProgressRole).toInt();
-    const bool running = index.data(TaskModel::RunningRole).toBool();
-
     const QRect itemRect = option.rect.adjusted(ITEM_MARGIN, ITEM_VERTICAL_MARGIN,
                                                 -ITEM_MARGIN, -ITEM_VERTICAL_MARGIN);
 
@@ -29,18 +42,92 @@ void TaskDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
     const bool isHovered = option.state & QStyle::State_MouseOver;
 
     drawBackground(painter, itemRect, isSelected, isHovered);
-    drawDate(painter, itemRect, date);
-    drawName(painter, itemRect, name);
+    drawDate(painter, itemRect, row.dateMs);
+    drawName(painter, itemRect, row.name);
+    if (row.history)
+        drawSparkline(painter, itemRect, *row.history);
 
-    if (progress > 0)
-        drawProgress(painter, itemRect, progress);
+    if (row.progress > 0)
+        drawProgress(painter, itemRect, row.progress);
+
+    // Задачи из архива доступны только для просмотра
+    if (!row.archived)
+    {
+        const QRect buttonRect = getButtonRect(option);
+        drawButton(painter, buttonRect, row.running, row.progress);
+    }
+
+    painter->restore();
+
+    if (Instrumentation::isEnabled())
+        recordPaintLatency(index, row.progressStampNs);
+}
+
+bool TaskDelegate::readSnapshot(const QModelIndex &index, TaskModel::RowSnapshot &snapshot)
+{
+    if (const auto *proxy = qobject_cast<const TaskProxyModel*>(index.model()))
+        return proxy->rowSnapshot(index, snapshot);
+    if (const auto *model = qobject_cast<const TaskModel*>(index.model()))
+        return model->rowSnapshot(index.row(), snapshot);
+    return false;
+}
+
+void TaskDelegate::readRoles(const QModelIndex &index, TaskModel::RowSnapshot &snapshot,
+                             ProgressHistory &history)
+{
+    snapshot.name = index.data(TaskModel::NameRole).toString();
+    snapshot.dateMs = index.data(TaskModel::DateRole).toDateTime().toMSecsSinceEpoch();
+    snapshot.progress = index.data(TaskModel::ProgressRole).toInt();
+    snapshot.running = index.data(TaskModel::RunningRole).toBool();
+    snapshot.archived = index.data(TaskModel::ArchivedRole).toBool();
+    snapshot.progressStampNs = index.data(TaskModel::ProgressStampRole).toLongLong();
+    history = index.data(TaskModel::HistoryRole).value<ProgressHistory>();
+    snapshot.history = &history;
+}
+
+void TaskDelegate::paintGroup(QPainter *painter, const QStyleOptionViewItem &option,
+                              const QModelIndex &index) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // Сводка группы вычисляется TaskTreeModel за O(log n)
+    const QString name = index.data(TaskModel::NameRole).toString();
+    const int progress = index.data(TaskModel::ProgressRole).toInt();
+    const int taskCount = index.data(TaskTreeModel::TaskCountRole).toInt();
+    const int runningCount = index.data(TaskTreeModel::RunningCountRole).toInt();
 
-    const QRect buttonRect = getButtonRect(option);
-    drawButton(painter, buttonRect, running, progress);
+    const QRect itemRect = option.rect.adjusted(ITEM_MARGIN, ITEM_VERTICAL_MARGIN,
+                                                -ITEM_MARGIN, -ITEM_VERTICAL_MARGIN);
+
+    drawBackground(painter, itemRect, option.state & QStyle::State_Selected,
+                   option.state & QStyle::State_MouseOver);
+    drawGroupSummary(painter, itemRect, taskCount, runningCount);
+    drawName(painter, itemRect, name);
+    drawProgress(painter, itemRect, progress);
+    drawButton(painter, getButtonRect(option), runningCount > 0, progress);
 
     painter->restore();
 }
 
+void TaskDelegate::recordPaintLatency(const QModelIndex &index, qint64 stamp) const
+{
+    if (stamp == 0)
+        return;
+
+    const qint64 latency = MonotonicClock::nsecs() - stamp;
+    if (latency < STALE_PAINT_LATENCY_NS)
+        Instrumentation::record(Instrumentation::TickToPixelSection, latency);
+
+    // Отметка снимается через модель строки, без указателя на задачу в QVariant
+    if (const auto *proxy = qobject_cast<const TaskProxyModel*>(index.model()))
+        proxy->markRowPainted(index);
+    else if (const auto *model = qobject_cast<const TaskModel*>(index.model()))
+        model->markRowPainted(index.row());
+    else if (const auto *tree = qobject_cast<const TaskTreeModel*>(index.model()))
+        tree->markRowPainted(index);
+}
+
 QSize TaskDelegate::sizeHint(const QStyleOptionViewItem &option,
                              const QModelIndex &index) const
 {
@@ -58,7 +145,8 @@ bool TaskDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
         auto *mouseEvent = static_cast<QMouseEvent*>(event);
         const auto buttonRect = getButtonRect(option);
 
-        if (buttonRect.contains(mouseEvent->pos()))
+        if (buttonRect.contains(mouseEvent->pos())
+            && !index.data(TaskModel::ArchivedRole).toBool())
         {
             // Клик по кнопке
             emit startStopClicked(index);
@@ -101,7 +189,7 @@ void TaskDelegate::drawBackground(QPainter *painter, const QRect &rect,
 }
 
 void TaskDelegate::drawDate(QPainter *painter, const QRect &rect,
-                            const QDateTime &date) const
+                            qint64 dateMs) const
 {
     const auto dateRect = rect.adjusted(DATE_LEFT_MARGIN, 0, 0, 0);
 
@@ -110,7 +198,20 @@ void TaskDelegate::drawDate(QPainter *painter, const QRect &rect,
     painter->drawText(dateRect.left(), dateRect.top(),
                       DATE_WIDTH, dateRect.height(),
                       Qt::AlignVCenter | Qt::AlignLeft,
-                      date.toString("dd.MM.yyyy hh:mm"));
+                      QDateTime::fromMSecsSinceEpoch(dateMs).toString("dd.MM.yyyy hh:mm"));
+}
+
+void TaskDelegate::drawGroupSummary(QPainter *painter, const QRect &rect,
+                                    int taskCount, int runningCount) const
+{
+    const auto summaryRect = rect.adjusted(DATE_LEFT_MARGIN, 0, 0, 0);
+
+    painter->setPen(QColor("#7f8c8d"));
+    painter->setFont(QFont("Arial", 10));
+    painter->drawText(summaryRect.left(), summaryRect.top(),
+                      DATE_WIDTH, summaryRect.height(),
+                      Qt::AlignVCenter | Qt::AlignLeft,
+                      QString("Задач: %1\nВыполняется: %2").arg(taskCount).arg(runningCount));
 }
 
 void TaskDelegate::drawName(QPainter *painter, const QRect &rect,
@@ -160,6 +261,52 @@ void TaskDelegate::drawProgress(QPainter *painter, const QRect &rect,
                       QString::number(progress) + "%");
 }
 
+void TaskDelegate::drawSparkline(QPainter *painter, const QRect &rect,
+                                 const ProgressHistory &history) const
+{
+    if (history.count() < 2)
+        return;
+
+    const QRect sparkRect(rect.right() - SPARKLINE_RIGHT_OFFSET,
+                          rect.top() + (rect.height() - SPARKLINE_HEIGHT) / 2,
+                          SPARKLINE_WIDTH,
+                          SPARKLINE_HEIGHT);
+
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const QString key = QString("task-sparkline-%1-%2").arg(history.revision()).arg(dpr);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap))
+    {
+        pixmap = QPixmap(sparkRect.size() * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(Qt::transparent);
+
+        // Ось X - время от самого старого замера, ось Y - прогресс
+        const auto samples = history.samples();
+        const qreal span = qMax<qint64>(samples.last().offsetMs, 1);
+
+        QPolygonF polyline;
+        polyline.reserve(samples.size());
+        for (const auto &sample : samples)
+        {
+            polyline << QPointF(1 + sample.offsetMs / span * (SPARKLINE_WIDTH - 2),
+                                1 + (1.0 - qreal(sample.progress) / Task::MAX_PROGRESS)
+                                        * (SPARKLINE_HEIGHT - 2));
+        }
+
+        QPainter sparkPainter(&pixmap);
+        sparkPainter.setRenderHint(QPainter::Antialiasing);
+        sparkPainter.setPen(QPen(QColor("#2196F3"), 1.5));
+        sparkPainter.drawPolyline(polyline);
+        sparkPainter.end();
+
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    painter->drawPixmap(sparkRect.topLeft(), pixmap);
+}
+
 void TaskDelegate::drawButton(QPainter *painter, const QRect &buttonRect,
                               bool running, int progress) const
 {
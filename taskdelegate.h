@@ -1,6 +1,8 @@
 #pragma once
 
 #include <QStyledItemDelegate>
+#include "progresshistory.h"
+#include "taskmodel.h"
 
 /**
  * @class TaskDelegate
@@ -9,6 +11,8 @@
  * TaskDelegate отвечает за визуальное представление задач в списке,
  * включая отрисовку даты, названия, прогресса и кнопки управления.
  * Также обрабатывает клики по кнопке и выделение элементов.
+ * Строки групп TaskTreeModel отрисовываются со сводным прогрессом и
+ * количеством задач вместо даты.
  */
 class TaskDelegate : public QStyledItemDelegate
 {
@@ -32,8 +36,17 @@ class TaskDelegate : public QStyledItemDelegate
     /// Отступ названия от области даты
     static constexpr int NAME_LEFT_MARGIN = 145;
 
-    /// Отступ справа для кнопки и прогресса
-    static constexpr int RIGHT_CONTENT_MARGIN = 250;
+    /// Отступ справа для кнопки, прогресса и истории прогресса
+    static constexpr int RIGHT_CONTENT_MARGIN = 330;
+
+    /// Ширина графика истории прогресса
+    static constexpr int SPARKLINE_WIDTH = 70;
+
+    /// Высота графика истории прогресса
+    static constexpr int SPARKLINE_HEIGHT = 30;
+
+    /// Отступ графика истории от правого края
+    static constexpr int SPARKLINE_RIGHT_OFFSET = 280;
 
     /// Размер виджета кругового прогресса
     static constexpr int PROGRESS_SIZE = 45;
@@ -68,6 +81,9 @@ class TaskDelegate : public QStyledItemDelegate
     /// Радиус скругления кнопки
     static constexpr int BUTTON_BORDER_RADIUS = 18;
 
+    /// Задержка, после которой изменение считается отрисованным при прокрутке, а не по обновлению (нс)
+    static constexpr qint64 STALE_PAINT_LATENCY_NS = 2000000000;
+
 public:
     /**
      * @brief Конструктор делегата
@@ -87,6 +103,8 @@ public:
      * @param index Индекс элемента в модели
      *
      * Отрисовывает фон, дату, название, круговой прогресс и кнопку управления.
+     * Данные строк TaskProxyModel и TaskModel читаются одним вызовом
+     * rowSnapshot(), строк других моделей - через роли.
      */
     void paint(QPainter *painter, const QStyleOptionViewItem &option,
                const QModelIndex &index) const override;
@@ -129,6 +147,33 @@ private:
      */
     QRect getButtonRect(const QStyleOptionViewItem &option) const;
 
+    /**
+     * @brief Прочитать данные строки одним вызовом модели
+     * @param index Индекс строки
+     * @param snapshot Данные строки (выходной параметр)
+     * @return true, если модель представления - TaskProxyModel или TaskModel
+     */
+    static bool readSnapshot(const QModelIndex &index, TaskModel::RowSnapshot &snapshot);
+
+    /**
+     * @brief Прочитать данные строки через роли модели
+     * @param index Индекс строки
+     * @param snapshot Данные строки (выходной параметр)
+     * @param history Хранилище истории, на которое указывает snapshot.history
+     */
+    static void readRoles(const QModelIndex &index, TaskModel::RowSnapshot &snapshot,
+                          ProgressHistory &history);
+
+    /**
+     * @brief Записать задержку от изменения прогресса до отрисовки
+     * @param index Индекс отрисовываемой задачи
+     * @param stamp Время первого неотрисованного изменения прогресса (нс, 0 - нет)
+     *
+     * Учитывает только первую отрисовку после изменения. Слишком старые
+     * изменения (строка была вне области просмотра) не записываются.
+     */
+    void recordPaintLatency(const QModelIndex &index, qint64 stamp) const;
+
     /**
      * @brief Отрисовать фон элемента
      * @param painter Объект рисования
@@ -139,14 +184,33 @@ private:
     void drawBackground(QPainter *painter, const QRect &rect,
                         bool isSelected, bool isHovered) const;
 
+    /**
+     * @brief Отрисовать строку группы
+     * @param painter Объект рисования
+     * @param option Опции стиля элемента
+     * @param index Индекс группы в TaskTreeModel
+     */
+    void paintGroup(QPainter *painter, const QStyleOptionViewItem &option,
+                    const QModelIndex &index) const;
+
+    /**
+     * @brief Отрисовать количество задач группы
+     * @param painter Объект рисования
+     * @param rect Область элемента
+     * @param taskCount Количество задач
+     * @param runningCount Количество выполняющихся задач
+     */
+    void drawGroupSummary(QPainter *painter, const QRect &rect,
+                          int taskCount, int runningCount) const;
+
     /**
      * @brief Отрисовать дату создания
      * @param painter Объект рисования
      * @param rect Область элемента
-     * @param date Дата для отображения
+     * @param dateMs Дата для отображения (мс от эпохи)
      */
     void drawDate(QPainter *painter, const QRect &rect,
-                  const QDateTime &date) const;
+                  qint64 dateMs) const;
 
     /**
      * @brief Отрисовать название задачи
@@ -166,6 +230,18 @@ private:
     void drawProgress(QPainter *painter, const QRect &rect,
                       int progress) const;
 
+    /**
+     * @brief Отрисовать график истории прогресса
+     * @param painter Объект рисования
+     * @param rect Область элемента
+     * @param history История прогресса задачи
+     *
+     * Ломаная кэшируется в QPixmapCache по номеру ревизии истории и
+     * перерисовывается только при появлении нового замера.
+     */
+    void drawSparkline(QPainter *painter, const QRect &rect,
+                       const ProgressHistory &history) const;
+
     /**
      * @brief Отрисовать кнопку управления
      * @param painter Объект рисования
@@ -0,0 +1,229 @@
+#include "taskeventlog.h"
+#include "monotonicclock.h"
+#include <QThread>
+#include <cstring>
+
+TaskEventLog *TaskEventLog::s_active = nullptr;
+
+namespace {
+
+/// Маска индекса кольцевого буфера
+constexpr quint64 BUFFER_MASK = TaskEventLog::BUFFER_CAPACITY - 1;
+
+/// Названия типов событий для NDJSON
+const char *const EVENT_NAMES[] = {
+    "add", "start", "stop", "progress", "complete", "remove"
+};
+
+/// Экранировать строку для JSON
+QByteArray jsonEscape(const char *data, int size)
+{
+    QByteArray result;
+    result.reserve(size + 2);
+    for (int i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+        switch (c)
+        {
+        case '"':  result.append("\\\""); break;
+        case '\\': result.append("\\\\"); break;
+        case '\n': result.append("\\n"); break;
+        case '\r': result.append("\\r"); break;
+        case '\t': result.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                result.append(QByteArray("\\u00") + QByteArray::number(c, 16).rightJustified(2, '0'));
+            else
+                result.append(c);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TaskEventLog::TaskEventLog(const QString &path, Format format)
+    : m_path(path)
+    , m_format(format)
+    , m_file(path)
+    , m_buffer(new Event[BUFFER_CAPACITY])
+{
+}
+
+TaskEventLog::~TaskEventLog()
+{
+    stop();
+}
+
+bool TaskEventLog::start()
+{
+    if (m_running)
+        return true;
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    if (m_format == ChromeTrace)
+    {
+        m_file.write("{\"traceEvents\":[\n");
+        m_firstTraceEvent = true;
+    }
+
+    m_running = true;
+    m_thread = QThread::create([this]() {
+        while (m_running)
+        {
+            if (drain() == 0)
+                QThread::msleep(DRAIN_INTERVAL);
+        }
+        drain();
+    });
+    m_thread->start();
+
+    s_active = this;
+    return true;
+}
+
+void TaskEventLog::stop()
+{
+    if (s_active == this)
+        s_active = nullptr;
+
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    if (m_format == ChromeTrace)
+        m_file.write("\n]}\n");
+    m_file.close();
+}
+
+void TaskEventLog::push(EventType type, quint64 taskId, int value, const QString &name)
+{
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= quint64(BUFFER_CAPACITY))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event &event = m_buffer[head & BUFFER_MASK];
+    event.timestampNs = MonotonicClock::nsecs();
+    event.taskId = taskId;
+    event.value = value;
+    event.type = type;
+    event.nameLength = 0;
+
+    if (!name.isEmpty())
+    {
+        const QByteArray utf8 = name.toUtf8();
+        int length = qMin(static_cast<int>(utf8.size()), NAME_CAPACITY);
+
+        // Не разрываем многобайтовый символ при усечении
+        if (length < utf8.size())
+        {
+            while (length > 0 && (static_cast<unsigned char>(utf8.at(length)) & 0xC0) == 0x80)
+                --length;
+        }
+        std::memcpy(event.name, utf8.constData(), length);
+        event.nameLength = static_cast<quint8>(length);
+    }
+
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+int TaskEventLog::drain()
+{
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const int count = static_cast<int>(head - tail);
+
+    while (tail != head)
+    {
+        writeEvent(m_buffer[tail & BUFFER_MASK]);
+        ++tail;
+    }
+    m_tail.store(tail, std::memory_order_release);
+
+    if (count > 0)
+    {
+        m_file.flush();
+        if (m_format == NdJson)
+            rotateIfNeeded();
+    }
+    return count;
+}
+
+void TaskEventLog::writeEvent(const Event &event)
+{
+    const QByteArray id = QByteArray::number(event.taskId);
+    const QByteArray name = jsonEscape(event.name, event.nameLength);
+    QByteArray line;
+
+    if (m_format == NdJson)
+    {
+        line = "{\"ts_ns\":" + QByteArray::number(event.timestampNs)
+               + ",\"event\":\"" + EVENT_NAMES[event.type]
+               + "\",\"task\":" + id
+               + ",\"value\":" + QByteArray::number(event.value);
+        if (event.nameLength > 0)
+            line += ",\"name\":\"" + name + "\"";
+        line += "}\n";
+        m_file.write(line);
+        return;
+    }
+
+    // Трасса Chrome: задача - отдельный поток, выполнение - интервал B/E
+    const QByteArray common = ",\"pid\":1,\"tid\":" + id
+                              + ",\"ts\":" + QByteArray::number(event.timestampNs / 1000.0, 'f', 3);
+    switch (event.type)
+    {
+    case Added:
+        line = "{\"name\":\"thread_name\",\"ph\":\"M\"" + common
+               + ",\"args\":{\"name\":\"" + name + "\"}},\n"
+               + "{\"name\":\"add\",\"ph\":\"i\",\"s\":\"t\"" + common + "}";
+        break;
+    case Started:
+        line = "{\"name\":\"run\",\"ph\":\"B\"" + common
+               + ",\"args\":{\"progress\":" + QByteArray::number(event.value) + "}}";
+        break;
+    case Stopped:
+        line = "{\"name\":\"run\",\"ph\":\"E\"" + common + "}";
+        break;
+    case Progress:
+        line = "{\"name\":\"progress #" + id + "\",\"ph\":\"C\"" + common
+               + ",\"args\":{\"progress\":" + QByteArray::number(event.value) + "}}";
+        break;
+    case Completed:
+        line = "{\"name\":\"complete\",\"ph\":\"i\",\"s\":\"t\"" + common + "}";
+        break;
+    case Removed:
+        line = "{\"name\":\"remove\",\"ph\":\"i\",\"s\":\"t\"" + common + "}";
+        break;
+    }
+
+    if (!m_firstTraceEvent)
+        m_file.write(",\n");
+    m_firstTraceEvent = false;
+    m_file.write(line);
+}
+
+void TaskEventLog::rotateIfNeeded()
+{
+    if (m_file.size() < ROTATE_SIZE)
+        return;
+
+    m_file.close();
+
+    // path.(N-1) -> path.N, ..., path -> path.1
+    QFile::remove(QString("%1.%2").arg(m_path).arg(ROTATE_KEEP));
+    for (int i = ROTATE_KEEP - 1; i >= 1; --i)
+        QFile::rename(QString("%1.%2").arg(m_path).arg(i), QString("%1.%2").arg(m_path).arg(i + 1));
+    QFile::rename(m_path, m_path + ".1");
+
+    m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
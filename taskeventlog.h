@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+class QThread;
+
+/**
+ * @class TaskEventLog
+ * @brief Журнал событий жизненного цикла задач
+ *
+ * Записывает события добавления, запуска, остановки, изменения прогресса,
+ * завершения и удаления задач с монотонными временными метками в
+ * lock-free кольцевой буфер (один производитель - поток GUI, один
+ * потребитель). Фоновый поток выгружает буфер в файл NDJSON с ротацией
+ * или в JSON-трассу формата Chrome about:tracing.
+ *
+ * Когда журнал не активен, точка записи сводится к проверке одного
+ * указателя. При переполнении буфера события отбрасываются, а поток
+ * GUI никогда не блокируется.
+ */
+class TaskEventLog
+{
+public:
+    /// Ёмкость кольцевого буфера (степень двойки)
+    static constexpr int BUFFER_CAPACITY = 1 << 16;
+
+    /// Интервал опроса буфера фоновым потоком (мс)
+    static constexpr int DRAIN_INTERVAL = 20;
+
+    /// Размер файла NDJSON, после которого выполняется ротация (байт)
+    static constexpr qint64 ROTATE_SIZE = 64 * 1024 * 1024;
+
+    /// Количество хранимых файлов после ротации
+    static constexpr int ROTATE_KEEP = 5;
+
+    /// Максимальная длина сохраняемого названия задачи (байт UTF-8)
+    static constexpr int NAME_CAPACITY = 40;
+
+    /**
+     * @enum EventType
+     * @brief Типы событий
+     */
+    enum EventType : quint8 {
+        Added,      ///< Задача добавлена в модель
+        Started,    ///< Задача запущена
+        Stopped,    ///< Задача остановлена
+        Progress,   ///< Изменился прогресс задачи
+        Completed,  ///< Задача выполнена на 100%
+        Removed     ///< Задача удалена из модели
+    };
+
+    /**
+     * @enum Format
+     * @brief Формат выходного файла
+     */
+    enum Format {
+        NdJson,      ///< Объект JSON на строку, с ротацией файлов
+        ChromeTrace  ///< Трасса для chrome://tracing (about:tracing)
+    };
+
+    /**
+     * @brief Конструктор журнала
+     * @param path Путь к выходному файлу
+     * @param format Формат выходного файла
+     */
+    TaskEventLog(const QString &path, Format format);
+
+    /**
+     * @brief Деструктор
+     *
+     * Останавливает журнал, выгружая оставшиеся события.
+     */
+    ~TaskEventLog();
+
+    TaskEventLog(const TaskEventLog &) = delete;
+    TaskEventLog &operator=(const TaskEventLog &) = delete;
+
+    /**
+     * @brief Открыть файл, запустить фоновый поток и сделать журнал активным
+     * @return false если файл не удалось открыть
+     */
+    bool start();
+
+    /**
+     * @brief Отключить журнал и дождаться выгрузки оставшихся событий
+     */
+    void stop();
+
+    /**
+     * @brief Получить описание последней ошибки
+     * @return Текст ошибки
+     */
+    QString errorString() const { return m_file.errorString(); }
+
+    /**
+     * @brief Получить количество отброшенных из-за переполнения событий
+     * @return Количество событий
+     */
+    quint64 droppedEvents() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Записать событие в активный журнал
+     * @param type Тип события
+     * @param taskId Идентификатор задачи
+     * @param value Значение (прогресс для Progress, иначе текущий прогресс)
+     * @param name Название задачи (используется для Added)
+     *
+     * Вызывается только из потока GUI. Если журнал не активен, метод
+     * ничего не делает.
+     */
+    static void record(EventType type, quint64 taskId, int value,
+                       const QString &name = QString())
+    {
+        if (Q_UNLIKELY(s_active != nullptr))
+            s_active->push(type, taskId, value, name);
+    }
+
+private:
+    /**
+     * @struct Event
+     * @brief Запись буфера фиксированного размера
+     */
+    struct Event
+    {
+        qint64 timestampNs;        ///< Время события (MonotonicClock, нс)
+        quint64 taskId;            ///< Идентификатор задачи
+        qint32 value;              ///< Значение события
+        quint8 type;               ///< Тип события
+        quint8 nameLength;         ///< Длина названия (байт)
+        char name[NAME_CAPACITY];  ///< Название в UTF-8 (только для Added)
+    };
+
+    /**
+     * @brief Поместить событие в буфер (поток производителя)
+     */
+    void push(EventType type, quint64 taskId, int value, const QString &name);
+
+    /**
+     * @brief Выгрузить накопленные события в файл (поток потребителя)
+     * @return Количество выгруженных событий
+     */
+    int drain();
+
+    /**
+     * @brief Записать одно событие в файл
+     * @param event Событие
+     */
+    void writeEvent(const Event &event);
+
+    /**
+     * @brief Выполнить ротацию файлов NDJSON при превышении размера
+     */
+    void rotateIfNeeded();
+
+    static TaskEventLog *s_active;  ///< Активный журнал или nullptr
+
+    QString m_path;                               ///< Путь к выходному файлу
+    Format m_format;                              ///< Формат выходного файла
+    QFile m_file;                                 ///< Выходной файл
+    std::unique_ptr<Event[]> m_buffer;            ///< Кольцевой буфер событий
+    std::atomic<quint64> m_head{0};               ///< Следующая позиция записи (производитель)
+    std::atomic<quint64> m_tail{0};               ///< Следующая позиция чтения (потребитель)
+    std::atomic<quint64> m_dropped{0};            ///< Отброшенные события
+    std::atomic_bool m_running{false};            ///< Работает ли фоновый поток
+    QThread *m_thread{nullptr};                   ///< Фоновый поток выгрузки
+    bool m_firstTraceEvent{true};                 ///< В трассу ещё не записано ни одного события
+};
@@ -0,0 +1,174 @@
+#include "taskimporter.h"
+#include "tasklistparser.h"
+#include <QFile>
+#include <QThread>
+
+namespace {
+
+/// Интервал проверки отмены при ожидании места для пакета (мс)
+constexpr int CANCEL_POLL_INTERVAL = 50;
+
+} // namespace
+
+TaskImporter::TaskImporter(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<TaskImporter::Result>();
+}
+
+TaskImporter::~TaskImporter()
+{
+    cancel();
+    if (m_thread)
+    {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+bool TaskImporter::start(const QString &path, const QSet<QString> &existingNames)
+{
+    if (isRunning())
+        return false;
+
+    m_cancelled = false;
+
+    QThread *thread = QThread::create([this, path, existingNames]() {
+        const auto consumer = [this](const QStringList &names) {
+            // Ждём, пока получатель обработает предыдущие пакеты
+            while (!m_pendingBatches.tryAcquire(1, CANCEL_POLL_INTERVAL))
+            {
+                if (m_cancelled)
+                    return false;
+            }
+            emit batchReady(names);
+            return true;
+        };
+        const auto progress = [this](qint64 bytes, qint64 total) {
+            emit progressChanged(bytes, total);
+        };
+
+        emit finished(importFile(path, existingNames, consumer, &m_cancelled, progress));
+    });
+
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        if (m_thread == thread)
+            m_thread = nullptr;
+        thread->deleteLater();
+    });
+
+    m_thread = thread;
+    m_thread->start();
+    return true;
+}
+
+void TaskImporter::cancel()
+{
+    m_cancelled = true;
+}
+
+bool TaskImporter::isRunning() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+void TaskImporter::batchConsumed()
+{
+    m_pendingBatches.release();
+}
+
+TaskImporter::Result TaskImporter::importFile(const QString &path, QSet<QString> existingNames,
+                                              const std::function<bool(const QStringList &)> &consumer,
+                                              const std::atomic_bool *cancelled,
+                                              const std::function<void(qint64, qint64)> &progress)
+{
+    Result result;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        result.error = file.errorString();
+        return result;
+    }
+
+    const qint64 total = file.size();
+    TaskListParser parser(TaskListParser::formatForFile(path));
+    QStringList parsed;
+    QStringList batch;
+    batch.reserve(BATCH_SIZE);
+
+    // Проверка дубликатов и формирование пакетов
+    const auto flushParsed = [&]() {
+        for (QString &name : parsed)
+        {
+            const QString key = name.toCaseFolded();
+            if (existingNames.contains(key))
+            {
+                ++result.duplicates;
+                continue;
+            }
+            existingNames.insert(key);
+            batch.append(std::move(name));
+
+            if (batch.size() >= BATCH_SIZE)
+            {
+                // Пакет, не переданный из-за отмены, не учитывается
+                if (consumer(batch))
+                    result.imported += batch.size();
+                batch.clear();
+                batch.reserve(BATCH_SIZE);
+            }
+        }
+        parsed.clear();
+    };
+
+    const auto isCancelled = [cancelled]() {
+        return cancelled && cancelled->load();
+    };
+
+    uchar *mapped = total > 0 ? file.map(0, total) : nullptr;
+    if (mapped)
+    {
+        // Разбираем отображённый файл блоками без копирования
+        const char *data = reinterpret_cast<const char*>(mapped);
+        while (result.bytes < total && !isCancelled())
+        {
+            const qint64 chunk = qMin(CHUNK_SIZE, total - result.bytes);
+            const bool final = result.bytes + chunk >= total;
+            qint64 consumed = parser.parse(data + result.bytes, chunk, final, parsed);
+
+            // Строка длиннее блока - разбираем остаток файла целиком
+            if (consumed == 0)
+                consumed = parser.parse(data + result.bytes, total - result.bytes, true, parsed);
+
+            result.bytes += consumed;
+            flushParsed();
+            if (progress)
+                progress(result.bytes, total);
+        }
+        file.unmap(mapped);
+    }
+    else
+    {
+        // Отображение недоступно - читаем блоками, перенося неполную строку
+        QByteArray buffer;
+        while (!file.atEnd() && !isCancelled())
+        {
+            buffer.append(file.read(CHUNK_SIZE));
+            const bool final = file.atEnd();
+            const qint64 consumed = parser.parse(buffer.constData(), buffer.size(), final, parsed);
+            buffer.remove(0, static_cast<int>(consumed));
+
+            result.bytes += consumed;
+            flushParsed();
+            if (progress)
+                progress(result.bytes, total);
+        }
+    }
+
+    result.cancelled = isCancelled();
+    if (!result.cancelled && !batch.isEmpty() && consumer(batch))
+        result.imported += batch.size();
+    result.invalid = parser.invalidRows();
+    return result;
+}
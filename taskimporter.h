@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QObject>
+#include <QSemaphore>
+#include <QSet>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+
+class QThread;
+
+/**
+ * @class TaskImporter
+ * @brief Потоковый импорт списков задач из файлов CSV и NDJSON
+ *
+ * TaskImporter читает файл в рабочем потоке (через отображение в память,
+ * а при невозможности - блоками), разбирает его TaskListParser, проверяет
+ * и исключает дубликаты названий вне потока GUI и передаёт модели готовые
+ * пакеты через сигнал batchReady(). Количество необработанных пакетов
+ * ограничено MAX_PENDING_BATCHES: рабочий поток ждёт, пока получатель
+ * не подтвердит обработку вызовом batchConsumed().
+ */
+class TaskImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Количество названий в одном пакете
+    static constexpr int BATCH_SIZE = 10000;
+
+    /// Размер блока разбора и чтения (байт)
+    static constexpr qint64 CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /// Максимальное количество пакетов, ожидающих обработки получателем
+    static constexpr int MAX_PENDING_BATCHES = 4;
+
+    /**
+     * @struct Result
+     * @brief Итоги импорта
+     */
+    struct Result
+    {
+        qint64 imported{0};    ///< Переданные в пакетах названия
+        qint64 duplicates{0};  ///< Отброшенные дубликаты
+        qint64 invalid{0};     ///< Отброшенные некорректные строки
+        qint64 bytes{0};       ///< Обработанный объём (байт)
+        bool cancelled{false}; ///< Импорт был отменён
+        QString error;         ///< Описание ошибки (пусто при успехе)
+    };
+
+    /**
+     * @brief Конструктор импортёра
+     * @param parent Родительский объект
+     */
+    explicit TaskImporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Деструктор
+     *
+     * Отменяет незавершённый импорт и дожидается рабочего потока.
+     */
+    ~TaskImporter() override;
+
+    /**
+     * @brief Начать импорт файла
+     * @param path Путь к файлу
+     * @param existingNames Уже существующие названия в свёрнутом регистре
+     * @return false если импорт уже выполняется
+     */
+    bool start(const QString &path, const QSet<QString> &existingNames);
+
+    /**
+     * @brief Отменить импорт
+     */
+    void cancel();
+
+    /**
+     * @brief Проверить, выполняется ли импорт
+     * @return true если рабочий поток запущен
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Подтвердить обработку пакета
+     *
+     * Получатель сигнала batchReady() вызывает метод после вставки пакета,
+     * разрешая рабочему потоку подготовить следующий.
+     */
+    void batchConsumed();
+
+    /**
+     * @brief Импортировать файл синхронно в текущем потоке
+     * @param path Путь к файлу
+     * @param existingNames Уже существующие названия в свёрнутом регистре
+     * @param consumer Функция, вызываемая для каждого готового пакета;
+     *                 возвращает false, если пакет не передан (импорт отменён)
+     * @param cancelled Флаг отмены (может быть nullptr)
+     * @param progress Функция, вызываемая после каждого блока (может быть пустой)
+     * @return Итоги импорта
+     *
+     * Используется рабочим потоком и бенчмарком.
+     */
+    static Result importFile(const QString &path, QSet<QString> existingNames,
+                             const std::function<bool(const QStringList &)> &consumer,
+                             const std::atomic_bool *cancelled = nullptr,
+                             const std::function<void(qint64, qint64)> &progress = {});
+
+signals:
+    /**
+     * @brief Сигнал о готовности пакета названий
+     * @param names Проверенные уникальные названия
+     */
+    void batchReady(const QStringList &names);
+
+    /**
+     * @brief Сигнал о ходе импорта
+     * @param bytes Обработанный объём (байт)
+     * @param total Размер файла (байт)
+     */
+    void progressChanged(qint64 bytes, qint64 total);
+
+    /**
+     * @brief Сигнал о завершении импорта
+     * @param result Итоги импорта
+     */
+    void finished(const TaskImporter::Result &result);
+
+private:
+    QThread *m_thread{nullptr};                  ///< Рабочий поток
+    QSemaphore m_pendingBatches{MAX_PENDING_BATCHES}; ///< Свободные места для пакетов
+    std::atomic_bool m_cancelled{false};         ///< Флаг отмены
+};
+
+Q_DECLARE_METATYPE(TaskImporter::Result)
@@ -0,0 +1,172 @@
+#include "tasklistparser.h"
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+namespace {
+
+/// Пропустить пробельные символы
+const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+} // namespace
+
+TaskListParser::TaskListParser(Format format)
+    : m_format(format)
+{
+}
+
+TaskListParser::Format TaskListParser::formatForFile(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "ndjson" || suffix == "jsonl" || suffix == "json")
+        return NdJson;
+    return Csv;
+}
+
+qint64 TaskListParser::parse(const char *data, qint64 size, bool final, QStringList &names)
+{
+    const char *p = data;
+    const char *end = data + size;
+
+    // Пропускаем BOM UTF-8 в начале потока
+    if (m_firstLine && size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    while (p < end)
+    {
+        const char *newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline && !final)
+            break;
+
+        const char *lineEnd = newline ? newline : end;
+        const char *next = newline ? newline + 1 : end;
+        if (lineEnd > p && lineEnd[-1] == '\r')
+            --lineEnd;
+
+        const bool firstLine = m_firstLine;
+        m_firstLine = false;
+
+        if (lineEnd > p)
+        {
+            QString name;
+            const bool parsed = (m_format == Csv) ? parseCsvLine(p, lineEnd, name)
+                                                  : parseJsonLine(p, lineEnd, name);
+            name = name.trimmed();
+
+            if (firstLine && m_format == Csv && name.compare("name", Qt::CaseInsensitive) == 0)
+            {
+                // Заголовок CSV
+            }
+            else if (!parsed || name.isEmpty() || name.size() > MAX_NAME_LENGTH)
+                ++m_invalidRows;
+            else
+                names.append(name);
+        }
+
+        p = next;
+    }
+
+    return p - data;
+}
+
+bool TaskListParser::parseCsvLine(const char *begin, const char *end, QString &name)
+{
+    const char *p = skipSpaces(begin, end);
+
+    if (p < end && *p == '"')
+    {
+        // Поле в кавычках: "" внутри означает одну кавычку
+        QByteArray field;
+        ++p;
+        while (p < end)
+        {
+            if (*p == '"')
+            {
+                if (p + 1 < end && p[1] == '"')
+                {
+                    field.append('"');
+                    p += 2;
+                    continue;
+                }
+                name = QString::fromUtf8(field);
+                return true;
+            }
+            field.append(*p++);
+        }
+        // Незакрытая кавычка
+        return false;
+    }
+
+    const char *comma = static_cast<const char*>(std::memchr(p, ',', end - p));
+    const char *fieldEnd = comma ? comma : end;
+    name = QString::fromUtf8(p, static_cast<int>(fieldEnd - p));
+    return true;
+}
+
+bool TaskListParser::parseJsonLine(const char *begin, const char *end, QString &name)
+{
+    static const char key[] = "\"name\"";
+    constexpr int keyLength = sizeof(key) - 1;
+
+    // Быстрый путь: ищем ключ "name" со строковым значением без экранирования
+    const char *p = begin;
+    while (p + keyLength <= end)
+    {
+        const char *quote = static_cast<const char*>(std::memchr(p, '"', end - p));
+        if (!quote || quote + keyLength > end)
+            break;
+
+        if (std::memcmp(quote, key, keyLength) != 0)
+        {
+            p = quote + 1;
+            continue;
+        }
+
+        // Ключ должен идти после '{' или ',' - иначе это часть строкового значения
+        const char *before = quote;
+        while (before > begin && (before[-1] == ' ' || before[-1] == '\t'))
+            --before;
+        if (before == begin || (before[-1] != '{' && before[-1] != ','))
+        {
+            p = quote + 1;
+            continue;
+        }
+
+        const char *value = skipSpaces(quote + keyLength, end);
+        if (value >= end || *value != ':')
+            break;
+        value = skipSpaces(value + 1, end);
+        if (value >= end || *value != '"')
+            break;
+
+        const char *valueEnd = value + 1;
+        while (valueEnd < end && *valueEnd != '"' && *valueEnd != '\\')
+            ++valueEnd;
+        if (valueEnd < end && *valueEnd == '"')
+        {
+            name = QString::fromUtf8(value + 1, static_cast<int>(valueEnd - value - 1));
+            return true;
+        }
+        break;
+    }
+
+    // Медленный путь: экранированные символы или нестандартная разметка
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(
+        QByteArray::fromRawData(begin, static_cast<int>(end - begin)), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    const QJsonValue value = document.object().value("name");
+    if (!value.isString())
+        return false;
+
+    name = value.toString();
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class TaskListParser
+ * @brief Потоковый разборщик списков задач в форматах CSV и NDJSON
+ *
+ * Разбирает данные блоками без копирования всего файла: каждый вызов
+ * parse() обрабатывает только полные строки блока и сообщает, сколько
+ * байт использовано, чтобы остаток строки был передан со следующим блоком.
+ *
+ * - CSV: название задачи берётся из первого поля строки; поддерживаются
+ *   поля в кавычках с экранированием "". Первая строка с полем "name"
+ *   считается заголовком и пропускается. Переводы строк внутри полей
+ *   не поддерживаются.
+ * - NDJSON: каждая строка - JSON-объект, название берётся из ключа "name".
+ */
+class TaskListParser
+{
+public:
+    /// Максимальная длина названия задачи (символы)
+    static constexpr int MAX_NAME_LENGTH = 256;
+
+    /**
+     * @enum Format
+     * @brief Формат входных данных
+     */
+    enum Format {
+        Csv,    ///< Значения, разделённые запятыми
+        NdJson  ///< JSON-объект на каждой строке
+    };
+
+    /**
+     * @brief Конструктор разборщика
+     * @param format Формат входных данных
+     */
+    explicit TaskListParser(Format format);
+
+    /**
+     * @brief Определить формат по имени файла
+     * @param path Путь к файлу
+     * @return NdJson для расширений .ndjson, .jsonl и .json, иначе Csv
+     */
+    static Format formatForFile(const QString &path);
+
+    /**
+     * @brief Разобрать блок данных
+     * @param data Начало блока
+     * @param size Размер блока (байт)
+     * @param final true, если блок последний и неполная строка в конце тоже разбирается
+     * @param names Список, в который добавляются названия задач
+     * @return Количество обработанных байт (до конца последней полной строки)
+     */
+    qint64 parse(const char *data, qint64 size, bool final, QStringList &names);
+
+    /**
+     * @brief Получить количество отброшенных строк
+     * @return Строки без названия, с некорректным форматом или слишком длинным названием
+     */
+    qint64 invalidRows() const { return m_invalidRows; }
+
+private:
+    /**
+     * @brief Разобрать строку CSV
+     * @param begin Начало строки
+     * @param end Конец строки (без перевода строки)
+     * @param name Название задачи (выходной параметр)
+     * @return true если название найдено
+     */
+    bool parseCsvLine(const char *begin, const char *end, QString &name);
+
+    /**
+     * @brief Разобрать строку NDJSON
+     * @param begin Начало строки
+     * @param end Конец строки (без перевода строки)
+     * @param name Название задачи (выходной параметр)
+     * @return true если название найдено
+     */
+    bool parseJsonLine(const char *begin, const char *end, QString &name);
+
+    Format m_format;            ///< Формат входных данных
+    bool m_firstLine{true};     ///< Следующая строка - первая в потоке
+    qint64 m_invalidRows{0};    ///< Количество отброшенных строк
+};
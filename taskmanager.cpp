@@ -1,4 +1,19 @@
 #include "taskmanager.h"
+#include "controlserver.h"
+#include "metricsexporter.h"
+#include "performanceoverlay.h"
+#include "appstyle.h"
+#include "tasktreemodel.h"
+#include <QCloseEvent>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QShortcut>
+#include <QTextStream>
+#include <QThread>
+#include <QTreeView>
+#include <QWindow>
 
 TaskManager::TaskManager(QWidget *parent)
     : QMainWindow(parent)
@@ -7,11 +22,98 @@ TaskManager::TaskManager(QWidget *parent)
     m_proxyModel = new TaskProxyModel(this);
     m_proxyModel->setSourceModel(m_model);
     m_delegate = new TaskDelegate(this);
+    m_importer = new TaskImporter(this);
 
     setupUI();
 
     connect(m_delegate, &TaskDelegate::startStopClicked,
             this, &TaskManager::onStartStopClicked);
+    connect(m_model, &TaskModel::statisticsChanged,
+            this, &TaskManager::onStatisticsChanged);
+    connect(m_model, &TaskModel::removalProgress,
+            this, &TaskManager::onRemovalProgress);
+    connect(m_importer, &TaskImporter::batchReady,
+            this, &TaskManager::onImportBatch);
+    connect(m_importer, &TaskImporter::progressChanged,
+            this, &TaskManager::onImportProgress);
+    connect(m_importer, &TaskImporter::finished,
+            this, &TaskManager::onImportFinished);
+
+    auto *overlayShortcut = new QShortcut(QKeySequence(Qt::Key_F12), this);
+    connect(overlayShortcut, &QShortcut::activated,
+            this, &TaskManager::togglePerformanceOverlay);
+
+    auto *selectAllShortcut = new QShortcut(QKeySequence::SelectAll, this);
+    connect(selectAllShortcut, &QShortcut::activated,
+            this, &TaskManager::selectAllMatching);
+
+    onStatisticsChanged(m_model->statistics());
+}
+
+TaskManager::~TaskManager()
+{
+    // Поток обращается к окну при завершении чтения
+    if (m_sessionThread)
+        m_sessionThread->wait();
+}
+
+bool TaskManager::startControlServer(const QString &name)
+{
+    if (!m_controlServer)
+        m_controlServer = new ControlServer(m_model, this);
+
+    if (!m_controlServer->listen(name))
+    {
+        statusBar()->showMessage("Не удалось запустить сервер управления: "
+                                 + m_controlServer->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool TaskManager::startMetricsExporter(int port, const QString &textFile)
+{
+    if (!m_metricsExporter)
+        m_metricsExporter = new MetricsExporter(m_model, this);
+
+    bool ok = true;
+    if (port >= 0 && !m_metricsExporter->listen(static_cast<quint16>(port)))
+        ok = false;
+    if (!textFile.isEmpty() && !m_metricsExporter->setTextFile(textFile))
+        ok = false;
+
+    if (!ok)
+    {
+        statusBar()->showMessage("Не удалось включить публикацию показателей: "
+                                 + m_metricsExporter->errorString());
+    }
+    return ok;
+}
+
+void TaskManager::setComputedProgress(bool enabled)
+{
+    m_model->setComputedProgress(enabled);
+}
+
+bool TaskManager::openArchive(const QString &path, qint64 memoryLimit)
+{
+    m_model->setArchiveMemoryLimit(memoryLimit);
+    if (!m_model->openArchive(path))
+    {
+        statusBar()->showMessage("Не удалось открыть архив: " + m_model->archive().errorString());
+        return false;
+    }
+    return true;
+}
+
+void TaskManager::setProgressPattern(const QByteArray &pattern)
+{
+    m_model->setProgressPattern(pattern);
+}
+
+void TaskManager::setColdStorageDelay(int msecs)
+{
+    m_model->setColdStorageDelay(msecs);
 }
 
 void TaskManager::setupUI()
@@ -19,7 +121,11 @@ void TaskManager::setupUI()
     setWindowTitle("Менеджер задач");
     setMinimumSize(MIN_WINDOW_WIDTH, MIN_WINDOW_HEIGHT);
 
+    // Стили устанавливаются до создания виджетов, чтобы каждый полировался один раз
+    applyStyles();
+
     m_centralWidget = new QWidget(this);
+    m_centralWidget->setObjectName("centralWidget");
     setCentralWidget(m_centralWidget);
 
     m_mainLayout = new QVBoxLayout(m_centralWidget);
@@ -29,12 +135,7 @@ void TaskManager::setupUI()
 
     // Заголовок
     auto *titleLabel = new QLabel("Интерактивный список задач", this);
-    titleLabel->setStyleSheet(
-        "font-size: 24px; "
-        "font-weight: bold; "
-        "color: #333; "
-        "margin-bottom: 10px;"
-        );
+    titleLabel->setObjectName("titleLabel");
     m_mainLayout->addWidget(titleLabel);
 
     // Панели управления
@@ -45,8 +146,7 @@ void TaskManager::setupUI()
     setupTaskList();
     m_mainLayout->addWidget(m_listView);
 
-    // Применяем стили
-    applyStyles();
+    setupStatusBar();
 }
 
 QHBoxLayout* TaskManager::createControlPanel()
@@ -56,19 +156,9 @@ QHBoxLayout* TaskManager::createControlPanel()
 
     // Поле ввода
     m_taskInput = new QLineEdit(this);
-    m_taskInput->setPlaceholderText("Введите название новой задачи...");
+    m_taskInput->setPlaceholderText("Введите название новой задачи или \"$ команда\"...");
     m_taskInput->setMinimumHeight(INPUT_HEIGHT);
-    m_taskInput->setStyleSheet(
-        "QLineEdit {"
-        "    border: 2px solid #ddd;"
-        "    border-radius: 20px;"
-        "    padding: 5px 15px;"
-        "    font-size: 13px;"
-        "}"
-        "QLineEdit:focus {"
-        "    border: 2px solid #4CAF50;"
-        "}"
-        );
+    m_taskInput->setObjectName("taskInput");
     connect(m_taskInput, &QLineEdit::returnPressed, this, &TaskManager::addTask);
     controlLayout->addWidget(m_taskInput, 3);
 
@@ -76,19 +166,7 @@ QHBoxLayout* TaskManager::createControlPanel()
     m_addButton = new QPushButton("Добавить задачу", this);
     m_addButton->setMinimumSize(ADD_BUTTON_WIDTH, BUTTON_HEIGHT);
     m_addButton->setFocusPolicy(Qt::NoFocus);
-    m_addButton->setStyleSheet(
-        "QPushButton {"
-        "    background-color: #2196F3;"
-        "    color: white;"
-        "    border: none;"
-        "    border-radius: 20px;"
-        "    font-weight: bold;"
-        "    font-size: 13px;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: #0b7dda;"
-        "}"
-        );
+    m_addButton->setObjectName("addButton");
     connect(m_addButton, &QPushButton::clicked, this, &TaskManager::addTask);
     controlLayout->addWidget(m_addButton);
 
@@ -96,22 +174,19 @@ QHBoxLayout* TaskManager::createControlPanel()
     m_deleteButton = new QPushButton("Удалить выбранные", this);
     m_deleteButton->setMinimumSize(DELETE_BUTTON_WIDTH, BUTTON_HEIGHT);
     m_deleteButton->setFocusPolicy(Qt::NoFocus);
-    m_deleteButton->setStyleSheet(
-        "QPushButton {"
-        "    background-color: #f44336;"
-        "    color: white;"
-        "    border: none;"
-        "    border-radius: 20px;"
-        "    font-weight: bold;"
-        "    font-size: 13px;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: #da190b;"
-        "}"
-        );
+    m_deleteButton->setObjectName("deleteButton");
     connect(m_deleteButton, &QPushButton::clicked, this, &TaskManager::deleteSelectedTasks);
     controlLayout->addWidget(m_deleteButton);
 
+    // Кнопка импорта
+    m_importButton = new QPushButton("Импорт...", this);
+    m_importButton->setMinimumSize(IMPORT_BUTTON_WIDTH, BUTTON_HEIGHT);
+    m_importButton->setFocusPolicy(Qt::NoFocus);
+    m_importButton->setToolTip("Загрузить задачи из файла CSV или NDJSON");
+    m_importButton->setObjectName("importButton");
+    connect(m_importButton, &QPushButton::clicked, this, &TaskManager::importTasks);
+    controlLayout->addWidget(m_importButton);
+
     return controlLayout;
 }
 
@@ -120,52 +195,77 @@ QHBoxLayout* TaskManager::createFilterPanel()
     auto *filterLayout = new QHBoxLayout();
 
     auto *filterLabel = new QLabel("Фильтр:", this);
-    filterLabel->setStyleSheet("font-weight: bold; font-size: 13px;");
+    filterLabel->setObjectName("filterLabel");
     filterLayout->addWidget(filterLabel);
 
     m_filterCombo = new QComboBox(this);
     m_filterCombo->addItems({"Все задачи", "Активные", "Неактивные"});
     m_filterCombo->setMinimumHeight(FILTER_COMBO_HEIGHT);
     m_filterCombo->setFocusPolicy(Qt::StrongFocus);
-    m_filterCombo->setStyleSheet(
-        "QComboBox {"
-        "    border: 1px solid #ddd;"
-        "    border-radius: 8px;"
-        "    padding: 5px 15px;"
-        "    background-color: white;"
-        "    font-size: 13px;"
-        "}"
-        "QComboBox:focus {"
-        "    border: 1px solid #2196F3;"
-        "}"
-        "QComboBox::drop-down {"
-        "    border: none;"
-        "}"
-        "QComboBox QAbstractItemView {"
-        "    outline: none;"
-        "    border: 1px solid #ddd;"
-        "    border-radius: 8px;"
-        "    background-color: white;"
-        "    selection-background-color: #E3F2FD;"
-        "    selection-color: #1976D2;"
-        "    padding: 4px;"
-        "}"
-        "QComboBox QAbstractItemView::item {"
-        "    border-radius: 6px;"
-        "}"
-        "QComboBox QAbstractItemView::item:hover {"
-        "    background-color: #F5F5F5;"
-        "}"
-        "QComboBox QAbstractItemView::item:selected {"
-        "    background-color: #E3F2FD;"
-        "    color: #1976D2;"
-        "}"
-        );
+    m_filterCombo->setObjectName("filterCombo");
     connect(m_filterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &TaskManager::onFilterChanged);
     filterLayout->addWidget(m_filterCombo);
+    filterLayout->addSpacing(20);
+
+    auto *sortLabel = new QLabel("Сортировка:", this);
+    sortLabel->setObjectName("sortLabel");
+    filterLayout->addWidget(sortLabel);
+
+    // Порядок пунктов соответствует TaskProxyModel::SortMode
+    m_sortCombo = new QComboBox(this);
+    m_sortCombo->addItems({"По дате", "По времени до завершения"});
+    m_sortCombo->setMinimumHeight(FILTER_COMBO_HEIGHT);
+    m_sortCombo->setFocusPolicy(Qt::StrongFocus);
+    m_sortCombo->setObjectName("sortCombo");
+    connect(m_sortCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &TaskManager::onSortChanged);
+    filterLayout->addWidget(m_sortCombo);
+    filterLayout->addSpacing(20);
+
+    m_groupsCheck = new QCheckBox("Группы", this);
+    m_groupsCheck->setToolTip("Группировать задачи по частям названия через \"/\"");
+    m_groupsCheck->setFocusPolicy(Qt::NoFocus);
+    m_groupsCheck->setObjectName("groupsCheck");
+    connect(m_groupsCheck, &QCheckBox::toggled, this, &TaskManager::setGroupsShown);
+    filterLayout->addWidget(m_groupsCheck);
     filterLayout->addStretch();
 
+    // Действия над выделением; "Выбрать все" выделяет строки текущего фильтра
+    m_selectAllButton = new QPushButton("Выбрать все", this);
+    m_selectAllButton->setMinimumSize(SELECTION_BUTTON_WIDTH, FILTER_COMBO_HEIGHT);
+    m_selectAllButton->setFocusPolicy(Qt::NoFocus);
+    m_selectAllButton->setToolTip("Выделить все задачи, проходящие текущий фильтр (Ctrl+A)");
+    m_selectAllButton->setObjectName("selectAllButton");
+    connect(m_selectAllButton, &QPushButton::clicked, this, &TaskManager::selectAllMatching);
+    filterLayout->addWidget(m_selectAllButton);
+
+    m_startSelectedButton = new QPushButton("Запустить", this);
+    m_startSelectedButton->setMinimumSize(SELECTION_BUTTON_WIDTH, FILTER_COMBO_HEIGHT);
+    m_startSelectedButton->setFocusPolicy(Qt::NoFocus);
+    m_startSelectedButton->setToolTip("Запустить выбранные задачи, а без выделения - все задачи фильтра");
+    m_startSelectedButton->setObjectName("startSelectedButton");
+    connect(m_startSelectedButton, &QPushButton::clicked, this, &TaskManager::startSelectedTasks);
+    filterLayout->addWidget(m_startSelectedButton);
+
+    m_stopSelectedButton = new QPushButton("Остановить", this);
+    m_stopSelectedButton->setMinimumSize(SELECTION_BUTTON_WIDTH, FILTER_COMBO_HEIGHT);
+    m_stopSelectedButton->setFocusPolicy(Qt::NoFocus);
+    m_stopSelectedButton->setToolTip("Остановить выбранные задачи, а без выделения - все задачи фильтра");
+    m_stopSelectedButton->setObjectName("stopSelectedButton");
+    connect(m_stopSelectedButton, &QPushButton::clicked, this, &TaskManager::stopSelectedTasks);
+    filterLayout->addWidget(m_stopSelectedButton);
+
+    m_staggerSpin = new QSpinBox(this);
+    m_staggerSpin->setRange(0, MAX_STAGGER_WINDOW);
+    m_staggerSpin->setValue(DEFAULT_STAGGER_WINDOW);
+    m_staggerSpin->setPrefix("Разнос: ");
+    m_staggerSpin->setSuffix(" с");
+    m_staggerSpin->setMinimumHeight(FILTER_COMBO_HEIGHT);
+    m_staggerSpin->setToolTip("Окно, по которому разносятся запуски задач кнопкой \"Запустить\" (0 - сразу)");
+    m_staggerSpin->setObjectName("staggerSpin");
+    filterLayout->addWidget(m_staggerSpin);
+
     return filterLayout;
 }
 
@@ -177,50 +277,58 @@ void TaskManager::setupTaskList()
     m_listView->setSelectionMode(QAbstractItemView::MultiSelection);
     m_listView->setFocusPolicy(Qt::NoFocus);
     m_listView->setMouseTracking(true);
-    m_listView->setStyleSheet(
-        "QListView {"
-        "    background-color: #f0f0f0;"
-        "    border: none;"
-        "    border-radius: 15px;"
-        "    outline: none;"
-        "}"
-        "QListView::item {"
-        "    border: none;"
-        "    background: transparent;"
-        "}"
-        "QListView::item:hover {"
-        "    background: transparent;"
-        "}"
-        // Скроллбар
-        "QScrollBar:vertical {"
-        "    border: none;"
-        "    background: #f0f0f0;"
-        "    width: 8px;"
-        "    margin: 0px;"
-        "    border-radius: 4px;"
-        "}"
-        "QScrollBar::handle:vertical {"
-        "    background: #bbb;"
-        "    min-height: 20px;"
-        "    border-radius: 4px;"
-        "}"
-        "QScrollBar::handle:vertical:hover {"
-        "    background: #999;"
-        "}"
-        "QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {"
-        "    height: 0px;"
-        "}"
-        );
+    m_listView->setObjectName("taskList");
+
+    // Видимые строки пересчитываются один раз за итерацию цикла событий
+    m_viewportTimer = new QTimer(this);
+    m_viewportTimer->setSingleShot(true);
+    m_viewportTimer->setInterval(0);
+    connect(m_viewportTimer, &QTimer::timeout, this, &TaskManager::updateViewportRows);
+
+    const auto scheduleViewportUpdate = [this]() { m_viewportTimer->start(); };
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        // При прокрутке по строкам значение полосы - первая видимая строка
+        WorkloadTrace::record(WorkloadTrace::Scroll, value);
+        m_viewportTimer->start();
+    });
+    connect(m_proxyModel, &QAbstractItemModel::rowsInserted, this, scheduleViewportUpdate);
+    connect(m_proxyModel, &QAbstractItemModel::rowsRemoved, this, scheduleViewportUpdate);
+    connect(m_proxyModel, &QAbstractItemModel::layoutChanged, this, scheduleViewportUpdate);
+    connect(m_proxyModel, &QAbstractItemModel::modelReset, this, scheduleViewportUpdate);
+    m_listView->viewport()->installEventFilter(this);
+}
+
+void TaskManager::setupStatusBar()
+{
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setObjectName("statusLabel");
+    statusBar()->addWidget(m_statusLabel, 1);
+    statusBar()->setSizeGripEnabled(false);
+}
+
+QProgressBar *TaskManager::createStatusProgress(const QString &format)
+{
+    auto *progress = new QProgressBar(this);
+    progress->setMaximumWidth(200);
+    progress->setFormat(format);
+    progress->hide();
+    statusBar()->addPermanentWidget(progress);
+    return progress;
 }
 
 void TaskManager::applyStyles()
 {
-    m_centralWidget->setStyleSheet("background-color: #fafafa;");
+    AppStyle::apply();
 }
 
 void TaskManager::addTask()
 {
-    const QString taskName = m_taskInput->text().trimmed();
+    QString taskName = m_taskInput->text().trimmed();
+
+    // Строка с префиксом "$ " - команда внешнего процесса
+    const bool isCommand = taskName.startsWith(QLatin1String(COMMAND_PREFIX));
+    if (isCommand)
+        taskName = taskName.mid(int(sizeof(COMMAND_PREFIX)) - 1).trimmed();
 
     if (taskName.isEmpty())
     {
@@ -234,32 +342,74 @@ void TaskManager::addTask()
         return;
     }
 
-    m_model->addTask(taskName);
+    if (isCommand)
+        m_model->addProcessTask(taskName);
+    else
+        m_model->addTask(taskName);
     m_taskInput->clear();
 }
 
-void TaskManager::deleteSelectedTasks()
+RowRanges TaskManager::selectedSourceRanges() const
+{
+    if (!m_treeView)
+        return m_proxyModel->mapSelectionToSourceRanges(m_listView->selectionModel()->selection());
+
+    // Выбранная группа означает все её задачи
+    QList<int> rows;
+    for (const QItemSelectionRange &range : m_treeView->selectionModel()->selection())
+    {
+        for (int row = range.top(); row <= range.bottom(); ++row)
+            rows.append(m_treeModel->sourceRows(m_treeModel->index(row, 0, range.parent())));
+    }
+    return RowRanges::fromRows(std::move(rows));
+}
+
+void TaskManager::selectAllMatching()
+{
+    // Одно выделение на все строки вместо отдельного диапазона на каждую строку
+    QAbstractItemView *view = m_treeView ? static_cast<QAbstractItemView*>(m_treeView) : m_listView;
+    QAbstractItemModel *model = view->model();
+    if (model->rowCount() == 0)
+        return;
+
+    view->selectionModel()->select(QItemSelection(model->index(0, 0), model->index(model->rowCount() - 1, 0)),
+                                   QItemSelectionModel::ClearAndSelect);
+}
+
+RowRanges TaskManager::commandSourceRanges() const
 {
-    // Получаем выбранные индексы из представления
-    const auto selectedIndexes = m_listView->selectionModel()->selectedIndexes();
+    RowRanges ranges = selectedSourceRanges();
+    return ranges.isEmpty() ? m_proxyModel->matchingSourceRanges() : ranges;
+}
+
+void TaskManager::startSelectedTasks()
+{
+    m_model->startTasksStaggered(commandSourceRanges(), m_staggerSpin->value() * 1000);
+}
 
-    if (selectedIndexes.isEmpty())
+void TaskManager::stopSelectedTasks()
+{
+    m_model->stopTaskRanges(commandSourceRanges());
+}
+
+void TaskManager::deleteSelectedTasks()
+{
+    // Выделение обрабатывается диапазонами строк исходной модели
+    const RowRanges ranges = selectedSourceRanges();
+    if (ranges.isEmpty())
         return;
 
     // Проверяем наличие активных задач среди выбранных
-    QList<int> sourceRows;
     bool hasActive = false;
-
-    for (const auto &proxyIndex : selectedIndexes)
+    for (const RowRanges::Range &range : ranges)
     {
-        const QModelIndex sourceIndex = m_proxyModel->mapToSource(proxyIndex);
-        sourceRows.append(sourceIndex.row());
-
-        if (!hasActive)
+        // Строки холодного хранилища и архива не выполняются, getTask() для них пуст
+        for (int row = range.first; row <= range.last && !hasActive; ++row)
         {
-            Task *task = m_model->getTask(sourceIndex.row());
-            if (task && task->isRunning())
-                hasActive = true;
+            const Task *task = m_model->getTask(row);
+            if (!task)
+                break;
+            hasActive = task->isRunning();
         }
     }
 
@@ -277,30 +427,411 @@ void TaskManager::deleteSelectedTasks()
             return;
     }
 
-    // Удаляем задачи (начиная с конца, чтобы не сбивать индексы)
-    std::sort(sourceRows.begin(), sourceRows.end(), std::greater<int>());
-    for (int row : sourceRows)
+    // Строки скрываются сразу, задачи освобождаются порциями
+    m_model->removeTaskRanges(ranges);
+}
+
+void TaskManager::onRemovalProgress(int released, int total)
+{
+    if (released >= total)
     {
-        m_model->removeTask(row);
+        if (m_removalProgress)
+            m_removalProgress->hide();
+        return;
     }
+
+    if (!m_removalProgress)
+        m_removalProgress = createStatusProgress("Удаление: %p%");
+
+    m_removalProgress->setRange(0, total);
+    m_removalProgress->setValue(released);
+    m_removalProgress->show();
+}
+
+void TaskManager::importTasks()
+{
+    if (m_importer->isRunning())
+    {
+        m_importer->cancel();
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Импорт задач", QString(),
+        "Списки задач (*.csv *.ndjson *.jsonl *.json);;Все файлы (*)");
+    if (path.isEmpty())
+        return;
+
+    if (m_importer->start(path, m_model->nameIndex()))
+    {
+        m_importButton->setText("Отменить");
+        if (!m_importProgress)
+        {
+            m_importProgress = createStatusProgress("Импорт: %p%");
+            m_importProgress->setRange(0, 1000);
+        }
+        m_importProgress->setValue(0);
+        m_importProgress->show();
+    }
+}
+
+void TaskManager::onImportBatch(const QStringList &names)
+{
+    m_model->addTasks(names);
+    m_importer->batchConsumed();
+}
+
+void TaskManager::onImportProgress(qint64 bytes, qint64 total)
+{
+    if (total > 0 && m_importProgress)
+        m_importProgress->setValue(static_cast<int>(bytes * 1000 / total));
+}
+
+void TaskManager::onImportFinished(const TaskImporter::Result &result)
+{
+    m_importButton->setText("Импорт...");
+    if (m_importProgress)
+        m_importProgress->hide();
+
+    if (!result.error.isEmpty())
+    {
+        QMessageBox::warning(this, "Ошибка", "Не удалось импортировать файл: " + result.error);
+        return;
+    }
+
+    statusBar()->showMessage(
+        QString("%1: добавлено %2, дубликатов %3, некорректных строк %4")
+            .arg(result.cancelled ? "Импорт отменён" : "Импорт завершён")
+            .arg(result.imported)
+            .arg(result.duplicates)
+            .arg(result.invalid),
+        IMPORT_MESSAGE_TIMEOUT);
 }
 
 void TaskManager::onFilterChanged(int index)
 {
+    WorkloadTrace::record(WorkloadTrace::Filter, index);
     m_proxyModel->setFilterType(static_cast<TaskProxyModel::FilterType>(index));
 }
 
-void TaskManager::onStartStopClicked(const QModelIndex &proxyIndex)
+void TaskManager::onSortChanged(int index)
+{
+    WorkloadTrace::record(WorkloadTrace::Sort, index);
+    m_proxyModel->setSortMode(static_cast<TaskProxyModel::SortMode>(index));
+}
+
+void TaskManager::setGroupsShown(bool shown)
+{
+    if (shown && !m_treeView)
+    {
+        m_treeModel = new TaskTreeModel(m_model, this);
+        m_treeView = new QTreeView(this);
+        m_treeView->setModel(m_treeModel);
+        m_treeView->setItemDelegate(m_delegate);
+        m_treeView->setHeaderHidden(true);
+        m_treeView->setUniformRowHeights(true);
+        m_treeView->setSelectionMode(QAbstractItemView::MultiSelection);
+        m_treeView->setFocusPolicy(Qt::NoFocus);
+        m_treeView->setMouseTracking(true);
+        m_treeView->setObjectName("taskTree");
+
+        const auto scheduleViewportUpdate = [this]() { m_viewportTimer->start(); };
+        connect(m_treeView->verticalScrollBar(), &QScrollBar::valueChanged, this, scheduleViewportUpdate);
+        connect(m_treeView, &QTreeView::expanded, this, scheduleViewportUpdate);
+        connect(m_treeView, &QTreeView::collapsed, this, scheduleViewportUpdate);
+        m_treeView->viewport()->installEventFilter(this);
+        m_mainLayout->insertWidget(m_mainLayout->indexOf(m_listView) + 1, m_treeView);
+    }
+    else if (!shown && m_treeView)
+    {
+        delete m_treeView;
+        delete m_treeModel;
+        m_treeView = nullptr;
+        m_treeModel = nullptr;
+    }
+
+    m_listView->setVisible(!shown);
+    m_filterCombo->setEnabled(!shown);
+    m_sortCombo->setEnabled(!shown);
+    m_viewportTimer->start();
+}
+
+void TaskManager::onStartStopClicked(const QModelIndex &index)
 {
-    // Преобразуем индекс прокси в индекс исходной модели
-    const QModelIndex sourceIndex = m_proxyModel->mapToSource(proxyIndex);
-    Task *task = m_model->getTask(sourceIndex.row());
+    if (m_treeModel && index.model() == m_treeModel)
+    {
+        if (m_treeModel->isGroup(index))
+        {
+            if (index.data(TaskTreeModel::RunningCountRole).toInt() > 0)
+                m_treeModel->stopGroup(index);
+            else
+                m_treeModel->startGroup(index);
+            return;
+        }
+    }
+
+    // Преобразуем индекс прокси или дерева в строку исходной модели
+    const int row = m_treeModel && index.model() == m_treeModel
+        ? m_treeModel->sourceRow(index)
+        : m_proxyModel->mapToSource(index).row();
+    Task *task = m_model->getTask(row);
 
     if (!task)
         return;
 
+    // Через модель, чтобы операция попала в трассу WorkloadTrace
     if (task->isRunning())
-        task->stop();
+        m_model->stopTasks({row});
     else if (task->getProgress() < Task::MAX_PROGRESS)
-        task->start();
+        m_model->startTasks({row});
+}
+
+void TaskManager::onStatisticsChanged(const TaskStatistics &statistics)
+{
+    QString summary =
+        QString("Всего: %1   Выполняется: %2   Остановлено: %3   Завершено: %4   Средний прогресс: %5%")
+            .arg(statistics.total)
+            .arg(statistics.running)
+            .arg(statistics.stopped)
+            .arg(statistics.completed)
+            .arg(statistics.averageProgress());
+
+    if (statistics.estimatedCompletionMs >= 0)
+    {
+        const qint64 seconds = (statistics.estimatedCompletionMs + 999) / 1000;
+        summary += QString("   Все завершатся через: %1:%2")
+                       .arg(seconds / 60)
+                       .arg(seconds % 60, 2, 10, QChar('0'));
+    }
+    m_statusLabel->setText(summary);
+
+    // Счётчики в пунктах фильтра (порядок соответствует TaskProxyModel::FilterType)
+    m_filterCombo->setItemText(TaskProxyModel::All,
+                               QString("Все задачи (%1)").arg(statistics.total));
+    m_filterCombo->setItemText(TaskProxyModel::Active,
+                               QString("Активные (%1)").arg(statistics.running));
+    m_filterCombo->setItemText(TaskProxyModel::Inactive,
+                               QString("Неактивные (%1)").arg(statistics.inactive()));
+
+    const TaskPool::Statistics pool = m_model->poolStatistics();
+    m_statusLabel->setToolTip(
+        QString("Пул задач: выдано %1, создано %2, повторно %3, свободно %4")
+            .arg(pool.acquired)
+            .arg(pool.constructed)
+            .arg(pool.reused)
+            .arg(pool.free));
+}
+
+void TaskManager::updateViewportRows()
+{
+    QList<int> rows;
+    if (m_treeView)
+    {
+        // Видимые строки дерева - от верхней вниз по развёрнутым группам
+        const int height = m_treeView->viewport()->height();
+        for (QModelIndex index = m_treeView->indexAt(QPoint(m_treeView->viewport()->width() / 2, 0));
+             index.isValid() && m_treeView->visualRect(index).top() < height;
+             index = m_treeView->indexBelow(index))
+        {
+            const int row = m_treeModel->sourceRow(index);
+            if (row >= 0)
+                rows.append(row);
+        }
+        m_model->setViewportRows(rows);
+        return;
+    }
+
+    const int rowCount = m_proxyModel->rowCount();
+    const QModelIndex first = m_listView->indexAt(QPoint(0, 0));
+    if (first.isValid())
+    {
+        const QModelIndex last = m_listView->indexAt(QPoint(0, m_listView->viewport()->height() - 1));
+        const int lastRow = last.isValid() ? last.row() : rowCount - 1;
+
+        rows.reserve(lastRow - first.row() + 1);
+        for (int row = first.row(); row <= lastRow; ++row)
+            rows.append(m_proxyModel->mapToSource(m_proxyModel->index(row, 0)).row());
+    }
+    m_model->setViewportRows(rows);
+}
+
+void TaskManager::updateVisibility()
+{
+    const QWindow *window = windowHandle();
+    const bool hidden = !isVisible() || isMinimized() || (window && !window->isExposed());
+    m_model->setNotificationsSuspended(hidden);
+}
+
+bool TaskManager::eventFilter(QObject *watched, QEvent *event)
+{
+    if ((watched == m_listView->viewport() || (m_treeView && watched == m_treeView->viewport()))
+        && event->type() == QEvent::Resize)
+        m_viewportTimer->start();
+    else if (watched == m_listView->viewport() && event->type() == QEvent::Paint && !m_firstFrameShown)
+    {
+        // Всё, что не нужно для первого кадра, выполняется после него
+        m_firstFrameShown = true;
+        QTimer::singleShot(0, this, &TaskManager::restoreSession);
+    }
+    else if (watched == windowHandle() && event->type() == QEvent::Expose)
+        QTimer::singleShot(0, this, &TaskManager::updateVisibility);
+
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void TaskManager::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange)
+        updateVisibility();
+}
+
+void TaskManager::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+
+    // Перекрытие окна другими окнами сообщается событиями Expose окна платформы
+    if (QWindow *window = windowHandle())
+        window->installEventFilter(this);
+    updateVisibility();
+}
+
+void TaskManager::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    updateVisibility();
+}
+
+void TaskManager::closeEvent(QCloseEvent *event)
+{
+    if (!m_sessionFile.isEmpty() && !m_sessionThread)
+    {
+        QDir().mkpath(QFileInfo(m_sessionFile).absolutePath());
+
+        // Не добавленные ещё задачи прежнего снимка сохраняются вместе с текущими
+        const QList<SessionSnapshot::Entry> pending = m_sessionEntries.mid(m_sessionCursor);
+        QString error;
+        if (!SessionSnapshot::save(m_sessionFile, *m_model, pending, &error))
+            qWarning("Не удалось сохранить снимок сессии: %s", qPrintable(error));
+    }
+    QMainWindow::closeEvent(event);
+}
+
+void TaskManager::restoreSession()
+{
+    emit firstFrameShown();
+
+    if (m_sessionFile.isEmpty())
+    {
+        emit sessionRestored(0);
+        return;
+    }
+
+    const QString path = m_sessionFile;
+    m_sessionThread = QThread::create([this, path]() {
+        QString error;
+        QList<SessionSnapshot::Entry> entries = SessionSnapshot::load(path, &error);
+        QMetaObject::invokeMethod(this, [this, entries, error]() {
+            m_sessionThread->wait();
+            m_sessionThread->deleteLater();
+            m_sessionThread = nullptr;
+
+            if (!error.isEmpty())
+                statusBar()->showMessage("Не удалось восстановить сессию: " + error, IMPORT_MESSAGE_TIMEOUT);
+            m_sessionEntries = entries;
+            m_sessionCursor = 0;
+            restoreSessionBatch();
+        }, Qt::QueuedConnection);
+    });
+    m_sessionThread->setParent(this);
+    m_sessionThread->start();
+}
+
+void TaskManager::restoreSessionBatch()
+{
+    const int count = qMin(SESSION_RESTORE_BATCH, static_cast<int>(m_sessionEntries.count()) - m_sessionCursor);
+    if (count > 0)
+    {
+        const QList<quint64> ids = m_model->restoreTasks(m_sessionEntries.mid(m_sessionCursor, count));
+        m_sessionRestored += static_cast<int>(ids.count()) - static_cast<int>(ids.count(0));
+        m_sessionCursor += count;
+    }
+
+    // Между порциями окно обрабатывает ввод пользователя
+    if (m_sessionCursor < m_sessionEntries.count())
+    {
+        QTimer::singleShot(0, this, &TaskManager::restoreSessionBatch);
+        return;
+    }
+
+    m_sessionEntries.clear();
+    m_sessionCursor = 0;
+    if (m_sessionRestored > 0)
+    {
+        statusBar()->showMessage(QString("Восстановлено задач: %1").arg(m_sessionRestored),
+                                 IMPORT_MESSAGE_TIMEOUT);
+    }
+    emit sessionRestored(m_sessionRestored);
+}
+
+void TaskManager::togglePerformanceOverlay()
+{
+    if (!m_performanceOverlay)
+    {
+        m_performanceOverlay = new PerformanceOverlay(m_centralWidget, m_listView->viewport());
+        m_performanceOverlay->show();
+        return;
+    }
+
+    m_performanceOverlay->setVisible(!m_performanceOverlay->isVisible());
+}
+
+bool TaskManager::replayWorkload(const QString &path, WorkloadReplayer::Speed speed)
+{
+    if (!m_replayer)
+    {
+        m_replayer = new WorkloadReplayer(m_model, m_proxyModel, this);
+        m_replayer->setView(m_listView);
+        connect(m_replayer, &WorkloadReplayer::operationReplayed,
+                this, &TaskManager::onOperationReplayed);
+        connect(m_replayer, &WorkloadReplayer::finished,
+                this, &TaskManager::onReplayFinished);
+    }
+
+    QString error;
+    if (!m_replayer->start(path, speed, &error))
+    {
+        statusBar()->showMessage("Не удалось воспроизвести трассу: " + error, IMPORT_MESSAGE_TIMEOUT);
+        return false;
+    }
+    return true;
+}
+
+void TaskManager::onOperationReplayed(WorkloadTrace::Operation operation, int value, int done, int total)
+{
+    // Прокси уже изменена воспроизведением - только обновляем выбранные пункты
+    if (operation == WorkloadTrace::Filter)
+    {
+        const QSignalBlocker blocker(m_filterCombo);
+        m_filterCombo->setCurrentIndex(value);
+    }
+    else if (operation == WorkloadTrace::Sort)
+    {
+        const QSignalBlocker blocker(m_sortCombo);
+        m_sortCombo->setCurrentIndex(value);
+    }
+
+    // Ход показывается с шагом в процент, чтобы не перерисовывать строку состояния на каждой операции
+    if (done % qMax(1, total / 100) == 0)
+        statusBar()->showMessage(QString("Воспроизведение: %1 из %2").arg(done).arg(total));
+}
+
+void TaskManager::onReplayFinished()
+{
+    const QStringList lines = WorkloadReplayer::formatReport(m_replayer->report());
+    statusBar()->showMessage("Воспроизведение завершено: " + lines.value(0), IMPORT_MESSAGE_TIMEOUT);
+
+    QTextStream out(stdout);
+    for (const QString &line : lines)
+        out << line << Qt::endl;
 }
@@ -6,12 +6,25 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QSpinBox>
 #include <QListView>
 #include <QMessageBox>
 #include <QLabel>
+#include <QProgressBar>
+#include <QStatusBar>
 #include "taskmodel.h"
 #include "taskproxymodel.h"
 #include "taskdelegate.h"
+#include "taskimporter.h"
+#include "workloadreplayer.h"
+
+class ControlServer;
+class QThread;
+class MetricsExporter;
+class PerformanceOverlay;
+class QTreeView;
+class TaskTreeModel;
 
 /**
  * @class TaskManager
@@ -48,12 +61,33 @@ class TaskManager : public QMainWindow
     /// Минимальная ширина кнопки удаления
     static constexpr int DELETE_BUTTON_WIDTH = 150;
 
+    /// Минимальная ширина кнопки импорта
+    static constexpr int IMPORT_BUTTON_WIDTH = 110;
+
+    /// Длительность показа итогов импорта в строке состояния (мс)
+    static constexpr int IMPORT_MESSAGE_TIMEOUT = 10000;
+
     /// Высота кнопок управления
     static constexpr int BUTTON_HEIGHT = 40;
 
     /// Высота комбобокса фильтра
     static constexpr int FILTER_COMBO_HEIGHT = 35;
 
+    /// Минимальная ширина кнопок действий над выделением
+    static constexpr int SELECTION_BUTTON_WIDTH = 110;
+
+    /// Окно разнесения массового запуска по умолчанию (с)
+    static constexpr int DEFAULT_STAGGER_WINDOW = 5;
+
+    /// Наибольшее окно разнесения массового запуска (с)
+    static constexpr int MAX_STAGGER_WINDOW = 600;
+
+    /// Количество задач снимка сессии, восстанавливаемых за одну итерацию цикла событий
+    static constexpr int SESSION_RESTORE_BATCH = 10000;
+
+    /// Префикс строки ввода, задающей команду внешнего процесса
+    static constexpr char COMMAND_PREFIX[] = "$ ";
+
 public:
     /**
      * @brief Конструктор главного окна
@@ -61,23 +95,166 @@ public:
      */
     explicit TaskManager(QWidget *parent = nullptr);
 
+    /**
+     * @brief Деструктор
+     *
+     * Дожидается потока чтения снимка сессии, если он ещё работает.
+     */
+    ~TaskManager() override;
+
+    /**
+     * @brief Запустить локальный сервер управления задачами
+     * @param name Имя локального сокета
+     * @return true если сервер принимает подключения
+     *
+     * Позволяет внешним процессам добавлять и управлять задачами
+     * через протокол ControlProtocol.
+     */
+    bool startControlServer(const QString &name);
+
+    /**
+     * @brief Включить публикацию показателей в формате Prometheus
+     * @param port Порт HTTP-сервера на localhost (-1 - не запускать)
+     * @param textFile Файл для textfile-коллектора (пустая строка - не записывать)
+     * @return true если все запрошенные способы публикации запущены
+     */
+    bool startMetricsExporter(int port, const QString &textFile);
+
+    /**
+     * @brief Включить режим вычисляемого прогресса для новых задач
+     * @param enabled true - прогресс вычисляется по времени выполнения
+     */
+    void setComputedProgress(bool enabled);
+
+    /**
+     * @brief Подключить архив завершённых задач
+     * @param path Путь к файлу архива
+     * @param memoryLimit Ограничение памяти кэша страниц архива (байт)
+     * @return true если архив открыт
+     */
+    bool openArchive(const QString &path, qint64 memoryLimit);
+
+    /**
+     * @brief Задать задержку переноса завершённых задач в компактное хранилище
+     * @param msecs Время после завершения задачи (мс); отрицательное значение
+     *              отключает перенос
+     */
+    void setColdStorageDelay(int msecs);
+
+    /**
+     * @brief Задать шаблон прогресса в выводе внешних процессов
+     * @param pattern Шаблон "префикс{}суффикс" (см. ProgressPattern)
+     */
+    void setProgressPattern(const QByteArray &pattern);
+
+    /**
+     * @brief Задать файл снимка сессии
+     * @param path Путь к файлу (пустая строка - не сохранять и не восстанавливать)
+     *
+     * Снимок читается в рабочем потоке после первой отрисовки списка и
+     * добавляется в модель порциями по SESSION_RESTORE_BATCH задач;
+     * при закрытии окна снимок перезаписывается.
+     */
+    void setSessionFile(const QString &path) { m_sessionFile = path; }
+
+    /**
+     * @brief Воспроизвести записанную трассу операций
+     * @param path Путь к файлу трассы WorkloadTrace
+     * @param speed Темп воспроизведения
+     * @return false если трассу не удалось прочитать
+     *
+     * Операции выполняются над задачами окна, фильтр, сортировка и
+     * прокрутка применяются к элементам управления окна. По завершении
+     * отчёт о времени операций выводится в стандартный поток вывода.
+     */
+    bool replayWorkload(const QString &path, WorkloadReplayer::Speed speed);
+
+signals:
+    /**
+     * @brief Сигнал о первой отрисовке списка задач
+     */
+    void firstFrameShown();
+
+    /**
+     * @brief Сигнал о завершении восстановления сессии
+     * @param restored Количество восстановленных задач
+     *
+     * Испускается и при отсутствии снимка: окно полностью готово к работе.
+     */
+    void sessionRestored(int restored);
+
+protected:
+    /**
+     * @brief Отследить изменение размера списка и видимость окна
+     * @param watched Отслеживаемый объект
+     * @param event Событие
+     * @return false - события не поглощаются
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+    /**
+     * @brief Приостановить уведомления модели при сворачивании окна
+     * @param event Событие изменения состояния
+     */
+    void changeEvent(QEvent *event) override;
+
+    /**
+     * @brief Возобновить уведомления модели при показе окна
+     * @param event Событие показа
+     */
+    void showEvent(QShowEvent *event) override;
+
+    /**
+     * @brief Приостановить уведомления модели при скрытии окна
+     * @param event Событие скрытия
+     */
+    void hideEvent(QHideEvent *event) override;
+
+    /**
+     * @brief Сохранить снимок сессии при закрытии окна
+     * @param event Событие закрытия
+     */
+    void closeEvent(QCloseEvent *event) override;
+
 private slots:
     /**
      * @brief Добавить новую задачу
      *
      * Считывает название из поля ввода, проверяет на пустоту и дубликаты,
      * затем добавляет задачу в модель. После успешного добавления очищает поле ввода.
+     * Строка вида "$ команда" добавляет задачу, выполняющую внешний процесс.
      */
     void addTask();
 
     /**
      * @brief Удалить выбранные задачи
      *
-     * Находит все задачи с установленным флагом выбора и удаляет их.
+     * Переводит выделение в диапазоны строк исходной модели и удаляет их.
      * Если среди выбранных есть активные задачи, запрашивает подтверждение.
+     * Строки скрываются сразу, а задачи освобождаются моделью асинхронно.
      */
     void deleteSelectedTasks();
 
+    /**
+     * @brief Выделить все задачи, проходящие текущий фильтр
+     *
+     * Выделение состоит из одного диапазона строк независимо от их числа.
+     */
+    void selectAllMatching();
+
+    /**
+     * @brief Запустить выбранные задачи или, без выделения, все задачи фильтра
+     *
+     * Запуски разносятся по окну из поля "Разнос" со случайным сдвигом,
+     * чтобы таймеры десятков тысяч задач не срабатывали одновременно.
+     */
+    void startSelectedTasks();
+
+    /**
+     * @brief Остановить выбранные задачи или, без выделения, все задачи фильтра
+     */
+    void stopSelectedTasks();
+
     /**
      * @brief Обработать изменение фильтра
      * @param index Индекс выбранного пункта в комбобоксе
@@ -86,15 +263,120 @@ private slots:
      */
     void onFilterChanged(int index);
 
+    /**
+     * @brief Обработать изменение режима сортировки
+     * @param index Индекс выбранного пункта в комбобоксе сортировки
+     */
+    void onSortChanged(int index);
+
+    /**
+     * @brief Показать задачи деревом групп или списком
+     * @param shown true - дерево TaskTreeModel, false - список
+     *
+     * Дерево и его модель создаются при включении и уничтожаются при
+     * выключении, чтобы скрытое дерево не следило за изменениями задач.
+     * Фильтр и сортировка относятся к списку и в режиме групп недоступны.
+     */
+    void setGroupsShown(bool shown);
+
     /**
      * @brief Обработать клик на кнопку "Старт/Стоп"
-     * @param index Индекс задачи в прокси-модели
+     * @param index Индекс задачи в прокси-модели или строки дерева групп
      *
-     * Преобразует индекс прокси в индекс исходной модели и
-     * запускает или останавливает соответствующую задачу.
+     * Преобразует индекс в строку исходной модели и запускает или
+     * останавливает соответствующую задачу. Для группы останавливает
+     * все её задачи, если какие-то выполняются, иначе запускает все.
      */
     void onStartStopClicked(const QModelIndex &index);
 
+    /**
+     * @brief Обновить сводку по задачам
+     * @param statistics Актуальная статистика модели
+     *
+     * Обновляет строку состояния и счётчики в пунктах комбобокса фильтра.
+     */
+    void onStatisticsChanged(const TaskStatistics &statistics);
+
+    /**
+     * @brief Отобразить ход асинхронного удаления задач
+     * @param released Количество освобождённых задач
+     * @param total Общее количество задач в очереди удаления
+     */
+    void onRemovalProgress(int released, int total);
+
+    /**
+     * @brief Импортировать задачи из файла
+     *
+     * Запрашивает файл CSV или NDJSON и запускает потоковый импорт.
+     * Повторное нажатие во время импорта отменяет его.
+     */
+    void importTasks();
+
+    /**
+     * @brief Добавить в модель пакет импортированных задач
+     * @param names Проверенные уникальные названия
+     */
+    void onImportBatch(const QStringList &names);
+
+    /**
+     * @brief Отобразить ход импорта
+     * @param bytes Обработанный объём
+     * @param total Размер файла
+     */
+    void onImportProgress(qint64 bytes, qint64 total);
+
+    /**
+     * @brief Завершить импорт и показать итоги
+     * @param result Итоги импорта
+     */
+    void onImportFinished(const TaskImporter::Result &result);
+
+    /**
+     * @brief Показать или скрыть панель показателей производительности
+     *
+     * Панель создаётся при первом вызове (клавиша F12).
+     */
+    void togglePerformanceOverlay();
+
+    /**
+     * @brief Передать модели строки, видимые в списке
+     *
+     * Вызывается после прокрутки, изменения размера и структуры прокси.
+     */
+    void updateViewportRows();
+
+    /**
+     * @brief Приостановить или возобновить уведомления модели
+     *
+     * Уведомления приостанавливаются, пока окно скрыто, свёрнуто или
+     * полностью перекрыто.
+     */
+    void updateVisibility();
+
+    /**
+     * @brief Начать чтение снимка сессии после первой отрисовки
+     */
+    void restoreSession();
+
+    /**
+     * @brief Добавить в модель очередную порцию задач снимка
+     */
+    void restoreSessionBatch();
+
+    /**
+     * @brief Синхронизировать элементы управления с воспроизведённой операцией
+     * @param operation Тип операции
+     * @param value Значение операции представления
+     * @param done Выполнено операций
+     * @param total Всего операций в трассе
+     */
+    void onOperationReplayed(WorkloadTrace::Operation operation, int value, int done, int total);
+
+    /**
+     * @brief Показать и вывести отчёт о воспроизведении
+     */
+    void onReplayFinished();
+
 private:
     /**
      * @brief Настроить пользовательский интерфейс
@@ -123,25 +405,83 @@ private:
      */
     void setupTaskList();
 
+    /**
+     * @brief Настроить строку состояния
+     *
+     * Создаёт метку со сводкой по задачам в строке состояния окна.
+     */
+    void setupStatusBar();
+
     /**
      * @brief Применить стили к окну
      *
-     * Применяет CSS-подобные стили к виджетам приложения.
+     * Устанавливает единую таблицу стилей приложения AppStyle до создания
+     * виджетов; виджеты сопоставляются с ней по objectName.
      */
     void applyStyles();
 
+    /**
+     * @brief Получить выделение в строках исходной модели
+     * @return Диапазоны строк TaskModel; для групп дерева - строки всех их задач
+     *
+     * Выделение списка переводится TaskProxyModel::mapSelectionToSourceRanges()
+     * без построения списка выбранных индексов.
+     */
+    RowRanges selectedSourceRanges() const;
+
+    /**
+     * @brief Получить задачи, к которым применяются массовые команды
+     * @return Выделение, а если оно пусто - все строки текущего фильтра
+     */
+    RowRanges commandSourceRanges() const;
+
+    /**
+     * @brief Создать индикатор хода в строке состояния
+     * @param format Формат текста индикатора
+     * @return Скрытый индикатор
+     *
+     * Индикаторы создаются при первом использовании, а не при запуске.
+     */
+    QProgressBar *createStatusProgress(const QString &format);
+
     // Виджеты
     QWidget *m_centralWidget{nullptr};      ///< Центральный виджет
     QVBoxLayout *m_mainLayout{nullptr};     ///< Главный вертикальный layout
     QLineEdit *m_taskInput{nullptr};        ///< Поле ввода названия задачи
     QPushButton *m_addButton{nullptr};      ///< Кнопка добавления задачи
     QPushButton *m_deleteButton{nullptr};   ///< Кнопка удаления выбранных задач
+    QPushButton *m_importButton{nullptr};   ///< Кнопка импорта задач из файла
+    QPushButton *m_selectAllButton{nullptr}; ///< Кнопка выделения всех задач фильтра
+    QPushButton *m_startSelectedButton{nullptr}; ///< Кнопка запуска выбранных задач
+    QPushButton *m_stopSelectedButton{nullptr};  ///< Кнопка остановки выбранных задач
+    QSpinBox *m_staggerSpin{nullptr};       ///< Окно разнесения массового запуска (с)
     QComboBox *m_filterCombo{nullptr};      ///< Комбобокс выбора фильтра
+    QComboBox *m_sortCombo{nullptr};        ///< Комбобокс выбора сортировки
     QListView *m_listView{nullptr};         ///< Список задач
+    QCheckBox *m_groupsCheck{nullptr};      ///< Переключатель дерева групп
+    QTreeView *m_treeView{nullptr};         ///< Дерево групп (nullptr - показан список)
+    QLabel *m_statusLabel{nullptr};         ///< Сводка по задачам в строке состояния
+    QProgressBar *m_removalProgress{nullptr}; ///< Индикатор асинхронного удаления
+    QProgressBar *m_importProgress{nullptr};  ///< Индикатор импорта
 
     // Model/View/Delegate
     TaskModel *m_model{nullptr};            ///< Модель данных задач
     TaskProxyModel *m_proxyModel{nullptr}; ///< Прокси-модель для фильтрации и сортировки
+    TaskTreeModel *m_treeModel{nullptr};    ///< Модель дерева групп (nullptr - показан список)
     TaskDelegate *m_delegate{nullptr};      ///< Делегат для отрисовки задач
+    ControlServer *m_controlServer{nullptr}; ///< Локальный сервер управления
+    MetricsExporter *m_metricsExporter{nullptr}; ///< Публикация показателей
+    TaskImporter *m_importer{nullptr};      ///< Потоковый импорт задач
+    PerformanceOverlay *m_performanceOverlay{nullptr}; ///< Панель показателей производительности
+    WorkloadReplayer *m_replayer{nullptr};  ///< Воспроизведение трассы операций
+    QTimer *m_viewportTimer{nullptr};       ///< Таймер пересчёта видимых строк
+
+    // Снимок сессии
+    QString m_sessionFile;                  ///< Файл снимка сессии
+    bool m_firstFrameShown{false};          ///< Список задач уже отрисован
+    QThread *m_sessionThread{nullptr};      ///< Поток чтения снимка
+    QList<SessionSnapshot::Entry> m_sessionEntries{}; ///< Прочитанные, но ещё не добавленные задачи снимка
+    int m_sessionCursor{0};                 ///< Количество добавленных задач снимка
+    int m_sessionRestored{0};               ///< Количество восстановленных задач
 };
 
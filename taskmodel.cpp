@@ -1,21 +1,66 @@
 #include "taskmodel.h"
+#include "instrumentation.h"
+#include "monotonicclock.h"
+#include "taskeventlog.h"
+#include "workloadtrace.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <limits>
+#include <utility>
 
 TaskModel::TaskModel(QObject *parent)
     : QAbstractListModel(parent)
 {
+    m_statisticsTimer = new QTimer(this);
+    m_statisticsTimer->setSingleShot(true);
+    m_statisticsTimer->setInterval(STATISTICS_UPDATE_INTERVAL);
+    connect(m_statisticsTimer, &QTimer::timeout, this, [this]() {
+        m_statistics.estimatedCompletionMs = m_finishSchedule.empty()
+            ? -1
+            : qMax<qint64>(0, *m_finishSchedule.rbegin() - MonotonicClock::msecs());
+        emit statisticsChanged(m_statistics);
+    });
+
+    m_removalTimer = new QTimer(this);
+    m_removalTimer->setInterval(0);
+    connect(m_removalTimer, &QTimer::timeout, this, &TaskModel::processRemovalQueue);
+
+    m_deferredTimer = new QTimer(this);
+    m_deferredTimer->setSingleShot(true);
+    m_deferredTimer->setInterval(DEFERRED_UPDATE_INTERVAL);
+    connect(m_deferredTimer, &QTimer::timeout, this, &TaskModel::flushDeferredChanges);
+
+    m_scheduler = new TaskScheduler(this);
+
+    m_computedRefreshTimer = new QTimer(this);
+    m_computedRefreshTimer->setInterval(COMPUTED_PROGRESS_REFRESH_INTERVAL);
+    connect(m_computedRefreshTimer, &QTimer::timeout, this, &TaskModel::refreshComputedProgress);
+
+    m_coldTimer = new QTimer(this);
+    m_coldTimer->setSingleShot(true);
+    connect(m_coldTimer, &QTimer::timeout, this, &TaskModel::migrateCompletedTasks);
+
+    m_staggerTimer = new QTimer(this);
+    m_staggerTimer->setInterval(STAGGER_TICK_INTERVAL);
+    connect(m_staggerTimer, &QTimer::timeout, this, &TaskModel::processStaggeredStarts);
 }
 
 int TaskModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_tasks.count();
+    return m_tasks.count() + m_coldTasks.count() + m_archivedRows;
 }
 
 QVariant TaskModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_tasks.count())
+    if (!index.isValid() || index.row() >= rowCount())
         return QVariant();
+    if (index.row() >= m_tasks.count() + m_coldTasks.count())
+        return archivedData(index.row() - m_tasks.count() - m_coldTasks.count(), role);
+    if (index.row() >= m_tasks.count())
+        return coldData(index.row() - m_tasks.count(), role);
 
     Task *task = m_tasks.at(index.row());
 
@@ -31,8 +76,23 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
         return task->isRunning();
     case TaskPtrRole:
         return QVariant::fromValue(task);
+    case RateRole:
+        return task->getRate();
+    case EtaRole:
+        return task->getEtaMs();
+    case HistoryRole:
+        return QVariant::fromValue(task->history());
+    case ProgressStampRole:
+        return task->progressStamp();
+    case ArchivedRole:
+        return false;
     case Qt::DisplayRole:
         return task->getName();
+    case Qt::ToolTipRole:
+        // Хвост вывода процесса декодируется только при наведении
+        if (task->isProcess())
+            return QString::fromLocal8Bit(task->processOutput()).trimmed();
+        return QVariant();
     default:
         return QVariant();
     }
@@ -46,34 +106,798 @@ QHash<int, QByteArray> TaskModel::roleNames() const
     roles[ProgressRole] = "progress";
     roles[RunningRole] = "running";
     roles[TaskPtrRole] = "taskPtr";
+    roles[RateRole] = "rate";
+    roles[EtaRole] = "eta";
+    roles[HistoryRole] = "history";
+    roles[ProgressStampRole] = "progressStamp";
+    roles[ArchivedRole] = "archived";
     return roles;
 }
 
+bool TaskModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_archivedRows < m_archive.count();
+}
+
+void TaskModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    const int count = static_cast<int>(qMin<qint64>(ARCHIVE_FETCH_SIZE, m_archive.count() - m_archivedRows));
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    m_archivedRows += count;
+    endInsertRows();
+}
+
+bool TaskModel::openArchive(const QString &path)
+{
+    if (m_archivedRows > 0)
+    {
+        beginRemoveRows(QModelIndex(), m_tasks.count() + m_coldTasks.count(), rowCount() - 1);
+        m_archivedRows = 0;
+        endRemoveRows();
+    }
+    return m_archive.open(path);
+}
+
+QVariant TaskModel::archivedData(qint64 index, int role) const
+{
+    switch (role)
+    {
+    case ArchivedRole:
+        return true;
+    case RunningRole:
+        return false;
+    case TaskPtrRole:
+        return QVariant::fromValue<Task*>(nullptr);
+    case RateRole:
+        return 0.0;
+    case ProgressStampRole:
+        return qint64(0);
+    case HistoryRole:
+        return QVariant::fromValue(ProgressHistory());
+    case NameRole:
+    case DateRole:
+    case ProgressRole:
+    case EtaRole:
+    case Qt::DisplayRole:
+        break;
+    default:
+        return QVariant();
+    }
+
+    const TaskArchive::Record *record = m_archive.record(index);
+    if (!record)
+        return QVariant();
+
+    switch (role)
+    {
+    case DateRole:
+        return record->date;
+    case ProgressRole:
+        return record->progress;
+    case EtaRole:
+        return record->progress >= Task::MAX_PROGRESS ? qint64(0) : qint64(-1);
+    default:
+        return record->name;
+    }
+}
+
+QVariant TaskModel::coldData(int index, int role) const
+{
+    switch (role)
+    {
+    case NameRole:
+    case Qt::DisplayRole:
+        return m_coldTasks.name(index);
+    case DateRole:
+        return m_coldTasks.date(index);
+    case ProgressRole:
+        return Task::MAX_PROGRESS;
+    case RunningRole:
+    case ArchivedRole:
+        return false;
+    case TaskPtrRole:
+        return QVariant::fromValue<Task*>(nullptr);
+    case RateRole:
+        return 0.0;
+    case EtaRole:
+    case ProgressStampRole:
+        return qint64(0);
+    case HistoryRole:
+        return QVariant::fromValue(ProgressHistory());
+    default:
+        return QVariant();
+    }
+}
+
+void TaskModel::setColdStorageDelay(int msecs)
+{
+    m_coldStorageDelay = msecs;
+    if (msecs < 0)
+    {
+        m_coldTimer->stop();
+        m_coldQueue.clear();
+        return;
+    }
+    armColdTimer();
+}
+
+void TaskModel::scheduleColdMigration(const Task *task)
+{
+    if (m_coldStorageDelay < 0)
+        return;
+
+    // Задачи завершаются в порядке времени, поэтому очередь упорядочена по сроку
+    m_coldQueue.append({MonotonicClock::msecs(), task->getId()});
+    if (!m_coldTimer->isActive())
+        armColdTimer();
+}
+
+void TaskModel::armColdTimer()
+{
+    if (m_coldQueue.isEmpty() || m_coldStorageDelay < 0)
+        return;
+
+    const qint64 wait = m_coldQueue.first().first + m_coldStorageDelay - MonotonicClock::msecs();
+    m_coldTimer->start(static_cast<int>(qBound<qint64>(COLD_MIGRATION_INTERVAL, wait, std::numeric_limits<int>::max())));
+}
+
+int TaskModel::migrateCompletedTasks()
+{
+    DRW_SCOPED_TIMER(ModelUpdateSection);
+
+    // Отбираем задачи с истёкшей задержкой, которые всё ещё в модели и завершены
+    const qint64 now = MonotonicClock::msecs();
+    QList<Task*> migrated;
+    int due = 0;
+    while (due < m_coldQueue.count() && m_coldQueue.at(due).first + m_coldStorageDelay <= now)
+    {
+        Task *task = liveTask(m_coldQueue.at(due++).second);
+        if (task && !task->isRunning() && task->reportedProgress() >= Task::MAX_PROGRESS)
+            migrated.append(task);
+    }
+    m_coldQueue.erase(m_coldQueue.begin(), m_coldQueue.begin() + due);
+    armColdTimer();
+
+    if (migrated.isEmpty())
+        return 0;
+
+    std::sort(migrated.begin(), migrated.end(), [](const Task *left, const Task *right) {
+        return left->getId() < right->getId();
+    });
+
+    emit layoutAboutToBeChanged();
+
+    // Строки архива не сдвигаются: общее количество строк текущих задач и хранилища не меняется
+    const int archiveRow = m_tasks.count() + m_coldTasks.count();
+    const QModelIndexList persistent = persistentIndexList();
+    QList<quint64> persistentIds;
+    persistentIds.reserve(persistent.count());
+    for (const QModelIndex &index : persistent)
+    {
+        const int row = index.row();
+        if (row < m_tasks.count())
+            persistentIds.append(m_tasks.at(row)->getId());
+        else if (row < archiveRow)
+            persistentIds.append(m_coldTasks.id(row - m_tasks.count()));
+        else
+            persistentIds.append(0);
+    }
+
+    QList<ColdTaskStore::Entry> entries;
+    entries.reserve(migrated.count());
+    int firstRow = m_tasks.count();
+    for (Task *task : std::as_const(migrated))
+    {
+        entries.append({task->getId(), task->getName(), task->getDate()});
+        firstRow = qMin(firstRow, task->modelRow());
+        m_tasks[task->modelRow()] = nullptr;
+        m_tasksById.remove(task->getId());
+        m_viewportTaskIds.remove(task->getId());
+        task->setModelRow(-1);
+    }
+    m_tasks.removeAll(nullptr);
+    updateRows(firstRow);
+    m_coldTasks.insert(entries);
+
+    QModelIndexList updated;
+    updated.reserve(persistent.count());
+    for (int i = 0; i < persistent.count(); ++i)
+    {
+        const int row = persistentIds.at(i) != 0 ? rowOfTask(persistentIds.at(i)) : persistent.at(i).row();
+        updated.append(index(row));
+    }
+    changePersistentIndexList(persistent, updated);
+
+    emit layoutChanged();
+
+    // Задачи остаются учтёнными в статистике как завершённые
+    for (Task *task : std::as_const(migrated))
+        m_pool.release(task);
+
+    // Очередь планировщика не должна ссылаться на уничтожаемые задачи
+    m_scheduler->discardStale();
+    m_pool.trim(COLD_POOL_RESERVE);
+
+    return migrated.count();
+}
+
 void TaskModel::addTask(const QString &name)
 {
-    Task *task = new Task(name, this);
+    addTasks({name});
+}
 
-    // Подключаем сигналы для автообновления
-    connect(task, &Task::progressChanged, this, &TaskModel::onTaskDataChanged);
-    connect(task, &Task::dataChanged, this, &TaskModel::onTaskDataChanged);
+QList<quint64> TaskModel::addTasks(const QStringList &names)
+{
+    return insertTasks(names, {});
+}
+
+QList<quint64> TaskModel::restoreTasks(const QList<SessionSnapshot::Entry> &entries)
+{
+    QStringList names;
+    names.reserve(entries.count());
+    for (const SessionSnapshot::Entry &entry : entries)
+        names.append(entry.name);
+    return insertTasks(names, entries);
+}
+
+quint64 TaskModel::addProcessTask(const QString &command)
+{
+    const quint64 id = addTasks({command}).value(0);
+    if (Task *task = liveTask(id))
+        task->setCommand(command, m_progressPattern);
+    return id;
+}
+
+#ifdef DRW_COROUTINES
+quint64 TaskModel::addStagedTask(const QString &name, const StagedTask::Definition &definition)
+{
+    const quint64 id = addTasks({name}).value(0);
+    if (Task *task = liveTask(id))
+        task->setBody(std::make_shared<StagedTask>(task, m_scheduler, definition));
+    return id;
+}
+#endif
+
+QList<quint64> TaskModel::insertTasks(const QStringList &names, const QList<SessionSnapshot::Entry> &restored)
+{
+    QList<quint64> ids;
+    ids.reserve(names.count());
 
-    // Добавляем в конец списка
-    auto newRow = m_tasks.count();
-    beginInsertRows(QModelIndex(), newRow, newRow);
-    m_tasks.append(task);
+    QList<Task*> created;
+    created.reserve(names.count());
+
+    for (int i = 0; i < names.count(); ++i)
+    {
+        const QString &name = names.at(i);
+
+        // Пустые названия и дубликаты (в том числе внутри пакета) пропускаем
+        const QString key = name.toCaseFolded();
+        if (name.isEmpty() || m_nameIndex.contains(key))
+        {
+            ids.append(0);
+            continue;
+        }
+
+        Task *task = m_pool.acquire(name);
+        task->setId(++m_lastTaskId);
+        if (!restored.isEmpty())
+            task->restore(restored.at(i).date, restored.at(i).progress);
+        if (m_computedProgress)
+            task->setProgressScheduler(m_scheduler);
+
+        // Подключаем сигналы для автообновления
+        connect(task, &Task::dataChanged, this, &TaskModel::onTaskDataChanged);
+        connect(task, &Task::progressChanged, this, &TaskModel::onTaskProgressChanged);
+        connect(task, &Task::runningChanged, this, &TaskModel::onTaskRunningChanged);
+
+        m_nameIndex.insert(key);
+        ids.append(task->getId());
+        created.append(task);
+    }
+
+    if (created.isEmpty())
+        return ids;
+
+    // Добавляем в конец списка одним структурным изменением
+    const int firstRow = m_tasks.count();
+    beginInsertRows(QModelIndex(), firstRow, firstRow + created.count() - 1);
+    for (Task *task : created)
+    {
+        task->setModelRow(m_tasks.count());
+        m_tasksById.insert(task->getId(), task);
+        m_tasks.append(task);
+    }
     endInsertRows();
+
+    for (Task *task : created)
+    {
+        accountTask(task, +1);
+        TaskEventLog::record(TaskEventLog::Added, task->getId(), task->reportedProgress(), task->getName());
+        if (task->reportedProgress() >= Task::MAX_PROGRESS)
+            scheduleColdMigration(task);
+    }
+
+    if (WorkloadTrace::isActive())
+    {
+        QList<quint64> addedIds;
+        QStringList addedNames;
+        addedIds.reserve(created.count());
+        addedNames.reserve(created.count());
+        for (const Task *task : std::as_const(created))
+        {
+            addedIds.append(task->getId());
+            addedNames.append(task->getName());
+        }
+
+        // Восстановленные задачи записываются с состоянием из снимка
+        if (restored.isEmpty())
+        {
+            WorkloadTrace::recordAdd(addedIds, addedNames);
+        }
+        else
+        {
+            QList<qint64> datesMs;
+            QList<int> progress;
+            datesMs.reserve(created.count());
+            progress.reserve(created.count());
+            for (const Task *task : std::as_const(created))
+            {
+                datesMs.append(task->getDateMs());
+                progress.append(task->reportedProgress());
+            }
+            WorkloadTrace::recordRestore(addedIds, addedNames, datesMs, progress);
+        }
+    }
+
+    return ids;
 }
 
 void TaskModel::removeTask(int row)
 {
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Remove, taskIds({row}));
+
+    if (row >= m_tasks.count() && row < m_tasks.count() + m_coldTasks.count())
+    {
+        removeColdRows({row});
+        return;
+    }
     if (row < 0 || row >= m_tasks.count())
         return;
 
     beginRemoveRows(QModelIndex(), row, row);
     Task *task = m_tasks.takeAt(row);
+    updateRows(row);
     endRemoveRows();
 
-    delete task;
+    detachTask(task);
+    forgetTask(task);
+    task->halt();
+    m_pool.release(task);
+}
+
+void TaskModel::removeTasks(QList<int> rows)
+{
+    // Упорядочиваем строки, отбрасываем повторы и разбиваем на непрерывные диапазоны
+    removeTaskRanges(RowRanges::fromRows(std::move(rows)));
+}
+
+void TaskModel::removeTaskRanges(const RowRanges &ranges)
+{
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Remove, taskIds(ranges.toRows()));
+
+    // Строки хранилища следуют за текущими задачами - удаляем их первыми
+    removeColdRows(ranges.clipped(m_tasks.count(), m_tasks.count() + m_coldTasks.count() - 1).toRows());
+
+    const RowRanges live = ranges.clipped(0, m_tasks.count() - 1);
+    if (live.isEmpty())
+        return;
+
+    // Синхронно задачи только отсоединяются за O(1); таймеры, процессы и
+    // индексы освобождаются частями в processRemovalQueue()
+    for (const RowRanges::Range &range : live)
+    {
+        for (int row = range.first; row <= range.last; ++row)
+        {
+            Task *task = m_tasks.at(row);
+            detachTask(task);
+            m_removalQueue.append(task);
+        }
+    }
+
+    if (live.rangeCount() <= MAX_REMOVE_RANGES)
+    {
+        // Немного диапазонов - удаляем каждый с конца, сохраняя выделение и прокрутку
+        for (int i = live.rangeCount() - 1; i >= 0; --i)
+        {
+            beginRemoveRows(QModelIndex(), live.at(i).first, live.at(i).last);
+            m_tasks.erase(m_tasks.begin() + live.at(i).first, m_tasks.begin() + live.at(i).last + 1);
+            endRemoveRows();
+        }
+        updateRows(live.at(0).first);
+    }
+    else
+    {
+        // Разрозненное выделение - одно структурное изменение с уплотнением списка
+        beginResetModel();
+        for (const RowRanges::Range &range : live)
+        {
+            for (int row = range.first; row <= range.last; ++row)
+                m_tasks[row] = nullptr;
+        }
+        m_tasks.removeAll(nullptr);
+        updateRows(live.at(0).first);
+        endResetModel();
+    }
+
+    emit removalProgress(m_removalCursor, m_removalQueue.count());
+    m_removalTimer->start();
+}
+
+void TaskModel::removeColdRows(const QList<int> &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    QList<int> indices;
+    indices.reserve(rows.count());
+    for (int row : rows)
+    {
+        const int index = row - m_tasks.count();
+        const quint64 id = m_coldTasks.id(index);
+        TaskEventLog::record(TaskEventLog::Removed, id, Task::MAX_PROGRESS);
+        m_nameIndex.remove(m_coldTasks.name(index).toCaseFolded());
+        indices.append(index);
+    }
+
+    m_statistics.completed -= rows.count();
+    m_statistics.total -= rows.count();
+    m_statistics.progressSum -= qint64(rows.count()) * Task::MAX_PROGRESS;
+    m_statistics.histogram[Task::MAX_PROGRESS] -= rows.count();
+    scheduleStatisticsUpdate();
+
+    QList<QPair<int, int>> ranges;
+    for (int index : std::as_const(indices))
+    {
+        if (!ranges.isEmpty() && ranges.last().second + 1 == index)
+            ranges.last().second = index;
+        else
+            ranges.append({index, index});
+    }
+
+    if (ranges.count() <= MAX_REMOVE_RANGES)
+    {
+        for (auto it = ranges.crbegin(); it != ranges.crend(); ++it)
+        {
+            QList<int> range;
+            range.reserve(it->second - it->first + 1);
+            for (int index = it->first; index <= it->second; ++index)
+                range.append(index);
+
+            beginRemoveRows(QModelIndex(), m_tasks.count() + it->first, m_tasks.count() + it->second);
+            m_coldTasks.remove(range);
+            endRemoveRows();
+        }
+    }
+    else
+    {
+        beginResetModel();
+        m_coldTasks.remove(indices);
+        endResetModel();
+    }
+}
+
+void TaskModel::processRemovalQueue()
+{
+    QElapsedTimer budget;
+    budget.start();
+
+    const int total = m_removalQueue.count();
+    while (m_removalCursor < total)
+    {
+        Task *task = m_removalQueue.at(m_removalCursor++);
+        forgetTask(task);
+        task->halt();
+        m_pool.release(task);
+
+        if (m_removalCursor % REMOVAL_CHECK_STEP == 0 && budget.elapsed() >= REMOVAL_TIME_BUDGET)
+            break;
+    }
+
+    emit removalProgress(m_removalCursor, total);
+
+    if (m_removalCursor == total)
+    {
+        m_removalTimer->stop();
+        m_removalQueue.clear();
+        m_removalCursor = 0;
+    }
+}
+
+void TaskModel::startTasks(const QList<int> &rows)
+{
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Start, taskIds(rows));
+
+    beginBatchUpdate();
+    for (int row : rows)
+    {
+        if (Task *task = getTask(row))
+        {
+            m_staggeredIds.remove(task->getId());
+            task->start();
+            if (ticksSuspended())
+                task->suspendTicks();
+        }
+    }
+    endBatchUpdate();
+}
+
+void TaskModel::startTaskRanges(const RowRanges &ranges)
+{
+    const RowRanges live = ranges.clipped(0, m_tasks.count() - 1);
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Start, taskIds(live.toRows()));
+
+    beginBatchUpdate();
+    for (const RowRanges::Range &range : live)
+    {
+        for (int row = range.first; row <= range.last; ++row)
+        {
+            Task *task = m_tasks.at(row);
+            m_staggeredIds.remove(task->getId());
+            task->start();
+            if (ticksSuspended())
+                task->suspendTicks();
+        }
+    }
+    endBatchUpdate();
+}
+
+void TaskModel::startTasksStaggered(const RowRanges &ranges, int windowMs)
+{
+    if (windowMs <= 0)
+    {
+        startTaskRanges(ranges);
+        return;
+    }
+
+    // Запуск планируется только для задач, которые действительно запустятся
+    QList<quint64> ids;
+    for (const RowRanges::Range &range : ranges.clipped(0, m_tasks.count() - 1))
+    {
+        for (int row = range.first; row <= range.last; ++row)
+        {
+            const Task *task = m_tasks.at(row);
+            if (!task->isRunning() && task->getProgress() < Task::MAX_PROGRESS
+                && !m_staggeredIds.contains(task->getId()))
+                ids.append(task->getId());
+        }
+    }
+    if (ids.isEmpty())
+        return;
+
+    // Обработанная часть очереди больше не нужна
+    m_staggerQueue.erase(m_staggerQueue.begin(), m_staggerQueue.begin() + m_staggerCursor);
+    m_staggerCursor = 0;
+
+    // Окно делится на равные слоты, момент запуска случаен внутри слота
+    const qint64 now = MonotonicClock::msecs();
+    const double slot = static_cast<double>(windowMs) / ids.count();
+    QRandomGenerator *random = QRandomGenerator::global();
+    const auto middle = static_cast<std::ptrdiff_t>(m_staggerQueue.size());
+    m_staggerQueue.reserve(m_staggerQueue.size() + ids.count());
+    m_staggeredIds.reserve(m_staggeredIds.count() + ids.count());
+    for (int i = 0; i < ids.count(); ++i)
+    {
+        m_staggerQueue.emplace_back(now + static_cast<qint64>((i + random->generateDouble()) * slot), ids.at(i));
+        m_staggeredIds.insert(ids.at(i));
+    }
+    std::inplace_merge(m_staggerQueue.begin(), m_staggerQueue.begin() + middle, m_staggerQueue.end(),
+                       [](const QPair<qint64, quint64> &left, const QPair<qint64, quint64> &right) {
+                           return left.first < right.first;
+                       });
+
+    if (!m_staggerTimer->isActive())
+        m_staggerTimer->start();
+}
+
+void TaskModel::processStaggeredStarts()
+{
+    const qint64 now = MonotonicClock::msecs();
+    const int count = static_cast<int>(m_staggerQueue.size());
+
+    QList<quint64> started;
+    beginBatchUpdate();
+    while (m_staggerCursor < count && m_staggerQueue[m_staggerCursor].first <= now)
+    {
+        const quint64 id = m_staggerQueue[m_staggerCursor++].second;
+
+        // Запуск отменён остановкой или задача уже удалена
+        if (!m_staggeredIds.remove(id))
+            continue;
+        Task *task = liveTask(id);
+        if (!task)
+            continue;
+
+        task->start();
+        if (ticksSuspended())
+            task->suspendTicks();
+        started.append(id);
+    }
+    endBatchUpdate();
+
+    if (WorkloadTrace::isActive() && !started.isEmpty())
+        WorkloadTrace::record(WorkloadTrace::Start, started);
+
+    if (m_staggerCursor == count)
+    {
+        m_staggerQueue.clear();
+        m_staggerCursor = 0;
+        m_staggerTimer->stop();
+    }
+}
+
+void TaskModel::setNotificationsSuspended(bool suspended)
+{
+    if (m_notificationsSuspended == suspended)
+        return;
+
+    if (suspended)
+    {
+        m_notificationsSuspended = true;
+        m_deferredTimer->stop();
+        if (ticksSuspended())
+        {
+            for (Task *task : std::as_const(m_tasks))
+                task->suspendTicks();
+        }
+        return;
+    }
+
+    // Догоняем прогресс, пока уведомления ещё отключены, затем оповещаем разом
+    for (Task *task : std::as_const(m_tasks))
+        task->resumeTicks();
+    m_notificationsSuspended = false;
+    flushDeferredChanges();
+}
+
+void TaskModel::setProgressFeedActive(bool active)
+{
+    if (m_progressFeedActive == active)
+        return;
+
+    // Подписчикам нужны такты и при скрытом окне
+    m_progressFeedActive = active;
+    if (!m_notificationsSuspended)
+        return;
+    for (Task *task : std::as_const(m_tasks))
+    {
+        if (active)
+            task->resumeTicks();
+        else
+            task->suspendTicks();
+    }
+}
+
+void TaskModel::setComputedProgress(bool enabled)
+{
+    m_computedProgress = enabled;
+    if (enabled)
+        m_computedRefreshTimer->start();
+    else
+        m_computedRefreshTimer->stop();
+}
+
+void TaskModel::refreshComputedProgress()
+{
+    if (ticksSuspended())
+        return;
+
+    const auto refresh = [](Task *task) {
+        if (task->isRunning() && task->isProgressComputed())
+            task->syncProgress();
+    };
+
+    // Подписчикам нужен прогресс всех задач, а не только видимых
+    if (m_viewportTracking && !m_progressFeedActive)
+    {
+        // Копия: синхронизация может завершить задачу и изменить строки
+        const QSet<quint64> ids = m_viewportTaskIds;
+        for (quint64 id : ids)
+        {
+            if (Task *task = liveTask(id))
+                refresh(task);
+        }
+    }
+    else
+    {
+        for (int row = 0; row < m_tasks.count(); ++row)
+            refresh(m_tasks.at(row));
+    }
+}
+
+void TaskModel::setViewportRows(const QList<int> &rows)
+{
+    m_viewportTracking = true;
+    m_viewportTaskIds.clear();
+    m_viewportTaskIds.reserve(rows.count());
+    for (int row : rows)
+    {
+        if (const Task *task = getTask(row))
+            m_viewportTaskIds.insert(task->getId());
+    }
+}
+
+void TaskModel::stopTasks(const QList<int> &rows)
+{
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Stop, taskIds(rows));
+
+    beginBatchUpdate();
+    for (int row : rows)
+    {
+        if (Task *task = getTask(row))
+        {
+            m_staggeredIds.remove(task->getId());
+            task->stop();
+        }
+    }
+    endBatchUpdate();
+}
+
+void TaskModel::stopTaskRanges(const RowRanges &ranges)
+{
+    const RowRanges live = ranges.clipped(0, m_tasks.count() - 1);
+    if (WorkloadTrace::isActive())
+        WorkloadTrace::record(WorkloadTrace::Stop, taskIds(live.toRows()));
+
+    beginBatchUpdate();
+    for (const RowRanges::Range &range : live)
+    {
+        for (int row = range.first; row <= range.last; ++row)
+        {
+            Task *task = m_tasks.at(row);
+            m_staggeredIds.remove(task->getId());
+            task->stop();
+        }
+    }
+    endBatchUpdate();
+}
+
+int TaskModel::rowOfTask(quint64 id) const
+{
+    if (const Task *task = m_tasksById.value(id, nullptr))
+        return task->modelRow();
+
+    const int index = m_coldTasks.indexOf(id);
+    return index != -1 ? m_tasks.count() + index : -1;
+}
+
+quint64 TaskModel::taskId(int row) const
+{
+    if (row >= 0 && row < m_tasks.count())
+        return m_tasks.at(row)->getId();
+    if (row >= m_tasks.count() && row < m_tasks.count() + m_coldTasks.count())
+        return m_coldTasks.id(row - m_tasks.count());
+    return 0;
+}
+
+QList<quint64> TaskModel::taskIds(const QList<int> &rows) const
+{
+    QList<quint64> ids;
+    ids.reserve(rows.count());
+    for (int row : rows)
+    {
+        if (const quint64 id = taskId(row))
+            ids.append(id);
+    }
+    return ids;
 }
 
 Task* TaskModel::getTask(int row) const
@@ -83,26 +907,310 @@ Task* TaskModel::getTask(int row) const
     return m_tasks.at(row);
 }
 
-bool TaskModel::hasTaskWithName(const QString &name) const
+void TaskModel::fillRunningBitmap(int first, int last, quint64 *words) const
+{
+    last = qMin(last, static_cast<int>(m_tasks.count()));
+    for (int row = first; row < last; ++row)
+    {
+        if (m_tasks.at(row)->isRunning())
+            words[(row - first) / 64] |= quint64(1) << ((row - first) % 64);
+    }
+}
+
+void TaskModel::markRowPainted(int row) const
+{
+    if (row >= 0 && row < m_tasks.count())
+        m_tasks.at(row)->markProgressPainted();
+}
+
+bool TaskModel::rowSnapshot(int row, RowSnapshot &snapshot, int fields) const
 {
-    for (const auto *task : m_tasks)
+    if (row < 0 || row >= rowCount())
+        return false;
+
+    if (row < m_tasks.count())
+    {
+        const Task *task = m_tasks.at(row);
+        snapshot.running = task->isRunning();
+        snapshot.archived = false;
+        snapshot.progressStampNs = task->progressStamp();
+        if (fields & SnapshotName)
+            snapshot.name = task->getName();
+        if (fields & SnapshotDate)
+            snapshot.dateMs = task->getDateMs();
+        if (fields & SnapshotProgress)
+        {
+            snapshot.progress = task->getProgress();
+            snapshot.etaMs = task->getEtaMs();
+        }
+        if (fields & SnapshotHistory)
+            snapshot.history = &task->history();
+        return true;
+    }
+
+    // Завершённые задачи хранилища и архива не выполняются и не имеют истории
+    snapshot.running = false;
+    snapshot.progressStampNs = 0;
+    if (fields & SnapshotHistory)
+        snapshot.history = nullptr;
+
+    if (row < m_tasks.count() + m_coldTasks.count())
     {
-        if (task->getName().compare(name, Qt::CaseInsensitive) == 0)
-            return true;
+        const int index = row - m_tasks.count();
+        snapshot.archived = false;
+        if (fields & SnapshotName)
+            snapshot.name = m_coldTasks.name(index);
+        if (fields & SnapshotDate)
+            snapshot.dateMs = m_coldTasks.dateMs(index);
+        if (fields & SnapshotProgress)
+        {
+            snapshot.progress = Task::MAX_PROGRESS;
+            snapshot.etaMs = 0;
+        }
+        return true;
     }
-    return false;
+
+    snapshot.archived = true;
+    if (!(fields & (SnapshotName | SnapshotDate | SnapshotProgress)))
+        return true;
+
+    const TaskArchive::Record *record = m_archive.record(row - m_tasks.count() - m_coldTasks.count());
+    if (!record)
+        return false;
+    if (fields & SnapshotName)
+        snapshot.name = record->name;
+    if (fields & SnapshotDate)
+        snapshot.dateMs = record->date.toMSecsSinceEpoch();
+    if (fields & SnapshotProgress)
+    {
+        snapshot.progress = record->progress;
+        snapshot.etaMs = record->progress >= Task::MAX_PROGRESS ? 0 : -1;
+    }
+    return true;
+}
+
+bool TaskModel::hasTaskWithName(const QString &name) const
+{
+    return m_nameIndex.contains(name.toCaseFolded());
 }
 
 void TaskModel::onTaskDataChanged()
 {
+    DRW_SCOPED_TIMER(ModelUpdateSection);
+
     auto *task = qobject_cast<Task*>(sender());
     if (!task)
         return;
 
-    int row = m_tasks.indexOf(task);
-    if (row != -1)
+    const int row = task->modelRow();
+    if (row == -1)
+        return;
+
+    emit taskChanged(task->getId());
+    if (m_notificationsSuspended)
     {
-        QModelIndex idx = index(row);
-        emit dataChanged(idx, idx);
+        deferRowChange(task);
+        return;
     }
+    if (batchRowChange(row))
+        return;
+
+    QModelIndex idx = index(row);
+    DRW_COUNT(ModelDataChanged);
+    emit dataChanged(idx, idx);
+}
+
+void TaskModel::onTaskProgressChanged(int progress, int previous)
+{
+    DRW_SCOPED_TIMER(ModelUpdateSection);
+
+    --m_statistics.histogram[previous];
+    ++m_statistics.histogram[progress];
+    m_statistics.progressSum += progress - previous;
+    scheduleStatisticsUpdate();
+
+    auto *task = qobject_cast<Task*>(sender());
+    if (!task)
+        return;
+
+    trackFinishTime(task);
+
+    const int row = task->modelRow();
+    if (row == -1)
+        return;
+
+    emit taskChanged(task->getId());
+
+    // Прогресс строк вне области просмотра виден только через сортировку прокси
+    if (m_notificationsSuspended || (m_viewportTracking && !m_viewportTaskIds.contains(task->getId())))
+    {
+        deferRowChange(task);
+        return;
+    }
+    if (batchRowChange(row))
+        return;
+
+    QModelIndex idx = index(row);
+    DRW_COUNT(ModelDataChanged);
+    emit dataChanged(idx, idx);
+}
+
+void TaskModel::onTaskRunningChanged(bool running)
+{
+    auto *task = qobject_cast<Task*>(sender());
+    if (!task)
+        return;
+
+    if (running)
+    {
+        // Запустить можно только незавершённую задачу
+        --m_statistics.stopped;
+        ++m_statistics.running;
+    }
+    else
+    {
+        --m_statistics.running;
+        if (task->reportedProgress() >= Task::MAX_PROGRESS)
+        {
+            ++m_statistics.completed;
+            scheduleColdMigration(task);
+        }
+        else
+            ++m_statistics.stopped;
+    }
+    trackFinishTime(task);
+    scheduleStatisticsUpdate();
+}
+
+void TaskModel::accountTask(const Task *task, int sign)
+{
+    if (task->isRunning())
+        m_statistics.running += sign;
+    else if (task->reportedProgress() >= Task::MAX_PROGRESS)
+        m_statistics.completed += sign;
+    else
+        m_statistics.stopped += sign;
+
+    m_statistics.total += sign;
+    m_statistics.progressSum += sign * task->reportedProgress();
+    m_statistics.histogram[task->reportedProgress()] += sign;
+    if (sign < 0)
+        trackFinishTime(task, false);
+    scheduleStatisticsUpdate();
+}
+
+void TaskModel::deferRowChange(const Task *task)
+{
+    m_deferredIds.insert(task->getId());
+    if (!m_notificationsSuspended && !m_deferredTimer->isActive())
+        m_deferredTimer->start();
+}
+
+void TaskModel::beginBatchUpdate()
+{
+    m_batchUpdate = true;
+    m_batchFirst = -1;
+    m_batchLast = -1;
+}
+
+void TaskModel::endBatchUpdate()
+{
+    m_batchUpdate = false;
+    if (m_batchFirst == -1)
+        return;
+
+    DRW_COUNT(ModelDataChanged);
+    emit dataChanged(index(m_batchFirst), index(m_batchLast));
+    m_batchFirst = -1;
+}
+
+bool TaskModel::batchRowChange(int row)
+{
+    if (!m_batchUpdate)
+        return false;
+
+    m_batchFirst = m_batchFirst == -1 ? row : qMin(m_batchFirst, row);
+    m_batchLast = qMax(m_batchLast, row);
+    return true;
+}
+
+void TaskModel::flushDeferredChanges()
+{
+    if (m_deferredIds.isEmpty() || m_notificationsSuspended)
+        return;
+
+    // Задачи могли сместиться или быть удалены после изменения
+    QList<int> rows;
+    rows.reserve(m_deferredIds.count());
+    for (quint64 id : std::as_const(m_deferredIds))
+    {
+        if (const Task *task = liveTask(id))
+            rows.append(task->modelRow());
+    }
+    m_deferredIds.clear();
+
+    for (const RowRanges::Range &range : RowRanges::fromRows(std::move(rows)))
+    {
+        DRW_COUNT(ModelDataChanged);
+        emit dataChanged(index(range.first), index(range.last));
+    }
+}
+
+void TaskModel::detachTask(Task *task)
+{
+    // Интервал выполнения в журнале закрывается до удаления задачи
+    if (task->isRunning())
+        TaskEventLog::record(TaskEventLog::Stopped, task->getId(), task->getProgress());
+    TaskEventLog::record(TaskEventLog::Removed, task->getId(), task->getProgress());
+    accountTask(task, -1);
+    task->blockSignals(true);
+    task->detach();
+    task->setModelRow(-1);
+}
+
+void TaskModel::forgetTask(Task *task)
+{
+    m_nameIndex.remove(task->getName().toCaseFolded());
+    m_tasksById.remove(task->getId());
+    m_deferredIds.remove(task->getId());
+    m_staggeredIds.remove(task->getId());
+}
+
+Task *TaskModel::liveTask(quint64 id) const
+{
+    // Задачи очереди удаления остаются в индексе до своей части очереди
+    Task *task = m_tasksById.value(id, nullptr);
+    return task && task->modelRow() >= 0 ? task : nullptr;
+}
+
+void TaskModel::updateRows(int firstRow)
+{
+    for (int row = firstRow; row < m_tasks.count(); ++row)
+        m_tasks.at(row)->setModelRow(row);
+}
+
+void TaskModel::trackFinishTime(const Task *task, bool track)
+{
+    const auto it = m_finishTimes.find(task);
+    if (it != m_finishTimes.end())
+    {
+        m_finishSchedule.erase(m_finishSchedule.find(it.value()));
+        m_finishTimes.erase(it);
+    }
+
+    if (!track || !task->isRunning())
+        return;
+
+    const qint64 finish = task->projectedFinishMs();
+    if (finish < 0)
+        return;
+
+    m_finishTimes.insert(task, finish);
+    m_finishSchedule.insert(finish);
+}
+
+void TaskModel::scheduleStatisticsUpdate()
+{
+    if (!m_statisticsTimer->isActive())
+        m_statisticsTimer->start();
 }
@@ -1,7 +1,23 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <set>
+#include <vector>
+#include "coldtaskstore.h"
+#include "progresspattern.h"
+#include "rowranges.h"
+#include "sessionsnapshot.h"
+#ifdef DRW_COROUTINES
+#include "stagedtask.h"
+#endif
 #include "task.h"
+#include "taskarchive.h"
+#include "taskpool.h"
+#include "taskscheduler.h"
+#include "taskstatistics.h"
 
 /**
  * @class TaskModel
@@ -16,7 +32,40 @@ class TaskModel : public QAbstractListModel
 {
     Q_OBJECT
 
+    /// Минимальный интервал между уведомлениями об изменении статистики (мс)
+    static constexpr int STATISTICS_UPDATE_INTERVAL = 100;
+
+    /// Бюджет времени на освобождение удалённых задач за один проход цикла событий (мс)
+    static constexpr int REMOVAL_TIME_BUDGET = 8;
+
+    /// Количество задач, освобождаемых между проверками бюджета времени
+    static constexpr int REMOVAL_CHECK_STEP = 64;
+
+    /// Максимальное количество диапазонов, удаляемых отдельными beginRemoveRows
+    static constexpr int MAX_REMOVE_RANGES = 16;
+
+    /// Интервал сброса отложенных изменений строк вне области просмотра (мс)
+    static constexpr int DEFERRED_UPDATE_INTERVAL = 1000;
+
+    /// Интервал обновления видимых задач с вычисляемым прогрессом (мс)
+    static constexpr int COMPUTED_PROGRESS_REFRESH_INTERVAL = 100;
+
+    /// Количество строк архива, добавляемых за один вызов fetchMore()
+    static constexpr int ARCHIVE_FETCH_SIZE = 4096;
+
+    /// Минимальный интервал между переносами задач в хранилище завершённых (мс)
+    static constexpr int COLD_MIGRATION_INTERVAL = 1000;
+
+    /// Количество свободных задач, которое пул сохраняет после переноса
+    static constexpr int COLD_POOL_RESERVE = 4 * TaskPool::SLAB_SIZE;
+
+    /// Интервал запуска наступивших задач при разнесённом запуске (мс)
+    static constexpr int STAGGER_TICK_INTERVAL = 16;
+
 public:
+    /// Задержка переноса завершённой задачи в хранилище завершённых по умолчанию (мс)
+    static constexpr int DEFAULT_COLD_STORAGE_DELAY = 60000;
+
     /**
      * @enum TaskRoles
      * @brief Пользовательские роли для доступа к данным задач
@@ -26,7 +75,44 @@ public:
         DateRole,                       ///< Дата создания (QDateTime)
         ProgressRole,                   ///< Прогресс выполнения (int)
         RunningRole,                    ///< Статус выполнения (bool)
-        TaskPtrRole                     ///< Указатель на объект Task (Task*)
+        TaskPtrRole,                    ///< Указатель на объект Task (Task*)
+        RateRole,                       ///< Сглаженная скорость выполнения, %/с (double)
+        EtaRole,                        ///< Оценка оставшегося времени, мс (qint64, -1 - неизвестно)
+        HistoryRole,                    ///< История прогресса (ProgressHistory)
+        ProgressStampRole,              ///< Время первого неотрисованного изменения прогресса, нс (qint64, 0 - нет)
+        ArchivedRole                    ///< Строка из архива завершённых задач (bool)
+    };
+
+    /**
+     * @enum SnapshotFields
+     * @brief Поля RowSnapshot, требующие чтения данных строки
+     *
+     * Статус выполнения, признак архива и время неотрисованного изменения
+     * заполняются всегда. Для строк архива запись читается, только если
+     * запрошено название, дата или прогресс.
+     */
+    enum SnapshotFields {
+        SnapshotName = 0x1,       ///< Название
+        SnapshotDate = 0x2,       ///< Дата создания
+        SnapshotProgress = 0x4,   ///< Прогресс и оценка оставшегося времени
+        SnapshotHistory = 0x8,    ///< История прогресса
+        SnapshotAll = 0xF         ///< Все поля
+    };
+
+    /**
+     * @struct RowSnapshot
+     * @brief Данные строки, прочитанные одним вызовом без упаковки в QVariant
+     */
+    struct RowSnapshot
+    {
+        QString name{};                          ///< Название
+        qint64 dateMs{0};                        ///< Дата создания (мс от эпохи)
+        qint64 etaMs{-1};                        ///< Оценка оставшегося времени, мс (-1 - неизвестно)
+        qint64 progressStampNs{0};               ///< Время первого неотрисованного изменения прогресса, нс (0 - нет)
+        const ProgressHistory *history{nullptr}; ///< История прогресса задачи (nullptr - пустая)
+        int progress{0};                         ///< Прогресс выполнения
+        bool running{false};                     ///< Статус выполнения
+        bool archived{false};                    ///< Строка из архива завершённых задач
     };
 
     /**
@@ -56,24 +142,185 @@ public:
      */
     QHash<int, QByteArray> roleNames() const override;
 
+    /**
+     * @brief Проверить, остались ли незагруженные строки архива
+     * @param parent Родительский индекс
+     * @return true если в архиве есть строки после загруженных
+     */
+    bool canFetchMore(const QModelIndex &parent) const override;
+
+    /**
+     * @brief Добавить следующую порцию строк архива
+     * @param parent Родительский индекс
+     *
+     * Добавляет до ARCHIVE_FETCH_SIZE строк; данные записей читаются
+     * страницами только при обращении к ним.
+     */
+    void fetchMore(const QModelIndex &parent) override;
+
+    /**
+     * @brief Подключить архив завершённых задач
+     * @param path Путь к файлу TaskArchive
+     * @return true если архив открыт
+     *
+     * Строки архива следуют за строками текущих задач и добавляются
+     * порциями по мере прокрутки представления. Они доступны только
+     * для чтения: не запускаются, не удаляются и не входят в статистику.
+     */
+    bool openArchive(const QString &path);
+
+    /**
+     * @brief Задать ограничение памяти кэша страниц архива
+     * @param bytes Максимальный объём загруженных страниц (байт)
+     */
+    void setArchiveMemoryLimit(qint64 bytes) { m_archive.setMemoryLimit(bytes); }
+
+    /**
+     * @brief Получить архив завершённых задач
+     * @return Архив (пустой, если не подключён)
+     */
+    const TaskArchive &archive() const { return m_archive; }
+
+    /**
+     * @brief Получить количество загруженных строк архива
+     * @return Количество строк архива в модели
+     */
+    int archivedRowCount() const { return m_archivedRows; }
+
+    /**
+     * @brief Задать задержку переноса завершённых задач в хранилище завершённых
+     * @param msecs Время после завершения задачи (мс); отрицательное значение
+     *              отключает перенос
+     *
+     * Перенесённая задача остаётся в модели, но хранится в ColdTaskStore без
+     * объекта Task: строки хранилища следуют за строками текущих задач,
+     * доступны только для чтения и учитываются в статистике как завершённые.
+     */
+    void setColdStorageDelay(int msecs);
+
+    /**
+     * @brief Получить задержку переноса завершённых задач
+     * @return Задержка (мс) или отрицательное значение, если перенос отключён
+     */
+    int coldStorageDelay() const { return m_coldStorageDelay; }
+
+    /**
+     * @brief Перенести в хранилище завершённых все задачи, чья задержка истекла
+     * @return Количество перенесённых задач
+     *
+     * Перенос выполняется одним изменением раскладки модели: постоянные
+     * индексы (выделение, текущая строка) следуют за перенесёнными задачами.
+     */
+    int migrateCompletedTasks();
+
+    /**
+     * @brief Получить хранилище завершённых задач
+     * @return Хранилище перенесённых задач
+     */
+    const ColdTaskStore &coldTasks() const { return m_coldTasks; }
+
     /**
      * @brief Добавить новую задачу
      * @param name Название задачи
      *
-     * Создаёт новую задачу с указанным названием и добавляет её в модель.
+     * Получает задачу с указанным названием из пула и добавляет её в модель.
      * Автоматически подключает сигналы задачи для обновления представления.
      * После добавления выполняется сортировка по дате.
      */
     void addTask(const QString &name);
 
+    /**
+     * @brief Добавить несколько задач
+     * @param names Названия задач
+     * @return Идентификаторы добавленных задач в порядке названий;
+     *         0 для пустых названий и дубликатов, которые были пропущены
+     *
+     * Все задачи вставляются одним структурным изменением модели.
+     */
+    QList<quint64> addTasks(const QStringList &names);
+
+    /**
+     * @brief Восстановить задачи из снимка сессии
+     * @param entries Задачи снимка
+     * @return Идентификаторы восстановленных задач (0 для пропущенных дубликатов)
+     *
+     * Задачи добавляются остановленными с сохранёнными датой и прогрессом;
+     * завершённые задачи ставятся в очередь переноса в хранилище завершённых.
+     */
+    QList<quint64> restoreTasks(const QList<SessionSnapshot::Entry> &entries);
+
+    /**
+     * @brief Добавить задачу, выполняющую внешний процесс
+     * @param command Командная строка; служит и названием задачи
+     * @return Идентификатор задачи или 0, если название пустое или занято
+     *
+     * Прогресс задачи определяется по шаблону progressPattern() в выводе
+     * процесса (см. TaskProcess).
+     */
+    quint64 addProcessTask(const QString &command);
+
+    /**
+     * @brief Задать шаблон прогресса для новых задач с внешним процессом
+     * @param pattern Шаблон "префикс{}суффикс"
+     */
+    void setProgressPattern(const QByteArray &pattern) { m_progressPattern = pattern; }
+
+    /**
+     * @brief Получить шаблон прогресса задач с внешним процессом
+     * @return Шаблон
+     */
+    QByteArray progressPattern() const { return m_progressPattern; }
+
+#ifdef DRW_COROUTINES
+    /**
+     * @brief Добавить задачу, выполняющую тело из этапов
+     * @param name Название задачи
+     * @param definition Описание тела (см. StagedTask)
+     * @return Идентификатор добавленной задачи или 0, если задача не добавлена
+     *
+     * Ожидания тела планируются в общем планировщике модели.
+     */
+    quint64 addStagedTask(const QString &name, const StagedTask::Definition &definition);
+#endif
+
     /**
      * @brief Удалить задачу по индексу
      * @param row Индекс строки для удаления
      *
-     * Удаляет задачу из модели и освобождает память.
+     * Удаляет задачу из модели и возвращает её в пул для повторного использования.
+     * Задачи хранилища завершённых удаляются из хранилища.
      */
     void removeTask(int row);
 
+    /**
+     * @brief Асинхронно удалить несколько задач
+     * @param rows Индексы строк для удаления (в любом порядке, возможны повторы)
+     *
+     * Строки скрываются из модели сразу одним структурным изменением, а
+     * задачи лишь отсоединяются за O(1) на задачу; остановка таймеров и
+     * процессов, очистка индексов и освобождение задач выполняются порциями на холостых итерациях
+     * цикла событий с ограничением REMOVAL_TIME_BUDGET на порцию.
+     * Ход освобождения сообщается сигналом removalProgress().
+     * Задачи хранилища завершённых удаляются сразу.
+     */
+    void removeTasks(QList<int> rows);
+
+    /**
+     * @brief Асинхронно удалить задачи диапазонов строк
+     * @param ranges Диапазоны строк
+     *
+     * То же, что removeTasks(), но строки не разворачиваются в список:
+     * диапазоны сразу становятся структурными изменениями модели.
+     * Строки архива пропускаются.
+     */
+    void removeTaskRanges(const RowRanges &ranges);
+
+    /**
+     * @brief Получить количество задач, ожидающих освобождения
+     * @return Длина очереди удаления
+     */
+    int pendingRemovals() const { return m_removalQueue.count() - m_removalCursor; }
+
     /**
      * @brief Получить указатель на задачу по индексу
      * @param row Индекс строки
@@ -81,24 +328,462 @@ public:
      */
     Task* getTask(int row) const;
 
+    /**
+     * @brief Запустить несколько задач
+     * @param rows Индексы строк
+     *
+     * Представления получают одно уведомление dataChanged на все строки.
+     */
+    void startTasks(const QList<int> &rows);
+
+    /**
+     * @brief Запустить задачи диапазонов строк
+     * @param ranges Диапазоны строк; строки хранилища и архива пропускаются
+     *
+     * Представления получают одно уведомление dataChanged на все строки.
+     */
+    void startTaskRanges(const RowRanges &ranges);
+
+    /**
+     * @brief Запустить задачи диапазонов строк, разнеся запуски по времени
+     * @param ranges Диапазоны строк; строки хранилища и архива пропускаются
+     * @param windowMs Окно разнесения (мс); 0 - запустить сразу
+     *
+     * Каждой задаче назначается свой слот окна со случайным сдвигом внутри
+     * слота, поэтому таймеры задач не срабатывают синхронными волнами.
+     * Наступившие задачи запускаются раз в STAGGER_TICK_INTERVAL с одним
+     * уведомлением dataChanged на порцию. Остановка или удаление задачи
+     * отменяет её ожидающий запуск.
+     */
+    void startTasksStaggered(const RowRanges &ranges, int windowMs);
+
+    /**
+     * @brief Получить количество задач, ожидающих разнесённого запуска
+     * @return Количество задач
+     */
+    int pendingStarts() const { return m_staggeredIds.count(); }
+
+    /**
+     * @brief Приостановить или возобновить уведомления представлений
+     * @param suspended true, если окно свёрнуто или перекрыто
+     *
+     * При приостановке такты выполняющихся задач заменяются расписанием:
+     * прогресс вычисляется при запросе, а задача завершается в срок по
+     * одному событию таймера. Сигналы dataChanged не отправляются. При
+     * возобновлении представления получают уведомление об изменившихся
+     * строках. Пока включена лента изменений setProgressFeedActive(),
+     * такты не приостанавливаются, откладываются только уведомления.
+     */
+    void setNotificationsSuspended(bool suspended);
+
+    /**
+     * @brief Включить ленту изменений задач для внешних подписчиков
+     * @param active true, пока есть подписчики taskChanged()
+     *
+     * Пока лента включена, такты задач выполняются и при скрытом окне, а
+     * вычисляемый прогресс обновляется для всех выполняющихся задач, а не
+     * только для видимых строк.
+     */
+    void setProgressFeedActive(bool active);
+
+    /**
+     * @brief Проверить, приостановлены ли уведомления
+     * @return true если уведомления приостановлены
+     */
+    bool notificationsSuspended() const { return m_notificationsSuspended; }
+
+    /**
+     * @brief Задать строки, видимые в области просмотра
+     * @param rows Индексы строк исходной модели
+     *
+     * Изменения прогресса остальных строк не отправляются сразу, а
+     * накапливаются и раз в DEFERRED_UPDATE_INTERVAL отправляются только
+     * для изменившихся строк, чтобы прокси-модель переставила их при
+     * сортировке.
+     * Изменения статуса выполнения отправляются для всех строк.
+     */
+    void setViewportRows(const QList<int> &rows);
+
+    /**
+     * @brief Включить режим вычисляемого прогресса для новых задач
+     * @param enabled true - прогресс вычисляется по времени выполнения
+     *
+     * Задачи, добавленные после вызова, не используют таймеры: прогресс
+     * вычисляется при запросе данных, а завершение обрабатывается одним
+     * событием общего TaskScheduler. Видимые строки обновляются раз в
+     * COMPUTED_PROGRESS_REFRESH_INTERVAL; статистика прогресса остальных
+     * задач обновляется при их остановке и завершении.
+     */
+    void setComputedProgress(bool enabled);
+
+    /**
+     * @brief Проверить, включён ли режим вычисляемого прогресса
+     * @return true если новые задачи вычисляют прогресс по времени
+     */
+    bool computedProgress() const { return m_computedProgress; }
+
+    /**
+     * @brief Получить количество событий в очереди планировщика
+     * @return Длина очереди TaskScheduler
+     */
+    int scheduledEvents() const { return m_scheduler->pending(); }
+
+    /**
+     * @brief Остановить несколько задач
+     * @param rows Индексы строк
+     */
+    void stopTasks(const QList<int> &rows);
+
+    /**
+     * @brief Остановить задачи диапазонов строк
+     * @param ranges Диапазоны строк; строки хранилища и архива пропускаются
+     */
+    void stopTaskRanges(const RowRanges &ranges);
+
+    /**
+     * @brief Заполнить битовую карту выполняющихся задач
+     * @param first Первая строка диапазона (кратна 64)
+     * @param last Строка за последней строкой диапазона
+     * @param words Слова карты, начиная со слова строки first (заполнены нулями)
+     *
+     * Бит строки устанавливается, если её задача выполняется. Строки
+     * хранилища завершённых задач и архива не выполняются и не читаются.
+     * Состояние читается напрямую, без построения QVariant, поэтому метод
+     * можно вызывать из рабочих потоков для непересекающихся диапазонов,
+     * пока поток модели ожидает их завершения.
+     */
+    void fillRunningBitmap(int first, int last, quint64 *words) const;
+
+    /**
+     * @brief Прочитать данные строки без построения QVariant
+     * @param row Индекс строки
+     * @param snapshot Данные строки (выходной параметр)
+     * @param fields Набор SnapshotFields; незапрошенные поля не изменяются
+     * @return false для невалидного индекса
+     *
+     * Возвращает те же значения, что и data() для ролей TaskRoles, но одним
+     * вызовом. Указатель на историю действителен до следующего изменения
+     * задачи.
+     */
+    bool rowSnapshot(int row, RowSnapshot &snapshot, int fields = SnapshotAll) const;
+
+    /**
+     * @brief Отметить изменение прогресса строки отрисованным
+     * @param row Индекс строки
+     *
+     * Сбрасывает время, которое rowSnapshot() отдаёт в progressStampNs.
+     * Строки хранилища завершённых задач и архива такого времени не имеют
+     * и пропускаются.
+     */
+    void markRowPainted(int row) const;
+
+    /**
+     * @brief Найти строку задачи по идентификатору
+     * @param id Идентификатор задачи
+     * @return Индекс строки или -1, если задачи нет в модели
+     */
+    int rowOfTask(quint64 id) const;
+
+    /**
+     * @brief Получить идентификатор задачи по строке
+     * @param row Индекс строки
+     * @return Идентификатор текущей задачи или задачи хранилища; 0 для строк
+     *         архива и невалидных индексов
+     */
+    quint64 taskId(int row) const;
+
+    /**
+     * @brief Получить идентификаторы задач по строкам
+     * @param rows Индексы строк
+     * @return Идентификаторы текущих задач и задач хранилища; строки архива
+     *         и невалидные индексы пропускаются
+     */
+    QList<quint64> taskIds(const QList<int> &rows) const;
+
     /**
      * @brief Проверить наличие задачи с указанным именем
      * @param name Название задачи для поиска
      * @return true если задача с таким именем существует
      *
-     * Поиск выполняется без учёта регистра.
+     * Поиск выполняется без учёта регистра по индексу названий за O(1).
      */
     bool hasTaskWithName(const QString &name) const;
 
+    /**
+     * @brief Получить индекс названий задач
+     * @return Названия всех задач в свёрнутом регистре (QString::toCaseFolded)
+     *
+     * Возвращается неявно разделяемая копия, пригодная для проверки
+     * дубликатов в другом потоке.
+     */
+    QSet<QString> nameIndex() const { return m_nameIndex; }
+
+    /**
+     * @brief Получить агрегированную статистику задач
+     * @return Текущие счётчики состояний и гистограмма прогресса
+     *
+     * Статистика поддерживается инкрементально и не требует обхода задач.
+     * Пока такты приостановлены, счётчики состояний точны, а прогресс и
+     * гистограмма отражают применённые такты и догоняются при возобновлении.
+     */
+    const TaskStatistics &statistics() const { return m_statistics; }
+
+    /**
+     * @brief Получить статистику пула задач
+     * @return Счётчики выделений и повторного использования задач
+     */
+    TaskPool::Statistics poolStatistics() const { return m_pool.statistics(); }
+
+signals:
+    /**
+     * @brief Сигнал об изменении статистики задач
+     * @param statistics Актуальные счётчики
+     *
+     * Уведомления объединяются: сигнал испускается не чаще одного раза
+     * за STATISTICS_UPDATE_INTERVAL миллисекунд.
+     */
+    void statisticsChanged(const TaskStatistics &statistics);
+
+    /**
+     * @brief Сигнал о ходе асинхронного удаления задач
+     * @param released Количество уже освобождённых задач
+     * @param total Общее количество задач в очереди удаления
+     *
+     * При released == total очередь удаления пуста.
+     */
+    void removalProgress(int released, int total);
+
+    /**
+     * @brief Сигнал об изменении прогресса или состояния задачи
+     * @param id Идентификатор задачи
+     *
+     * Лента для внешних подписчиков: в отличие от dataChanged испускается
+     * сразу для любой строки, без учёта области просмотра и приостановки
+     * уведомлений представлений.
+     */
+    void taskChanged(quint64 id);
+
 private slots:
     /**
      * @brief Слот для обработки изменений в задаче
      *
-     * Вызывается при изменении данных задачи (прогресс, статус и т.д.).
-     * Автоматически оповещает представление об обновлении через dataChanged.
+     * Вызывается при запуске и остановке задачи. Оповещает представление
+     * об обновлении через dataChanged, если уведомления не приостановлены.
      */
     void onTaskDataChanged();
 
+    /**
+     * @brief Слот обработки изменения прогресса задачи
+     * @param progress Новое значение прогресса
+     * @param previous Предыдущее значение прогресса
+     *
+     * Переносит задачу между корзинами гистограммы прогресса и оповещает
+     * представление, если строка видима, иначе откладывает уведомление.
+     */
+    void onTaskProgressChanged(int progress, int previous);
+
+    /**
+     * @brief Слот обработки запуска или остановки задачи
+     * @param running Новый статус выполнения
+     *
+     * Обновляет счётчики выполняющихся, остановленных и завершённых задач.
+     */
+    void onTaskRunningChanged(bool running);
+
+    /**
+     * @brief Освободить очередную порцию удалённых задач
+     *
+     * Для каждой задачи порции убирает её из индексов, останавливает таймер
+     * и процесс и возвращает задачу в пул. Вызывается таймером с нулевым
+     * интервалом, пока очередь не опустеет.
+     */
+    void processRemovalQueue();
+
+    /**
+     * @brief Запустить задачи, чей момент разнесённого запуска наступил
+     */
+    void processStaggeredStarts();
+
+    /**
+     * @brief Сообщить вычисленный прогресс видимых выполняющихся задач
+     */
+    void refreshComputedProgress();
+
 private:
-    QList<Task*> m_tasks{};  ///< Список задач
+    /**
+     * @brief Учесть задачу в статистике
+     * @param task Задача
+     * @param sign +1 при добавлении задачи, -1 при удалении
+     */
+    void accountTask(const Task *task, int sign);
+
+    /**
+     * @brief Добавить задачи одним структурным изменением
+     * @param names Названия задач
+     * @param restored Сохранённое состояние задач в порядке названий (пусто - новые задачи)
+     * @return Идентификаторы добавленных задач (0 для пропущенных)
+     */
+    QList<quint64> insertTasks(const QStringList &names, const QList<SessionSnapshot::Entry> &restored);
+
+    /**
+     * @brief Отсоединить удаляемую задачу от модели за O(1)
+     * @param task Задача, которая удаляется из модели
+     *
+     * Записывает удаление в журнал событий (для выполняющейся задачи - после
+     * остановки, чтобы закрыть её интервал), исключает задачу из статистики,
+     * блокирует её сигналы и вызывает Task::detach(). Индексы не меняются -
+     * это делает forgetTask().
+     */
+    void detachTask(Task *task);
+
+    /**
+     * @brief Исключить отсоединённую задачу из индексов модели
+     * @param task Задача, ранее переданная в detachTask()
+     *
+     * Для массового удаления вызывается частями из processRemovalQueue(),
+     * поэтому название задачи освобождается для повторного добавления,
+     * когда её задача проходит очередь.
+     */
+    void forgetTask(Task *task);
+
+    /**
+     * @brief Найти задачу модели по идентификатору
+     * @param id Идентификатор задачи
+     * @return Задача или nullptr, если её нет или она ожидает в очереди удаления
+     */
+    Task *liveTask(quint64 id) const;
+
+    /**
+     * @brief Проверить, заменены ли такты задач расписанием
+     * @return true, если уведомления приостановлены и лента изменений выключена
+     */
+    bool ticksSuspended() const { return m_notificationsSuspended && !m_progressFeedActive; }
+
+    /**
+     * @brief Обновить сохранённые в задачах номера строк
+     * @param firstRow Первая строка, номера которой могли измениться
+     */
+    void updateRows(int firstRow);
+
+    /**
+     * @brief Обновить прогнозируемое время завершения задачи
+     * @param task Задача
+     * @param track false, чтобы только исключить задачу из прогноза
+     *
+     * Поддерживает упорядоченное множество моментов завершения выполняющихся
+     * задач, максимум которого даёт общую оценку без обхода задач.
+     */
+    void trackFinishTime(const Task *task, bool track = true);
+
+    /**
+     * @brief Запланировать отправку сигнала statisticsChanged
+     */
+    void scheduleStatisticsUpdate();
+
+    /**
+     * @brief Получить данные строки архива
+     * @param index Номер записи архива
+     * @param role Роль данных
+     * @return Данные в формате QVariant
+     *
+     * Роли, не требующие записи (статус выполнения, признак архива),
+     * возвращаются без чтения страницы.
+     */
+    QVariant archivedData(qint64 index, int role) const;
+
+    /**
+     * @brief Получить данные строки хранилища завершённых задач
+     * @param index Номер записи хранилища
+     * @param role Роль данных
+     * @return Данные в формате QVariant
+     */
+    QVariant coldData(int index, int role) const;
+
+    /**
+     * @brief Удалить строки хранилища завершённых задач
+     * @param rows Упорядоченные номера строк модели в области хранилища
+     */
+    void removeColdRows(const QList<int> &rows);
+
+    /**
+     * @brief Запланировать перенос завершённой задачи в хранилище завершённых
+     * @param task Только что завершённая задача
+     */
+    void scheduleColdMigration(const Task *task);
+
+    /**
+     * @brief Запустить таймер переноса к ближайшему сроку
+     */
+    void armColdTimer();
+
+    /**
+     * @brief Отложить уведомление об изменении строки задачи
+     * @param task Изменившаяся задача
+     */
+    void deferRowChange(const Task *task);
+
+    /**
+     * @brief Начать пакетное изменение задач
+     *
+     * До endBatchUpdate() изменения строк не отправляются по отдельности,
+     * а объединяются в один диапазон.
+     */
+    void beginBatchUpdate();
+
+    /**
+     * @brief Завершить пакетное изменение и отправить одно уведомление
+     */
+    void endBatchUpdate();
+
+    /**
+     * @brief Учесть изменение строки в текущем пакете
+     * @param row Строка
+     * @return true если пакет открыт и уведомление отложено до его конца
+     */
+    bool batchRowChange(int row);
+
+    /**
+     * @brief Отправить уведомления об отложенных изменениях
+     *
+     * Строки изменившихся задач определяются по идентификаторам на момент
+     * отправки и уведомляются смежными диапазонами; остальные строки не
+     * затрагиваются.
+     */
+    void flushDeferredChanges();
+
+    TaskPool m_pool;                     ///< Пул объектов задач
+    QList<Task*> m_tasks{};              ///< Список задач
+    QHash<quint64, Task*> m_tasksById{}; ///< Задачи по идентификатору
+    QSet<QString> m_nameIndex{};         ///< Названия задач в свёрнутом регистре
+    quint64 m_lastTaskId{0};             ///< Последний выданный идентификатор задачи
+    TaskStatistics m_statistics{};       ///< Агрегированная статистика задач
+    QTimer *m_statisticsTimer{nullptr};  ///< Таймер объединения уведомлений статистики
+    QHash<const Task*, qint64> m_finishTimes{}; ///< Учтённый момент завершения каждой выполняющейся задачи
+    std::multiset<qint64> m_finishSchedule{};   ///< Упорядоченные моменты завершения выполняющихся задач
+    QList<Task*> m_removalQueue{};       ///< Скрытые из модели задачи, ожидающие освобождения
+    int m_removalCursor{0};              ///< Количество уже освобождённых задач очереди
+    QTimer *m_removalTimer{nullptr};     ///< Таймер порционного освобождения задач
+    bool m_notificationsSuspended{false}; ///< Уведомления приостановлены (окно скрыто)
+    bool m_progressFeedActive{false};     ///< Включена лента taskChanged() для подписчиков
+    bool m_viewportTracking{false};      ///< Известны строки в области просмотра
+    QSet<quint64> m_viewportTaskIds{};   ///< Идентификаторы задач в области просмотра
+    QSet<quint64> m_deferredIds{};       ///< Задачи с отложенными изменениями строк
+    QTimer *m_deferredTimer{nullptr};    ///< Таймер сброса отложенных изменений
+    bool m_computedProgress{false};      ///< Новые задачи вычисляют прогресс по времени
+    TaskScheduler *m_scheduler{nullptr}; ///< Планировщик завершения задач с вычисляемым прогрессом
+    QTimer *m_computedRefreshTimer{nullptr}; ///< Таймер обновления видимых задач с вычисляемым прогрессом
+    TaskArchive m_archive;               ///< Архив завершённых задач
+    int m_archivedRows{0};               ///< Строки архива, загруженные в модель
+    ColdTaskStore m_coldTasks;           ///< Хранилище перенесённых завершённых задач
+    QList<QPair<qint64, quint64>> m_coldQueue{}; ///< Момент завершения (мс) и идентификатор задач, ожидающих переноса
+    int m_coldStorageDelay{DEFAULT_COLD_STORAGE_DELAY}; ///< Задержка переноса завершённых задач (мс)
+    QTimer *m_coldTimer{nullptr};        ///< Таймер переноса завершённых задач
+    std::vector<QPair<qint64, quint64>> m_staggerQueue{}; ///< Момент запуска (мс) и идентификатор по возрастанию момента
+    int m_staggerCursor{0};              ///< Количество уже обработанных записей очереди запуска
+    QSet<quint64> m_staggeredIds{};      ///< Задачи, ожидающие разнесённого запуска
+    QTimer *m_staggerTimer{nullptr};     ///< Таймер разнесённого запуска
+    bool m_batchUpdate{false};           ///< Открыто пакетное изменение задач
+    int m_batchFirst{-1};                ///< Первая изменённая строка пакета (-1 - нет)
+    int m_batchLast{-1};                 ///< Последняя изменённая строка пакета
+    QByteArray m_progressPattern{ProgressPattern::DEFAULT_PATTERN}; ///< Шаблон прогресса внешних процессов
 };
@@ -0,0 +1,127 @@
+#include "taskpool.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <utility>
+
+TaskPool::~TaskPool()
+{
+    for (const auto &slab : m_slabs)
+    {
+        for (int i = 0; i < slab->used; ++i)
+            std::launder(reinterpret_cast<Task*>(&slab->slots[i]))->~Task();
+    }
+}
+
+Task *TaskPool::acquire(const QString &name)
+{
+    ++m_statistics.acquired;
+    ++m_statistics.inUse;
+
+    // Повторно используем свободную задачу
+    if (!m_freeTasks.isEmpty())
+    {
+        Task *task = m_freeTasks.takeLast();
+        task->reset(name);
+        ++m_statistics.reused;
+        return task;
+    }
+
+    // Текущий слэб заполнен - выделяем новый
+    if (m_slabs.empty() || m_slabs.back()->used == SLAB_SIZE)
+        m_slabs.push_back(std::make_unique<Slab>());
+
+    Slab &slab = *m_slabs.back();
+    Task *task = new (&slab.slots[slab.used]) Task(name);
+    ++slab.used;
+    ++m_statistics.constructed;
+    return task;
+}
+
+void TaskPool::release(Task *task)
+{
+    if (!task)
+        return;
+
+    // Отключаем всех получателей сигналов задачи и останавливаем её
+    task->disconnect();
+    task->blockSignals(false);
+    task->reset(QString());
+
+    m_freeTasks.append(task);
+    ++m_statistics.released;
+    --m_statistics.inUse;
+}
+
+int TaskPool::trim(int keepFree)
+{
+    if (m_freeTasks.count() <= keepFree)
+        return 0;
+
+    // Определяем слэб каждой свободной задачи по адресу
+    std::vector<std::pair<std::uintptr_t, size_t>> starts;
+    starts.reserve(m_slabs.size());
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+        starts.emplace_back(reinterpret_cast<std::uintptr_t>(m_slabs[i]->slots.get()), i);
+    std::sort(starts.begin(), starts.end());
+
+    std::vector<int> freeCounts(m_slabs.size(), 0);
+    std::vector<size_t> freeSlabs;
+    freeSlabs.reserve(m_freeTasks.count());
+    for (Task *task : std::as_const(m_freeTasks))
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(task);
+        const auto it = std::upper_bound(starts.cbegin(), starts.cend(), std::make_pair(address, m_slabs.size()));
+        const size_t slab = std::prev(it)->second;
+        freeSlabs.push_back(slab);
+        ++freeCounts[slab];
+    }
+
+    // Выбираем полностью свободные слэбы, пока не останется keepFree задач
+    std::vector<bool> dropped(m_slabs.size(), false);
+    int remaining = m_freeTasks.count();
+    int destroyed = 0;
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+    {
+        if (m_slabs[i]->used == 0 || freeCounts[i] != m_slabs[i]->used || remaining - m_slabs[i]->used < keepFree)
+            continue;
+        dropped[i] = true;
+        remaining -= m_slabs[i]->used;
+        destroyed += m_slabs[i]->used;
+    }
+    if (destroyed == 0)
+        return 0;
+
+    QList<Task*> freeTasks;
+    freeTasks.reserve(remaining);
+    for (int i = 0; i < m_freeTasks.count(); ++i)
+    {
+        if (!dropped[freeSlabs[i]])
+            freeTasks.append(m_freeTasks.at(i));
+    }
+    m_freeTasks.swap(freeTasks);
+
+    std::vector<std::unique_ptr<Slab>> slabs;
+    slabs.reserve(m_slabs.size());
+    for (size_t i = 0; i < m_slabs.size(); ++i)
+    {
+        if (!dropped[i])
+        {
+            slabs.push_back(std::move(m_slabs[i]));
+            continue;
+        }
+        for (int j = 0; j < m_slabs[i]->used; ++j)
+            std::launder(reinterpret_cast<Task*>(&m_slabs[i]->slots[j]))->~Task();
+    }
+    m_slabs.swap(slabs);
+    return destroyed;
+}
+
+TaskPool::Statistics TaskPool::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.slabs = static_cast<int>(m_slabs.size());
+    statistics.free = m_freeTasks.count();
+    return statistics;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QList>
+#include "task.h"
+
+/**
+ * @class TaskPool
+ * @brief Пул объектов Task с повторным использованием
+ *
+ * TaskPool размещает задачи в слэбах фиксированного размера и хранит
+ * освобождённые задачи в списке свободных объектов. Повторно выданная
+ * задача сбрасывается через Task::reset() и сохраняет свой QTimer, поэтому
+ * при интенсивном создании и удалении задач не происходит ни выделений
+ * памяти, ни конструирования QObject.
+ *
+ * @note Задачи пула не имеют родительского QObject: ими владеет пул,
+ *       и удалять их через delete или deleteLater() нельзя.
+ */
+class TaskPool
+{
+public:
+    /// Количество задач в одном слэбе
+    static constexpr int SLAB_SIZE = 256;
+
+    /**
+     * @struct Statistics
+     * @brief Статистика использования пула
+     */
+    struct Statistics
+    {
+        qint64 acquired{0};     ///< Всего выдано задач
+        qint64 released{0};     ///< Всего возвращено задач
+        qint64 constructed{0};  ///< Создано новых объектов Task
+        qint64 reused{0};       ///< Выдано повторно использованных задач
+        int slabs{0};           ///< Количество выделенных слэбов
+        int inUse{0};           ///< Задачи, выданные и ещё не возвращённые
+        int free{0};            ///< Задачи в списке свободных
+    };
+
+    TaskPool() = default;
+
+    /**
+     * @brief Деструктор
+     *
+     * Уничтожает все созданные пулом задачи, включая ещё не возвращённые.
+     */
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    /**
+     * @brief Получить задачу из пула
+     * @param name Название задачи
+     * @return Задача в исходном состоянии
+     *
+     * Повторно использует свободную задачу, если она есть, иначе создаёт
+     * новую в текущем слэбе.
+     */
+    Task *acquire(const QString &name);
+
+    /**
+     * @brief Вернуть задачу в пул
+     * @param task Задача, полученная через acquire()
+     *
+     * Останавливает задачу, отключает все её сигналы и помещает в список
+     * свободных. Память задачи остаётся за пулом до его уничтожения.
+     */
+    void release(Task *task);
+
+    /**
+     * @brief Вернуть системе память полностью свободных слэбов
+     * @param keepFree Количество свободных задач, которое следует сохранить
+     * @return Количество уничтоженных задач
+     *
+     * Уничтожает задачи слэбов, в которых не осталось выданных задач, пока
+     * в списке свободных больше keepFree задач.
+     */
+    int trim(int keepFree);
+
+    /**
+     * @brief Получить статистику пула
+     * @return Текущая статистика
+     */
+    Statistics statistics() const;
+
+private:
+    /**
+     * @struct TaskSlot
+     * @brief Неинициализированная память под один объект Task
+     */
+    struct alignas(Task) TaskSlot
+    {
+        unsigned char bytes[sizeof(Task)];
+    };
+
+    /**
+     * @struct Slab
+     * @brief Блок памяти под SLAB_SIZE задач
+     */
+    struct Slab
+    {
+        std::unique_ptr<TaskSlot[]> slots{new TaskSlot[SLAB_SIZE]};  ///< Память задач
+        int used{0};  ///< Количество сконструированных задач в слэбе
+    };
+
+    std::vector<std::unique_ptr<Slab>> m_slabs;  ///< Выделенные слэбы
+    QList<Task*> m_freeTasks{};                   ///< Список свободных задач
+    Statistics m_statistics{};                    ///< Накопленная статистика
+};
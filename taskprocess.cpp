@@ -0,0 +1,135 @@
+#include "taskprocess.h"
+#include "instrumentation.h"
+#include <QTimer>
+#include <algorithm>
+
+TaskProcess::TaskProcess(const QString &command, const QByteArray &pattern, QObject *parent)
+    : QObject(parent)
+    , m_command(command)
+    , m_pattern(pattern)
+{
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &TaskProcess::onReadyRead);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this](int exitCode, QProcess::ExitStatus status) {
+                // Прежний запуск завершился - начинаем новый
+                if (m_restarting)
+                {
+                    m_restarting = false;
+                    launch();
+                    return;
+                }
+                onReadyRead();
+                const bool success = !m_terminating && status == QProcess::NormalExit && exitCode == 0;
+                m_terminating = false;
+                emit finished(success);
+            });
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        // Об остальных ошибках сообщает finished()
+        if (error == QProcess::FailedToStart)
+            emit finished(false);
+    });
+}
+
+void TaskProcess::start()
+{
+    // Завершение прежнего запуска не сообщается: новый запуск начнётся
+    // из обработчика его завершения, не блокируя цикл событий
+    if (m_process->state() != QProcess::NotRunning)
+    {
+        m_restarting = true;
+        m_process->kill();
+        return;
+    }
+    launch();
+}
+
+void TaskProcess::launch()
+{
+    ++m_launches;
+    QStringList arguments = QProcess::splitCommand(m_command);
+    if (arguments.isEmpty())
+    {
+        emit finished(false);
+        return;
+    }
+
+    m_terminating = false;
+    m_pattern.reset();
+    const QString program = arguments.takeFirst();
+    m_process->start(program, arguments, QIODevice::ReadOnly);
+}
+
+void TaskProcess::terminate()
+{
+    // Отложенный перезапуск отменяется, прежний запуск уже завершается
+    m_restarting = false;
+    if (m_process->state() == QProcess::NotRunning)
+        return;
+
+    m_terminating = true;
+    m_process->terminate();
+    // Новый запуск, начатый до срабатывания таймера, не затрагивается
+    QTimer::singleShot(KILL_TIMEOUT, this, [this, launch = m_launches]() {
+        if (m_launches == launch && m_process->state() != QProcess::NotRunning)
+            m_process->kill();
+    });
+}
+
+QByteArray TaskProcess::outputTail() const
+{
+    const qint64 size = qMin<qint64>(m_outputWritten, OUTPUT_RING_SIZE);
+    const int start = static_cast<int>((m_outputWritten - size) % OUTPUT_RING_SIZE);
+
+    QByteArray tail;
+    tail.reserve(static_cast<int>(size));
+    const int first = static_cast<int>(qMin<qint64>(size, OUTPUT_RING_SIZE - start));
+    tail.append(m_output.data() + start, first);
+    tail.append(m_output.data(), static_cast<int>(size) - first);
+    return tail;
+}
+
+void TaskProcess::onReadyRead()
+{
+    DRW_SCOPED_TIMER(ProcessOutputSection);
+
+    // Вывод прежнего запуска не относится к новому
+    if (m_restarting)
+    {
+        m_process->readAll();
+        return;
+    }
+
+    char buffer[READ_CHUNK_SIZE];
+    int progress = -1;
+    qint64 read = 0;
+    while ((read = m_process->read(buffer, READ_CHUNK_SIZE)) > 0)
+    {
+        DRW_COUNT(ProcessOutputReads);
+        appendOutput(buffer, read);
+        const int value = m_pattern.feed(buffer, read);
+        if (value >= 0)
+            progress = value;
+    }
+
+    if (progress >= 0)
+        emit progressParsed(progress);
+}
+
+void TaskProcess::appendOutput(const char *data, qint64 size)
+{
+    // В буфер попадают только последние OUTPUT_RING_SIZE байт порции
+    if (size > OUTPUT_RING_SIZE)
+    {
+        m_outputWritten += size - OUTPUT_RING_SIZE;
+        data += size - OUTPUT_RING_SIZE;
+        size = OUTPUT_RING_SIZE;
+    }
+
+    const int start = static_cast<int>(m_outputWritten % OUTPUT_RING_SIZE);
+    const int first = static_cast<int>(qMin<qint64>(size, OUTPUT_RING_SIZE - start));
+    std::copy(data, data + first, m_output.data() + start);
+    std::copy(data + first, data + size, m_output.data());
+    m_outputWritten += size;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <array>
+#include "progresspattern.h"
+
+/**
+ * @class TaskProcess
+ * @brief Внешний процесс, выполняемый задачей
+ *
+ * Запускает команду через QProcess и определяет прогресс по шаблону
+ * ProgressPattern в объединённом выводе stdout/stderr. Вывод читается в
+ * буфер на стеке и разбирается на месте; последние OUTPUT_RING_SIZE байт
+ * сохраняются в кольцевом буфере фиксированного размера. За одно
+ * уведомление readyRead сообщается только последнее найденное значение.
+ */
+class TaskProcess : public QObject
+{
+    Q_OBJECT
+
+    /// Размер порции чтения вывода (байт)
+    static constexpr int READ_CHUNK_SIZE = 16 * 1024;
+
+    /// Время ожидания завершения после terminate() перед kill() (мс)
+    static constexpr int KILL_TIMEOUT = 3000;
+
+public:
+    /// Размер сохраняемого хвоста вывода (байт)
+    static constexpr int OUTPUT_RING_SIZE = 4096;
+
+    /**
+     * @brief Конструктор
+     * @param command Командная строка (разбивается QProcess::splitCommand)
+     * @param pattern Шаблон прогресса
+     * @param parent Родительский объект
+     */
+    TaskProcess(const QString &command, const QByteArray &pattern, QObject *parent = nullptr);
+
+    /**
+     * @brief Получить командную строку
+     * @return Команда процесса
+     */
+    QString command() const { return m_command; }
+
+    /**
+     * @brief Запустить процесс
+     *
+     * Процесс предыдущего запуска, если он ещё не завершился, принудительно
+     * завершается, а новый запуск начинается после его завершения без
+     * ожидания в цикле событий.
+     */
+    void start();
+
+    /**
+     * @brief Попросить процесс завершиться
+     *
+     * Отправляет terminate(); если процесс не завершился за KILL_TIMEOUT,
+     * он завершается принудительно.
+     */
+    void terminate();
+
+    /**
+     * @brief Получить последние байты вывода
+     * @return До OUTPUT_RING_SIZE последних байт в порядке вывода
+     */
+    QByteArray outputTail() const;
+
+signals:
+    /**
+     * @brief Сигнал о найденном в выводе значении прогресса
+     * @param progress Значение последнего совпадения шаблона
+     */
+    void progressParsed(int progress);
+
+    /**
+     * @brief Сигнал о завершении процесса
+     * @param success true при нормальном завершении с кодом 0
+     */
+    void finished(bool success);
+
+private slots:
+    /**
+     * @brief Прочитать и разобрать доступный вывод
+     */
+    void onReadyRead();
+
+private:
+    /**
+     * @brief Начать новый запуск процесса
+     */
+    void launch();
+
+    /**
+     * @brief Дописать данные в кольцевой буфер вывода
+     * @param data Данные
+     * @param size Размер данных
+     */
+    void appendOutput(const char *data, qint64 size);
+
+    QString m_command;                             ///< Командная строка
+    QProcess *m_process{nullptr};                  ///< Процесс
+    ProgressPattern m_pattern;                     ///< Разбор прогресса в выводе
+    std::array<char, OUTPUT_RING_SIZE> m_output{}; ///< Кольцевой буфер хвоста вывода
+    qint64 m_outputWritten{0};                     ///< Всего записано байт вывода
+    bool m_terminating{false};                     ///< Завершение запрошено terminate()
+    bool m_restarting{false};                      ///< Новый запуск ждёт завершения прежнего
+    quint64 m_launches{0};                         ///< Количество запусков процесса
+};
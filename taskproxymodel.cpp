@@ -1,10 +1,14 @@
 #include "taskproxymodel.h"
 #include "taskmodel.h"
+#include "instrumentation.h"
 #include <QDatetime>
+#include <QtConcurrentMap>
+#include <limits>
 
 TaskProxyModel::TaskProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent),
-    m_filterType(All)
+    m_filterType(All),
+    m_sortMode(ByDate)
 {
     // Включаем динамическую сортировку
     setDynamicSortFilter(true);
@@ -19,17 +23,227 @@ void TaskProxyModel::setFilterType(FilterType type)
         return;
 
     m_filterType = type;
+
+    DRW_SCOPED_TIMER(FilterPassSection);
+
+    // "Все задачи" не зависит от состояния, карта нужна только для остальных фильтров
+    const bool useBitmap = m_filterType != All && buildRunningBitmap();
+    const bool useKeys = buildSortKeys();
     invalidateFilter();
+    if (useBitmap)
+    {
+        m_runningRows.clear();
+        m_runningRows.shrink_to_fit();
+        m_bitmapRows = 0;
+    }
+    if (useKeys)
+    {
+        m_sortKeys.clear();
+        m_sortKeys.shrink_to_fit();
+    }
+}
+
+void TaskProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    for (const QMetaObject::Connection &connection : std::as_const(m_sourceConnections))
+        disconnect(connection);
+    m_sourceConnections.clear();
+    m_acceptedRows.clear();
+
+    m_taskModel = qobject_cast<const TaskModel*>(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    if (!sourceModel)
+        return;
+
+    // Подключаемся после базового класса: сдвиг при вставке выполняется до
+    // того, как прокси оценит новые строки в rowsInserted, а при удалении -
+    // после того, как прокси обновит отображение
+    m_sourceConnections.append(connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this,
+                                       [this](const QModelIndex &parent, int first, int last) {
+        if (!parent.isValid())
+            insertAcceptedBits(first, last - first + 1);
+    }));
+    m_sourceConnections.append(connect(sourceModel, &QAbstractItemModel::rowsRemoved, this,
+                                       [this](const QModelIndex &parent, int first, int last) {
+        if (!parent.isValid())
+            removeAcceptedBits(first, last - first + 1);
+    }));
+}
+
+bool TaskProxyModel::rowSnapshot(const QModelIndex &index, TaskModel::RowSnapshot &snapshot, int fields) const
+{
+    if (!m_taskModel || index.model() != this)
+        return false;
+    return m_taskModel->rowSnapshot(mapToSource(index).row(), snapshot, fields);
+}
+
+void TaskProxyModel::markRowPainted(const QModelIndex &index) const
+{
+    if (m_taskModel && index.model() == this)
+        m_taskModel->markRowPainted(mapToSource(index).row());
+}
+
+bool TaskProxyModel::buildRunningBitmap()
+{
+    if (!m_taskModel || m_parallelFilterThreshold <= 0 || m_taskModel->rowCount() < m_parallelFilterThreshold)
+        return false;
+
+    const TaskModel *model = m_taskModel;
+    const int rows = model->rowCount();
+    m_runningRows.assign((rows + 63) / 64, 0);
+
+    // Части выровнены по 64 строкам, поэтому потоки пишут в разные слова карты
+    QList<int> chunks;
+    for (int first = 0; first < rows; first += PARALLEL_FILTER_CHUNK_ROWS)
+        chunks.append(first);
+    quint64 *words = m_runningRows.data();
+    QtConcurrent::blockingMap(chunks, [model, rows, words](int first) {
+        model->fillRunningBitmap(first, qMin(first + PARALLEL_FILTER_CHUNK_ROWS, rows), words + first / 64);
+    });
+
+    m_bitmapRows = rows;
+    return true;
+}
+
+bool TaskProxyModel::buildSortKeys()
+{
+    if (!m_taskModel)
+        return false;
+
+    // Оценка вычисляемого прогресса меняется со временем, поэтому ключи
+    // снимаются один раз на проход при любом количестве строк
+    const int rows = m_taskModel->rowCount();
+    m_sortKeys.resize(rows);
+    if (m_parallelFilterThreshold <= 0 || rows < m_parallelFilterThreshold)
+    {
+        for (int row = 0; row < rows; ++row)
+            m_sortKeys[row] = sortKey(row);
+        return true;
+    }
+
+    // Каждая часть заполняет свои элементы вектора
+    QList<int> chunks;
+    for (int first = 0; first < rows; first += PARALLEL_FILTER_CHUNK_ROWS)
+        chunks.append(first);
+    SortKey *keys = m_sortKeys.data();
+    QtConcurrent::blockingMap(chunks, [this, rows, keys](int first) {
+        const int last = qMin(first + PARALLEL_FILTER_CHUNK_ROWS, rows);
+        for (int row = first; row < last; ++row)
+            keys[row] = sortKey(row);
+    });
+    return true;
+}
+
+RowRanges TaskProxyModel::matchingSourceRanges() const
+{
+    // rowCount() создаёт отображение прокси, если его ещё нет: при этом
+    // прокси оценивает все строки, и карта принятых строк заполняется
+    rowCount();
+
+    RowRanges ranges;
+    if (!sourceModel())
+        return ranges;
+
+    const int rows = sourceModel()->rowCount();
+    const int words = qMin(int(m_acceptedRows.size()), (rows + 63) / 64);
+    for (int word = 0; word < words; ++word)
+    {
+        quint64 bits = m_acceptedRows[word];
+        if (word == (rows - 1) / 64 && rows % 64)
+            bits &= (quint64(1) << (rows % 64)) - 1;
+
+        // Серии единиц слова добавляются целиком, смежные серии соседних
+        // слов объединяет RowRanges::append()
+        const int base = word * 64;
+        while (bits)
+        {
+            const int start = qCountTrailingZeroBits(bits);
+            const quint64 rest = ~(bits >> start);
+            const int length = rest ? int(qCountTrailingZeroBits(rest)) : 64 - start;
+            ranges.append(base + start, base + start + length - 1);
+            bits = start + length < 64 ? bits & (~quint64(0) << (start + length)) : 0;
+        }
+    }
+    return ranges;
+}
+
+RowRanges TaskProxyModel::mapSelectionToSourceRanges(const QItemSelection &selection) const
+{
+    // Выделение всех строк прокси ("Выбрать все") совпадает с принятыми строками
+    const int proxyRows = rowCount();
+    if (selection.size() == 1 && !selection.first().parent().isValid()
+        && selection.first().top() == 0 && selection.first().bottom() == proxyRows - 1)
+        return matchingSourceRanges();
+
+    RowRanges ranges;
+    for (const QItemSelectionRange &range : selection)
+    {
+        if (range.parent().isValid())
+            continue;
+
+        for (int row = range.top(); row <= range.bottom(); ++row)
+        {
+            const int sourceRow = mapToSource(index(row, 0)).row();
+            ranges.append(sourceRow, sourceRow);
+        }
+    }
+    ranges.normalize();
+    return ranges;
+}
+
+void TaskProxyModel::setSortMode(SortMode mode)
+{
+    if (m_sortMode == mode)
+        return;
+
+    m_sortMode = mode;
+    const bool useKeys = buildSortKeys();
+    invalidate();
+    if (useKeys)
+    {
+        m_sortKeys.clear();
+        m_sortKeys.shrink_to_fit();
+    }
 }
 
 bool TaskProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    DRW_COUNT(FilterEvaluations);
+
+    // Решение запоминается в карте: прокси вызывает метод ровно тогда, когда
+    // переоценивает строку, поэтому карта совпадает с показанными строками
+    const bool accepted = acceptsRow(source_row, source_parent);
+    if (!source_parent.isValid() && source_row >= 0)
+    {
+        const size_t word = size_t(source_row) / 64;
+        if (word >= m_acceptedRows.size())
+            m_acceptedRows.resize(word + 1, 0);
+        const quint64 bit = quint64(1) << (source_row % 64);
+        if (accepted)
+            m_acceptedRows[word] |= bit;
+        else
+            m_acceptedRows[word] &= ~bit;
+    }
+    return accepted;
+}
+
+bool TaskProxyModel::acceptsRow(int source_row, const QModelIndex &source_parent) const
 {
     // Режим "Все задачи" - показываем всё
     if (m_filterType == All)
         return true;
 
-    const QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
-    const bool isRunning = sourceModel()->data(index, TaskModel::RunningRole).toBool();
+    bool isRunning = false;
+    TaskModel::RowSnapshot snapshot;
+    if (source_row < m_bitmapRows && !source_parent.isValid())
+        isRunning = (m_runningRows[source_row / 64] >> (source_row % 64)) & 1;
+    else if (m_taskModel && !source_parent.isValid() && m_taskModel->rowSnapshot(source_row, snapshot, 0))
+        isRunning = snapshot.running;
+    else
+    {
+        const QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
+        isRunning = sourceModel()->data(index, TaskModel::RunningRole).toBool();
+    }
 
     // Фильтрация по статусу выполнения
     switch (m_filterType) {
@@ -42,9 +256,112 @@ bool TaskProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_
     }
 }
 
+quint64 TaskProxyModel::acceptedBits(size_t first) const
+{
+    const size_t word = first / 64;
+    const int shift = int(first % 64);
+    if (word >= m_acceptedRows.size())
+        return 0;
+    quint64 bits = m_acceptedRows[word] >> shift;
+    if (shift && word + 1 < m_acceptedRows.size())
+        bits |= m_acceptedRows[word + 1] << (64 - shift);
+    return bits;
+}
+
+void TaskProxyModel::writeAcceptedBits(size_t first, quint64 bits, int count)
+{
+    const size_t word = first / 64;
+    const int shift = int(first % 64);
+    const quint64 mask = count < 64 ? (quint64(1) << count) - 1 : ~quint64(0);
+    bits &= mask;
+
+    m_acceptedRows[word] = (m_acceptedRows[word] & ~(mask << shift)) | (bits << shift);
+    if (shift && shift + count > 64)
+    {
+        const quint64 highMask = mask >> (64 - shift);
+        m_acceptedRows[word + 1] = (m_acceptedRows[word + 1] & ~highMask) | (bits >> (64 - shift));
+    }
+}
+
+void TaskProxyModel::insertAcceptedBits(int first, int count)
+{
+    const size_t total = m_acceptedRows.size() * 64;
+    if (count <= 0 || size_t(first) >= total)
+        return;
+
+    // Хвост сдвигается словами с конца, чтобы не затереть ещё не прочитанные биты
+    m_acceptedRows.resize((total + size_t(count) + 63) / 64, 0);
+    for (size_t tail = total - size_t(first); tail > 0;)
+    {
+        const int n = int(qMin<size_t>(64, tail));
+        tail -= size_t(n);
+        writeAcceptedBits(size_t(first) + tail + size_t(count), acceptedBits(size_t(first) + tail), n);
+    }
+
+    // Новые строки ещё не оценены; прокси оценит их в rowsInserted
+    for (size_t row = size_t(first); row < size_t(first) + size_t(count); row += 64)
+        writeAcceptedBits(row, 0, int(qMin<size_t>(64, size_t(first) + size_t(count) - row)));
+}
+
+void TaskProxyModel::removeAcceptedBits(int first, int count)
+{
+    const size_t total = m_acceptedRows.size() * 64;
+    if (count <= 0 || size_t(first) >= total)
+        return;
+
+    // Хвост сдвигается словами с начала: источник всегда правее приёмника
+    const size_t remaining = total - qMin(total, size_t(first) + size_t(count));
+    for (size_t done = 0; done < remaining; done += 64)
+    {
+        const int n = int(qMin<size_t>(64, remaining - done));
+        writeAcceptedBits(size_t(first) + done, acceptedBits(size_t(first) + size_t(count) + done), n);
+    }
+    const size_t end = size_t(first) + remaining;
+    m_acceptedRows.resize((end + 63) / 64);
+    if (end % 64)
+        m_acceptedRows.back() &= (quint64(1) << (end % 64)) - 1;
+}
+
 bool TaskProxyModel::lessThan(const QModelIndex &source_left,
                                const QModelIndex &source_right) const
 {
+    if (m_taskModel)
+    {
+        const int leftRow = source_left.row();
+        const int rightRow = source_right.row();
+        const int keyRows = static_cast<int>(m_sortKeys.size());
+        if (leftRow < keyRows && rightRow < keyRows)
+            return keyLessThan(m_sortKeys[leftRow], m_sortKeys[rightRow], leftRow, rightRow);
+        return snapshotLessThan(leftRow, rightRow);
+    }
+
+    // Архив упорядочен по времени архивации и всегда старше текущих задач:
+    // сравнение по номеру строки не загружает страницы архива
+    const bool leftArchived = sourceModel()->data(source_left, TaskModel::ArchivedRole).toBool();
+    const bool rightArchived = sourceModel()->data(source_right, TaskModel::ArchivedRole).toBool();
+    if (leftArchived || rightArchived)
+    {
+        if (leftArchived != rightArchived)
+            return leftArchived;
+        return source_left.row() < source_right.row();
+    }
+
+    if (m_sortMode == ByEta)
+    {
+        // Задачи без оценки считаем самыми долгими
+        auto etaKey = [this](const QModelIndex &index) {
+            const qint64 eta = sourceModel()->data(index, TaskModel::EtaRole).toLongLong();
+            return eta < 0 ? std::numeric_limits<qint64>::max() : eta;
+        };
+
+        const qint64 leftEta = etaKey(source_left);
+        const qint64 rightEta = etaKey(source_right);
+
+        // Порядок убывающий, поэтому меньшая оценка должна считаться "большей"
+        if (leftEta != rightEta)
+            return leftEta > rightEta;
+    }
+
     // Получаем даты создания для сравнения
     const QDateTime leftDate = sourceModel()->data(source_left, TaskModel::DateRole).toDateTime();
     const QDateTime rightDate = sourceModel()->data(source_right, TaskModel::DateRole).toDateTime();
@@ -52,3 +369,46 @@ bool TaskProxyModel::lessThan(const QModelIndex &source_left,
     // Сортируем по убыванию даты (новые сверху)
     return leftDate < rightDate;
 }
+
+bool TaskProxyModel::snapshotLessThan(int leftRow, int rightRow) const
+{
+    return keyLessThan(sortKey(leftRow), sortKey(rightRow), leftRow, rightRow);
+}
+
+TaskProxyModel::SortKey TaskProxyModel::sortKey(int row) const
+{
+    // Признак архива не требует чтения записи, поэтому проверяется первым
+    SortKey key;
+    TaskModel::RowSnapshot snapshot;
+    m_taskModel->rowSnapshot(row, snapshot, 0);
+    key.archived = snapshot.archived;
+    if (key.archived)
+        return key;
+
+    const int fields = m_sortMode == ByEta
+        ? TaskModel::SnapshotDate | TaskModel::SnapshotProgress
+        : TaskModel::SnapshotDate;
+    m_taskModel->rowSnapshot(row, snapshot, fields);
+    key.dateMs = snapshot.dateMs;
+
+    // Задачи без оценки считаем самыми долгими
+    if (m_sortMode == ByEta)
+        key.eta = snapshot.etaMs < 0 ? std::numeric_limits<qint64>::max() : snapshot.etaMs;
+    return key;
+}
+
+bool TaskProxyModel::keyLessThan(const SortKey &left, const SortKey &right, int leftRow, int rightRow) const
+{
+    if (left.archived || right.archived)
+    {
+        if (left.archived != right.archived)
+            return left.archived;
+        return leftRow < rightRow;
+    }
+
+    // Порядок по оценке убывающий
+    if (m_sortMode == ByEta && left.eta != right.eta)
+        return left.eta > right.eta;
+
+    return left.dateMs < right.dateMs;
+}
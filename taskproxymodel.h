@@ -1,6 +1,10 @@
 #pragma once
 
+#include <QItemSelection>
 #include <QSortFilterProxyModel>
+#include <vector>
+#include "rowranges.h"
+#include "taskmodel.h"
 
 /**
  * @class TaskProxyModel
@@ -9,7 +13,19 @@
  * TaskProxyModel предоставляет возможность фильтрации и сортировки задач
  * без изменения исходной модели данных. Поддерживает три режима фильтрации:
  * все задачи, только активные (выполняющиеся) и только неактивные.
- * Автоматически сортирует задачи по дате создания (новые сверху).
+ * Сортирует задачи по дате создания (новые сверху) или по оценке
+ * оставшегося времени выполнения (ближайшие к завершению сверху).
+ *
+ * При смене фильтра в больших моделях TaskModel состояние задач
+ * вычисляется параллельно (QtConcurrent) в битовую карту, по которой затем
+ * выполняется проход invalidateFilter() без обращений к data(). Ключи
+ * сортировки строк на время прохода фильтра и смены режима сортировки
+ * снимаются заранее (в больших моделях - так же параллельно), поэтому все
+ * сравнения одной сортировки видят одни и те же значения.
+ *
+ * Если исходная модель - TaskModel, фильтр и сравнение читают строки через
+ * TaskModel::rowSnapshot() без построения QVariant; для других моделей
+ * используются роли.
  *
  * @note Наследует QSortFilterProxyModel для прозрачной работы с исходной моделью
  */
@@ -18,6 +34,12 @@ class TaskProxyModel : public QSortFilterProxyModel
     Q_OBJECT
 
 public:
+    /// Наименьшее количество строк для параллельного вычисления фильтра
+    static constexpr int PARALLEL_FILTER_MIN_ROWS = 100000;
+
+    /// Количество строк в части параллельного вычисления (кратно 64)
+    static constexpr int PARALLEL_FILTER_CHUNK_ROWS = 64 * 1024;
+
     /**
      * @enum FilterType
      * @brief Типы фильтрации задач
@@ -29,6 +51,16 @@ public:
     };
     Q_ENUM(FilterType)
 
+    /**
+     * @enum SortMode
+     * @brief Режимы сортировки задач
+     */
+    enum SortMode {
+        ByDate = 0,   ///< По дате создания (новые сверху)
+        ByEta = 1     ///< По оставшемуся времени (ближайшие к завершению сверху)
+    };
+    Q_ENUM(SortMode)
+
     /**
      * @brief Конструктор прокси-модели
      * @param parent Родительский объект
@@ -49,6 +81,76 @@ public:
      */
     FilterType filterType() const { return m_filterType; }
 
+    /**
+     * @brief Установить режим сортировки
+     * @param mode Режим сортировки
+     *
+     * Пересортировывает представление согласно новому режиму.
+     */
+    void setSortMode(SortMode mode);
+
+    /**
+     * @brief Получить текущий режим сортировки
+     * @return Активный режим сортировки
+     */
+    SortMode sortMode() const { return m_sortMode; }
+
+    /**
+     * @brief Задать порог параллельного вычисления фильтра
+     * @param rows Наименьшее количество строк; 0 или меньше - всегда
+     *             вычислять последовательно
+     */
+    void setParallelFilterThreshold(int rows) { m_parallelFilterThreshold = rows; }
+
+    /**
+     * @brief Установить исходную модель
+     * @param sourceModel Исходная модель
+     */
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    /**
+     * @brief Прочитать данные строки прокси без построения QVariant
+     * @param index Индекс строки прокси
+     * @param snapshot Данные строки (выходной параметр)
+     * @param fields Набор TaskModel::SnapshotFields
+     * @return false, если исходная модель не TaskModel или индекс невалиден
+     */
+    bool rowSnapshot(const QModelIndex &index, TaskModel::RowSnapshot &snapshot,
+                     int fields = TaskModel::SnapshotAll) const;
+
+    /**
+     * @brief Отметить изменение прогресса строки прокси отрисованным
+     * @param index Индекс строки прокси
+     *
+     * Переводит строку через mapToSource() в TaskModel::markRowPainted();
+     * для исходной модели другого типа ничего не делает.
+     */
+    void markRowPainted(const QModelIndex &index) const;
+
+    /**
+     * @brief Получить строки исходной модели, проходящие текущий фильтр
+     * @return Диапазоны строк исходной модели
+     *
+     * Строится по карте m_acceptedRows, в которую filterAcceptsRow()
+     * записывает каждое решение прокси, поэтому совпадает с тем, что
+     * показано, даже если состояние задач изменилось после последнего
+     * прохода фильтра. Пустые слова карты пропускаются, заполненные
+     * добавляются одним диапазоном: O(строк/64 + диапазонов) без mapToSource().
+     */
+    RowRanges matchingSourceRanges() const;
+
+    /**
+     * @brief Перевести выделение прокси в строки исходной модели
+     * @param selection Выделение в строках прокси
+     * @return Диапазоны строк исходной модели
+     *
+     * Выделение всех строк прокси переводится через matchingSourceRanges().
+     * Остальные диапазоны выделения переводятся построчно через
+     * mapToSource() без построения списка индексов; строки исходной модели
+     * объединяются в диапазоны через RowRanges::normalize().
+     */
+    RowRanges mapSelectionToSourceRanges(const QItemSelection &selection) const;
+
 protected:
     /**
      * @brief Проверить, соответствует ли строка текущему фильтру
@@ -58,6 +160,8 @@ protected:
      *
      * Виртуальный метод QSortFilterProxyModel, определяющий логику фильтрации.
      * Проверяет статус выполнения задачи и сравнивает с текущим типом фильтра.
+     * Во время прохода по битовой карте состояние берётся из неё. Решение
+     * для строки верхнего уровня записывается в m_acceptedRows.
      */
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
 
@@ -67,10 +171,122 @@ protected:
      * @param source_right Индекс второго элемента
      * @return true если левый элемент должен быть раньше правого
      *
-     * Сортирует задачи по дате создания в порядке убывания (новые сверху).
+     * В режиме ByDate сортирует задачи по дате создания в порядке убывания
+     * (новые сверху). В режиме ByEta ближайшие к завершению задачи идут
+     * сверху, задачи без оценки - в конце списка. Во время проходов
+     * setFilterType() и setSortMode() сравниваются ключи m_sortKeys, при
+     * динамической пересортировке изменившихся строк - текущие значения.
      */
     bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
 
 private:
+    /**
+     * @brief Проверить строку по текущему фильтру
+     * @param source_row Номер строки в исходной модели
+     * @param source_parent Родительский индекс в исходной модели
+     * @return true если строка проходит фильтр
+     */
+    bool acceptsRow(int source_row, const QModelIndex &source_parent) const;
+
+    /**
+     * @brief Прочитать 64 бита карты принятых строк
+     * @param first Номер первого бита
+     * @return Биты начиная с first; биты за концом карты равны 0
+     */
+    quint64 acceptedBits(size_t first) const;
+
+    /**
+     * @brief Записать биты в карту принятых строк
+     * @param first Номер первого бита
+     * @param bits Значения битов (младшие count)
+     * @param count Количество битов (1..64)
+     */
+    void writeAcceptedBits(size_t first, quint64 bits, int count);
+
+    /**
+     * @brief Сдвинуть карту принятых строк при вставке строк
+     * @param first Первая вставляемая строка
+     * @param count Количество строк
+     *
+     * Вызывается до rowsInserted, поэтому прокси записывает решения для
+     * новых строк уже в сдвинутую карту.
+     */
+    void insertAcceptedBits(int first, int count);
+
+    /**
+     * @brief Сдвинуть карту принятых строк после удаления строк
+     * @param first Первая удалённая строка
+     * @param count Количество строк
+     */
+    void removeAcceptedBits(int first, int count);
+
+    /**
+     * @brief Вычислить состояние строк параллельно
+     * @return true если битовая карта заполнена
+     *
+     * Делит строки исходной модели на части по PARALLEL_FILTER_CHUNK_ROWS
+     * и заполняет m_runningRows в пуле потоков, блокируя поток GUI до
+     * завершения всех частей.
+     */
+    bool buildRunningBitmap();
+
+    /**
+     * @brief Сравнить две строки TaskModel по данным без QVariant
+     * @param leftRow Строка исходной модели
+     * @param rightRow Строка исходной модели
+     * @return Результат lessThan() для этих строк
+     */
+    bool snapshotLessThan(int leftRow, int rightRow) const;
+
+    /**
+     * @struct SortKey
+     * @brief Ключ сортировки строки TaskModel
+     */
+    struct SortKey
+    {
+        qint64 eta{0};         ///< Оценка оставшегося времени, мс (без оценки - максимум; только ByEta)
+        qint64 dateMs{0};      ///< Дата создания (мс от эпохи)
+        bool archived{false};  ///< Строка из архива (остальные поля не заполняются)
+    };
+
+    /**
+     * @brief Прочитать ключ сортировки строки для текущего режима
+     * @param row Строка исходной модели
+     * @return Ключ сортировки
+     *
+     * Запись архива не читается. Для разных строк метод можно вызывать из
+     * рабочих потоков, пока поток модели ожидает их завершения.
+     */
+    SortKey sortKey(int row) const;
+
+    /**
+     * @brief Сравнить ключи сортировки двух строк
+     * @param left Ключ первой строки
+     * @param right Ключ второй строки
+     * @param leftRow Строка исходной модели первого ключа
+     * @param rightRow Строка исходной модели второго ключа
+     * @return Результат lessThan() для этих строк
+     */
+    bool keyLessThan(const SortKey &left, const SortKey &right, int leftRow, int rightRow) const;
+
+    /**
+     * @brief Снять ключи сортировки всех строк на время прохода
+     * @return true если m_sortKeys заполнен (исходная модель - TaskModel)
+     *
+     * Оценка оставшегося времени в режиме вычисляемого прогресса убывает
+     * со временем, поэтому все сравнения одного прохода используют ключи,
+     * снятые один раз. Модели не меньше порога параллельного вычисления
+     * обрабатываются в пуле потоков, остальные - последовательно.
+     */
+    bool buildSortKeys();
+
     FilterType m_filterType;  ///< Текущий тип фильтра
+    SortMode m_sortMode;      ///< Текущий режим сортировки
+    const TaskModel *m_taskModel{nullptr}; ///< Исходная модель, если это TaskModel
+    int m_parallelFilterThreshold{PARALLEL_FILTER_MIN_ROWS}; ///< Порог параллельного вычисления фильтра
+    std::vector<quint64> m_runningRows{}; ///< Битовая карта выполняющихся строк на время прохода фильтра
+    int m_bitmapRows{0};      ///< Количество строк в битовой карте (0 - карты нет)
+    std::vector<SortKey> m_sortKeys{}; ///< Ключи сортировки строк на время прохода (пусто - ключей нет)
+    mutable std::vector<quint64> m_acceptedRows{}; ///< Битовая карта строк, принятых прокси при последней оценке
+    QList<QMetaObject::Connection> m_sourceConnections{}; ///< Подключения к сигналам исходной модели
 };
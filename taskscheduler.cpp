@@ -0,0 +1,80 @@
+#include "taskscheduler.h"
+#include "monotonicclock.h"
+#include "task.h"
+#include <limits>
+
+TaskScheduler::TaskScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TaskScheduler::processDue);
+}
+
+void TaskScheduler::schedule(Task *task, qint64 deadlineNs, quint64 generation)
+{
+    m_queue.push({deadlineNs, task, generation});
+    if (m_armedNs < 0 || deadlineNs < m_armedNs)
+        arm();
+}
+
+void TaskScheduler::clear()
+{
+    m_queue = {};
+    m_timer->stop();
+    m_armedNs = -1;
+}
+
+int TaskScheduler::discardStale()
+{
+    std::vector<Entry> actual;
+    actual.reserve(m_queue.size());
+    int discarded = 0;
+    while (!m_queue.empty())
+    {
+        const Entry entry = m_queue.top();
+        m_queue.pop();
+        if (entry.generation == entry.task->scheduleGeneration())
+            actual.push_back(entry);
+        else
+            ++discarded;
+    }
+
+    m_queue = decltype(m_queue)(std::greater<Entry>(), std::move(actual));
+    arm();
+    return discarded;
+}
+
+void TaskScheduler::processDue()
+{
+    m_armedNs = -1;
+
+    const qint64 now = MonotonicClock::nsecs();
+    while (!m_queue.empty() && m_queue.top().deadlineNs <= now)
+    {
+        const Entry entry = m_queue.top();
+        m_queue.pop();
+
+        // Обработчик может запланировать новые события, поэтому очередь не кэшируем
+        entry.task->fireScheduledEvent(entry.generation);
+    }
+
+    arm();
+}
+
+void TaskScheduler::arm()
+{
+    if (m_queue.empty())
+    {
+        m_timer->stop();
+        m_armedNs = -1;
+        return;
+    }
+
+    m_armedNs = m_queue.top().deadlineNs;
+    const qint64 delayNs = m_armedNs - MonotonicClock::nsecs();
+
+    // Округляем вверх, чтобы не срабатывать раньше срока
+    m_timer->start(static_cast<int>(qBound<qint64>(0, (delayNs + 999999) / 1000000, std::numeric_limits<int>::max())));
+}
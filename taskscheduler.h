@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <functional>
+#include <queue>
+#include <vector>
+
+class Task;
+
+/**
+ * @class TaskScheduler
+ * @brief Общий планировщик отложенных событий задач
+ *
+ * Хранит события в очереди с приоритетом по времени срабатывания и
+ * держит один таймер, взведённый на ближайшее событие. Используется
+ * задачами с вычисляемым прогрессом: каждой выполняющейся задаче
+ * соответствует одно событие в момент её завершения.
+ *
+ * Отмена события не удаляет его из очереди: задача увеличивает своё
+ * поколение расписания, и устаревшее событие пропускается при срабатывании.
+ */
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Конструктор
+     * @param parent Родительский объект
+     */
+    explicit TaskScheduler(QObject *parent = nullptr);
+
+    /**
+     * @brief Запланировать событие задачи
+     * @param task Задача
+     * @param deadlineNs Момент срабатывания (MonotonicClock, нс)
+     * @param generation Поколение расписания задачи на момент планирования
+     */
+    void schedule(Task *task, qint64 deadlineNs, quint64 generation);
+
+    /**
+     * @brief Получить количество событий в очереди
+     * @return Размер очереди, включая ещё не пропущенные устаревшие события
+     */
+    int pending() const { return static_cast<int>(m_queue.size()); }
+
+    /**
+     * @brief Отменить все события
+     *
+     * Вызывается перед уничтожением задач, на которые ссылается очередь.
+     */
+    void clear();
+
+    /**
+     * @brief Удалить из очереди устаревшие события
+     * @return Количество удалённых событий
+     *
+     * Вызывается перед уничтожением задач, возвращённых в пул: их события
+     * уже устарели, но ещё ссылаются на задачи.
+     */
+    int discardStale();
+
+private slots:
+    /**
+     * @brief Выполнить наступившие события и перевзвести таймер
+     */
+    void processDue();
+
+private:
+    /**
+     * @struct Entry
+     * @brief Запланированное событие
+     */
+    struct Entry
+    {
+        qint64 deadlineNs;   ///< Момент срабатывания (нс)
+        Task *task;          ///< Задача
+        quint64 generation;  ///< Поколение расписания задачи
+
+        bool operator>(const Entry &other) const { return deadlineNs > other.deadlineNs; }
+    };
+
+    /**
+     * @brief Взвести таймер на ближайшее событие
+     */
+    void arm();
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_queue; ///< События по времени
+    QTimer *m_timer{nullptr};  ///< Таймер ближайшего события
+    qint64 m_armedNs{-1};      ///< Момент, на который взведён таймер (-1 - не взведён)
+};
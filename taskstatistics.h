@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <QtGlobal>
+#include "task.h"
+
+/**
+ * @struct TaskStatistics
+ * @brief Агрегированные счётчики состояния задач
+ *
+ * Поддерживается моделью TaskModel инкрементально: каждое изменение
+ * состояния или прогресса задачи обновляет счётчики за O(1), поэтому
+ * получение сводки не требует обхода всех строк модели.
+ */
+struct TaskStatistics
+{
+    /// Количество корзин гистограммы прогресса (по одной на каждый процент)
+    static constexpr int HISTOGRAM_SIZE = Task::MAX_PROGRESS + 1;
+
+    int running{0};                             ///< Выполняющиеся задачи
+    int stopped{0};                             ///< Остановленные незавершённые задачи
+    int completed{0};                           ///< Завершённые задачи (100%)
+    int total{0};                               ///< Общее количество задач
+    qint64 progressSum{0};                      ///< Сумма прогресса всех задач
+    qint64 estimatedCompletionMs{-1};           ///< Оценка времени до завершения всех выполняющихся задач (мс, -1 - нет оценки)
+    std::array<int, HISTOGRAM_SIZE> histogram{}; ///< Количество задач по значению прогресса
+
+    /**
+     * @brief Получить количество неактивных задач
+     * @return Остановленные и завершённые задачи
+     */
+    int inactive() const { return stopped + completed; }
+
+    /**
+     * @brief Получить средний прогресс по всем задачам
+     * @return Средний прогресс [0, 100] или 0 для пустой модели
+     */
+    int averageProgress() const
+    {
+        return total > 0 ? static_cast<int>(progressSum / total) : 0;
+    }
+};
@@ -0,0 +1,545 @@
+#include "tasktreemodel.h"
+#include "taskmodel.h"
+#include "task.h"
+#include <algorithm>
+
+/**
+ * @struct TaskTreeModel::Node
+ * @brief Узел дерева: группа или задача
+ */
+struct TaskTreeModel::Node
+{
+    Node *parent{nullptr};                       ///< Родительская группа
+    QString name;                                ///< Название группы или задачи без пути
+    quint64 taskId{0};                           ///< Идентификатор задачи (0 - группа)
+    int row{0};                                  ///< Строка в родительской группе
+    std::vector<std::unique_ptr<Node>> children; ///< Дочерние группы и задачи
+    QHash<QString, Node*> groups;                ///< Дочерние группы по названию
+    int first{0};                                ///< Номер задачи или первой задачи группы в порядке обхода
+    int end{0};                                  ///< Номер за последней задачей группы
+    int progress{0};                             ///< Прогресс задачи, учтённый в сводке
+    bool running{false};                         ///< Состояние задачи, учтённое в сводке
+    quint32 mark{0};                             ///< Отметка сверки с моделью
+
+    bool isGroup() const { return taskId == 0; }
+};
+
+TaskTreeModel::TaskTreeModel(TaskModel *model, QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_model(model)
+    , m_root(std::make_unique<Node>())
+{
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &TaskTreeModel::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &TaskTreeModel::onRowsRemoved);
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &TaskTreeModel::onDataChanged);
+    connect(m_model, &QAbstractItemModel::layoutChanged, this, &TaskTreeModel::resync);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &TaskTreeModel::resync);
+
+    resync();
+}
+
+TaskTreeModel::~TaskTreeModel() = default;
+
+QModelIndex TaskTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const Node *node = nodeOf(parent);
+    if (column != 0 || row < 0 || row >= static_cast<int>(node->children.size()))
+        return QModelIndex();
+    return createIndex(row, 0, node->children[row].get());
+}
+
+QModelIndex TaskTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+    return indexOf(nodeOf(child)->parent);
+}
+
+int TaskTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    return static_cast<int>(nodeOf(parent)->children.size());
+}
+
+int TaskTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+QVariant TaskTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Node *node = nodeOf(index);
+    if (!node->isGroup())
+    {
+        switch (role)
+        {
+        case TaskModel::NameRole:
+        case Qt::DisplayRole:
+            return node->name;
+        case GroupRole:
+            return false;
+        case TaskCountRole:
+            return 1;
+        case RunningCountRole:
+            return node->running ? 1 : 0;
+        default:
+            return m_model->data(m_model->index(m_model->rowOfTask(node->taskId)), role);
+        }
+    }
+
+    ensureAggregates();
+    const int count = node->end - node->first;
+    switch (role)
+    {
+    case TaskModel::NameRole:
+    case Qt::DisplayRole:
+        return node->name;
+    case TaskModel::ProgressRole:
+        return count > 0 ? static_cast<int>(m_progressSums.sum(node->first, node->end) / count) : 0;
+    case TaskModel::RunningRole:
+        return m_runningCounts.sum(node->first, node->end) > 0;
+    case TaskModel::ArchivedRole:
+        return false;
+    case GroupRole:
+        return true;
+    case TaskCountRole:
+        return count;
+    case RunningCountRole:
+        return static_cast<int>(m_runningCounts.sum(node->first, node->end));
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> TaskTreeModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = m_model->roleNames();
+    roles[GroupRole] = "group";
+    roles[TaskCountRole] = "taskCount";
+    roles[RunningCountRole] = "runningCount";
+    return roles;
+}
+
+bool TaskTreeModel::isGroup(const QModelIndex &index) const
+{
+    return index.isValid() && nodeOf(index)->isGroup();
+}
+
+int TaskTreeModel::sourceRow(const QModelIndex &index) const
+{
+    if (!index.isValid() || nodeOf(index)->isGroup())
+        return -1;
+    return m_model->rowOfTask(nodeOf(index)->taskId);
+}
+
+void TaskTreeModel::markRowPainted(const QModelIndex &index) const
+{
+    m_model->markRowPainted(sourceRow(index));
+}
+
+QString TaskTreeModel::verifyAggregates() const
+{
+    ensureAggregates();
+    if (static_cast<int>(m_leafOrder.size()) != m_leafById.size() || m_root->end != m_leafById.size())
+        return QString("задач в порядке обхода %1, в индексе %2")
+            .arg(m_leafOrder.size()).arg(m_leafById.size());
+
+    std::vector<const Node*> groups{m_root.get()};
+    while (!groups.empty())
+    {
+        const Node *group = groups.back();
+        groups.pop_back();
+
+        qint64 progress = 0;
+        qint64 running = 0;
+        for (int position = group->first; position < group->end; ++position)
+        {
+            const Node *leaf = m_leafOrder[position];
+            progress += leaf->progress;
+            running += leaf->running ? 1 : 0;
+        }
+        if (progress != m_progressSums.sum(group->first, group->end)
+            || running != m_runningCounts.sum(group->first, group->end))
+            return QString("группа \"%1\": прогресс %2/%3, выполняется %4/%5")
+                .arg(group->name).arg(progress).arg(m_progressSums.sum(group->first, group->end))
+                .arg(running).arg(m_runningCounts.sum(group->first, group->end));
+
+        for (const auto &child : group->children)
+        {
+            if (child->isGroup())
+                groups.push_back(child.get());
+        }
+    }
+    return QString();
+}
+
+QList<int> TaskTreeModel::sourceRows(const QModelIndex &index) const
+{
+    QList<int> rows;
+    if (!index.isValid())
+        return rows;
+
+    ensureAggregates();
+    const Node *node = nodeOf(index);
+    const int end = node->isGroup() ? node->end : node->first + 1;
+    rows.reserve(end - node->first);
+    for (int position = node->first; position < end; ++position)
+    {
+        const int row = m_model->rowOfTask(m_leafOrder[position]->taskId);
+        if (row >= 0)
+            rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+void TaskTreeModel::startGroup(const QModelIndex &index)
+{
+    m_model->startTasks(sourceRows(index));
+}
+
+void TaskTreeModel::stopGroup(const QModelIndex &index)
+{
+    m_model->stopTasks(sourceRows(index));
+}
+
+void TaskTreeModel::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    m_leafOfRow.insert(m_leafOfRow.begin() + first, last - first + 1, nullptr);
+
+    // Строки архива в дерево не попадают
+    const int taskRows = m_model->rowCount() - m_model->archivedRowCount();
+    QList<int> rows;
+    for (int row = first; row <= last && row < taskRows; ++row)
+        rows.append(row);
+    insertTasks(rows);
+}
+
+void TaskTreeModel::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+
+    QList<Node*> leaves;
+    for (int row = first; row <= last && row < static_cast<int>(m_leafOfRow.size()); ++row)
+    {
+        if (m_leafOfRow[row])
+            leaves.append(m_leafOfRow[row]);
+    }
+    m_leafOfRow.erase(m_leafOfRow.begin() + qMin<int>(first, static_cast<int>(m_leafOfRow.size())),
+                      m_leafOfRow.begin() + qMin<int>(last + 1, static_cast<int>(m_leafOfRow.size())));
+    removeTasks(leaves);
+}
+
+void TaskTreeModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (topLeft.parent().isValid())
+        return;
+
+    // Изменения одной группы сообщаются одним диапазоном строк
+    QHash<Node*, QPair<int, int>> changedRows;
+    const int last = qMin(bottomRight.row(), static_cast<int>(m_leafOfRow.size()) - 1);
+    for (int row = topLeft.row(); row <= last; ++row)
+    {
+        Node *leaf = m_leafOfRow[row];
+        const Task *task = leaf ? m_model->getTask(row) : nullptr;
+        if (!task)
+            continue;
+
+        // Строки хранилища завершённых задач не меняются
+        const int progress = task->getProgress();
+        const bool running = task->isRunning();
+        if (progress == leaf->progress && running == leaf->running)
+            continue;
+
+        if (!m_aggregatesDirty)
+        {
+            m_progressSums.add(leaf->first, progress - leaf->progress);
+            m_runningCounts.add(leaf->first, int(running) - int(leaf->running));
+        }
+        leaf->progress = progress;
+        leaf->running = running;
+
+        auto it = changedRows.find(leaf->parent);
+        if (it == changedRows.end())
+            changedRows.insert(leaf->parent, {leaf->row, leaf->row});
+        else
+            *it = {qMin(it->first, leaf->row), qMax(it->second, leaf->row)};
+    }
+
+    QSet<Node*> groups;
+    for (auto it = changedRows.cbegin(); it != changedRows.cend(); ++it)
+    {
+        Node *group = it.key();
+        emit dataChanged(index(it->first, 0, indexOf(group)), index(it->second, 0, indexOf(group)));
+        groups.insert(group);
+    }
+    notifyGroups(groups);
+}
+
+void TaskTreeModel::resync()
+{
+    // Перестановка строк (перенос в хранилище) и сброс модели сверяются по идентификаторам
+    const int taskRows = m_model->rowCount() - m_model->archivedRowCount();
+    ++m_resyncMark;
+
+    std::vector<Node*> leafOfRow(m_model->rowCount(), nullptr);
+    QList<int> added;
+    for (int row = 0; row < taskRows; ++row)
+    {
+        Node *leaf = m_leafById.value(m_model->taskId(row), nullptr);
+        if (leaf)
+        {
+            leaf->mark = m_resyncMark;
+            leafOfRow[row] = leaf;
+        }
+        else
+            added.append(row);
+    }
+
+    QList<Node*> removed;
+    for (Node *leaf : std::as_const(m_leafById))
+    {
+        if (leaf->mark != m_resyncMark)
+            removed.append(leaf);
+    }
+
+    m_leafOfRow = std::move(leafOfRow);
+    removeTasks(removed);
+    insertTasks(added);
+}
+
+TaskTreeModel::Node *TaskTreeModel::nodeOf(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+}
+
+QModelIndex TaskTreeModel::indexOf(const Node *node) const
+{
+    if (!node || node == m_root.get())
+        return QModelIndex();
+    return createIndex(node->row, 0, const_cast<Node*>(node));
+}
+
+TaskTreeModel::Node *TaskTreeModel::ensureGroup(const QStringList &path)
+{
+    Node *node = m_root.get();
+    for (const QString &name : path)
+    {
+        if (name.isEmpty())
+            continue;
+
+        Node *group = node->groups.value(name, nullptr);
+        if (!group)
+        {
+            auto created = std::make_unique<Node>();
+            created->parent = node;
+            created->name = name;
+            created->row = static_cast<int>(node->children.size());
+            group = created.get();
+
+            beginInsertRows(indexOf(node), group->row, group->row);
+            node->children.push_back(std::move(created));
+            node->groups.insert(name, group);
+            m_aggregatesDirty = true;
+            endInsertRows();
+        }
+        node = group;
+    }
+    return node;
+}
+
+void TaskTreeModel::insertTasks(const QList<int> &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    // Задачи собираются по группам в порядке первого появления группы
+    std::vector<std::pair<Node*, std::vector<std::unique_ptr<Node>>>> pending;
+    QHash<Node*, int> pendingIndex;
+    for (int row : rows)
+    {
+        const QModelIndex source = m_model->index(row);
+        const QString name = source.data(TaskModel::NameRole).toString();
+        QStringList path = name.split(QLatin1Char(GROUP_SEPARATOR));
+
+        auto leaf = std::make_unique<Node>();
+        leaf->taskId = m_model->taskId(row);
+        leaf->name = path.last().isEmpty() ? name : path.last();
+        leaf->progress = source.data(TaskModel::ProgressRole).toInt();
+        leaf->running = source.data(TaskModel::RunningRole).toBool();
+        leaf->mark = m_resyncMark;
+        m_leafOfRow[row] = leaf.get();
+        m_leafById.insert(leaf->taskId, leaf.get());
+
+        path.removeLast();
+        Node *group = ensureGroup(path);
+        auto it = pendingIndex.constFind(group);
+        if (it == pendingIndex.constEnd())
+        {
+            it = pendingIndex.insert(group, static_cast<int>(pending.size()));
+            pending.emplace_back(group, std::vector<std::unique_ptr<Node>>());
+        }
+        pending[*it].second.push_back(std::move(leaf));
+    }
+
+    QSet<Node*> groups;
+    for (auto &[group, leaves] : pending)
+    {
+        const int first = static_cast<int>(group->children.size());
+        beginInsertRows(indexOf(group), first, first + static_cast<int>(leaves.size()) - 1);
+        for (auto &leaf : leaves)
+        {
+            leaf->parent = group;
+            leaf->row = static_cast<int>(group->children.size());
+            group->children.push_back(std::move(leaf));
+        }
+        m_aggregatesDirty = true;
+        endInsertRows();
+        groups.insert(group);
+    }
+    notifyGroups(groups);
+}
+
+void TaskTreeModel::removeTasks(const QList<Node*> &leaves)
+{
+    if (leaves.isEmpty())
+        return;
+
+    QHash<Node*, QList<int>> rowsByGroup;
+    for (Node *leaf : leaves)
+    {
+        rowsByGroup[leaf->parent].append(leaf->row);
+        m_leafById.remove(leaf->taskId);
+    }
+
+    QHash<Node*, QList<QPair<int, int>>> rangesByGroup;
+    int rangeCount = 0;
+    for (auto it = rowsByGroup.begin(); it != rowsByGroup.end(); ++it)
+    {
+        std::sort(it->begin(), it->end());
+        QList<QPair<int, int>> &ranges = rangesByGroup[it.key()];
+        for (int row : std::as_const(*it))
+        {
+            if (!ranges.isEmpty() && ranges.last().second + 1 == row)
+                ranges.last().second = row;
+            else
+                ranges.append({row, row});
+        }
+        rangeCount += ranges.count();
+    }
+
+    // Разрозненное удаление - одно структурное изменение, как в TaskModel::removeTasks()
+    const bool reset = rangeCount > MAX_REMOVE_RANGES;
+    if (reset)
+        beginResetModel();
+
+    for (auto it = rangesByGroup.cbegin(); it != rangesByGroup.cend(); ++it)
+    {
+        for (auto range = it->crbegin(); range != it->crend(); ++range)
+            removeChildren(it.key(), range->first, range->second, !reset);
+    }
+
+    // Опустевшие группы удаляются вместе с опустевшими предками
+    QSet<Node*> removedGroups;
+    QSet<Node*> touched;
+    for (auto it = rangesByGroup.cbegin(); it != rangesByGroup.cend(); ++it)
+    {
+        Node *group = it.key();
+        if (removedGroups.contains(group))
+            continue;
+        while (group != m_root.get() && group->children.empty())
+        {
+            Node *parent = group->parent;
+            parent->groups.remove(group->name);
+            removedGroups.insert(group);
+            removeChildren(parent, group->row, group->row, !reset);
+            group = parent;
+        }
+        touched.insert(group);
+    }
+    for (Node *group : std::as_const(removedGroups))
+        touched.remove(group);
+
+    m_aggregatesDirty = true;
+    if (reset)
+        endResetModel();
+    else
+        notifyGroups(touched);
+}
+
+void TaskTreeModel::removeChildren(Node *parent, int first, int last, bool notify)
+{
+    if (notify)
+        beginRemoveRows(indexOf(parent), first, last);
+
+    parent->children.erase(parent->children.begin() + first, parent->children.begin() + last + 1);
+    for (int row = first; row < static_cast<int>(parent->children.size()); ++row)
+        parent->children[row]->row = row;
+    m_aggregatesDirty = true;
+
+    if (notify)
+        endRemoveRows();
+}
+
+void TaskTreeModel::notifyGroups(const QSet<Node*> &groups)
+{
+    QSet<Node*> changed;
+    for (Node *group : groups)
+    {
+        for (; group && group != m_root.get() && !changed.contains(group); group = group->parent)
+            changed.insert(group);
+    }
+
+    for (Node *group : std::as_const(changed))
+    {
+        const QModelIndex index = indexOf(group);
+        emit dataChanged(index, index);
+    }
+}
+
+void TaskTreeModel::ensureAggregates() const
+{
+    if (!m_aggregatesDirty)
+        return;
+
+    std::vector<qint64> progress;
+    std::vector<qint64> running;
+    progress.reserve(m_leafById.size());
+    running.reserve(m_leafById.size());
+    m_leafOrder.clear();
+    m_leafOrder.reserve(m_leafById.size());
+
+    assignPositions(m_root.get(), progress, running);
+    m_progressSums.assign(progress);
+    m_runningCounts.assign(running);
+    m_aggregatesDirty = false;
+}
+
+void TaskTreeModel::assignPositions(Node *node, std::vector<qint64> &progress, std::vector<qint64> &running) const
+{
+    node->first = static_cast<int>(m_leafOrder.size());
+    for (const auto &child : node->children)
+    {
+        if (child->isGroup())
+        {
+            assignPositions(child.get(), progress, running);
+            continue;
+        }
+
+        child->first = static_cast<int>(m_leafOrder.size());
+        child->end = child->first + 1;
+        m_leafOrder.push_back(child.get());
+        progress.push_back(child->progress);
+        running.push_back(child->running ? 1 : 0);
+    }
+    node->end = static_cast<int>(m_leafOrder.size());
+}
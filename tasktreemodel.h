@@ -0,0 +1,224 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
+#include <memory>
+#include <vector>
+#include "fenwicktree.h"
+
+class TaskModel;
+
+/**
+ * @class TaskTreeModel
+ * @brief Дерево групп задач поверх TaskModel
+ *
+ * Группы образуются из названий задач: "Проект/Этап/задача" помещает
+ * задачу "задача" в группу "Этап" внутри группы "Проект". Задачи без
+ * разделителя находятся на верхнем уровне, строки архива в дерево не
+ * попадают.
+ *
+ * Задачи дерева пронумерованы в порядке обхода, поэтому задачи каждой
+ * группы занимают непрерывный отрезок. Суммарный прогресс и количество
+ * выполняющихся задач хранятся в деревьях Фенвика: изменение задачи
+ * обновляет их за O(log n), а сводка группы любого уровня вычисляется
+ * суммой на отрезке за O(log n). Нумерация пересчитывается за O(n) только
+ * после добавления и удаления задач, при первом обращении к сводке.
+ */
+class TaskTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /// Разделитель уровней групп в названии задачи
+    static constexpr char GROUP_SEPARATOR = '/';
+
+    /// Наибольшее количество удаляемых диапазонов, удаляемых по отдельности
+    static constexpr int MAX_REMOVE_RANGES = 16;
+
+    /**
+     * @enum TreeRoles
+     * @brief Дополнительные роли дерева (остальные роли - TaskModel::TaskRoles)
+     */
+    enum TreeRoles {
+        GroupRole = Qt::UserRole + 0x100, ///< Строка группы (bool)
+        TaskCountRole,                    ///< Количество задач группы (int, 1 для задачи)
+        RunningCountRole                  ///< Количество выполняющихся задач группы (int)
+    };
+
+    /**
+     * @brief Конструктор
+     * @param model Модель задач
+     * @param parent Родительский объект
+     *
+     * Строит дерево по текущим строкам модели и далее следует её изменениям.
+     */
+    explicit TaskTreeModel(TaskModel *model, QObject *parent = nullptr);
+
+    /**
+     * @brief Деструктор
+     */
+    ~TaskTreeModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Получить данные строки
+     * @param index Индекс строки
+     * @param role Роль TaskModel::TaskRoles или TreeRoles
+     * @return Для задачи - данные строки TaskModel (название без пути групп),
+     *         для группы - название, средний прогресс и счётчики задач
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Проверить, является ли строка группой
+     * @param index Индекс строки
+     * @return true для строки группы
+     */
+    bool isGroup(const QModelIndex &index) const;
+
+    /**
+     * @brief Получить строку задачи в TaskModel
+     * @param index Индекс строки дерева
+     * @return Строка TaskModel или -1 для группы
+     */
+    int sourceRow(const QModelIndex &index) const;
+
+    /**
+     * @brief Получить строки TaskModel всех задач группы
+     * @param index Индекс группы или задачи
+     * @return Строки задач группы на всех уровнях (для задачи - её строка)
+     */
+    QList<int> sourceRows(const QModelIndex &index) const;
+
+    /**
+     * @brief Отметить изменение прогресса задачи отрисованным
+     * @param index Индекс строки дерева (для группы ничего не делает)
+     */
+    void markRowPainted(const QModelIndex &index) const;
+
+    /**
+     * @brief Сверить суммы деревьев Фенвика с пересчётом по задачам
+     * @return Описание первого расхождения; пустая строка - расхождений нет
+     *
+     * Для каждой группы заново суммирует учтённые прогресс и состояние
+     * задач её отрезка и сравнивает с суммами деревьев Фенвика. Выполняется
+     * за O(n * глубина) и предназначен для проверок согласованности.
+     */
+    QString verifyAggregates() const;
+
+    /**
+     * @brief Запустить все задачи группы
+     * @param index Индекс группы
+     */
+    void startGroup(const QModelIndex &index);
+
+    /**
+     * @brief Остановить все задачи группы
+     * @param index Индекс группы
+     */
+    void stopGroup(const QModelIndex &index);
+
+private slots:
+    /**
+     * @brief Добавить задачи вставленных строк
+     */
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+
+    /**
+     * @brief Удалить задачи удалённых строк
+     */
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+
+    /**
+     * @brief Обновить прогресс и состояние изменившихся задач и их групп
+     */
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+    /**
+     * @brief Сверить дерево с моделью после перестановки или сброса строк
+     */
+    void resync();
+
+private:
+    struct Node;
+
+    /**
+     * @brief Получить узел строки
+     * @param index Индекс строки (невалидный - корень)
+     * @return Узел
+     */
+    Node *nodeOf(const QModelIndex &index) const;
+
+    /**
+     * @brief Получить индекс узла
+     * @param node Узел
+     * @return Индекс (невалидный для корня)
+     */
+    QModelIndex indexOf(const Node *node) const;
+
+    /**
+     * @brief Найти или создать группу
+     * @param path Названия групп от верхнего уровня
+     * @return Группа (корень для пустого пути)
+     */
+    Node *ensureGroup(const QStringList &path);
+
+    /**
+     * @brief Добавить задачи строк TaskModel
+     * @param rows Строки TaskModel по возрастанию
+     *
+     * Задачи одной группы добавляются одной вставкой в её конец.
+     */
+    void insertTasks(const QList<int> &rows);
+
+    /**
+     * @brief Удалить задачи и опустевшие группы
+     * @param leaves Узлы задач
+     */
+    void removeTasks(const QList<Node*> &leaves);
+
+    /**
+     * @brief Удалить дочерние узлы
+     * @param parent Родительский узел
+     * @param first Первая строка
+     * @param last Последняя строка
+     * @param notify Сообщать об удалении (false внутри сброса модели)
+     */
+    void removeChildren(Node *parent, int first, int last, bool notify);
+
+    /**
+     * @brief Сообщить об изменении сводки групп и их предков
+     * @param groups Изменившиеся группы
+     */
+    void notifyGroups(const QSet<Node*> &groups);
+
+    /**
+     * @brief Пересчитать нумерацию задач и деревья Фенвика, если нужно
+     */
+    void ensureAggregates() const;
+
+    /**
+     * @brief Пронумеровать задачи поддерева в порядке обхода
+     * @param node Корень поддерева
+     * @param progress Прогресс задач по номерам (выходной параметр)
+     * @param running Состояние задач по номерам (выходной параметр)
+     */
+    void assignPositions(Node *node, std::vector<qint64> &progress, std::vector<qint64> &running) const;
+
+    TaskModel *m_model;                       ///< Модель задач
+    std::unique_ptr<Node> m_root;             ///< Корень дерева
+    std::vector<Node*> m_leafOfRow{};         ///< Узлы задач по строкам TaskModel (nullptr для архива)
+    QHash<quint64, Node*> m_leafById{};       ///< Узлы задач по идентификатору
+    mutable std::vector<Node*> m_leafOrder{}; ///< Узлы задач в порядке обхода
+    mutable FenwickTree m_progressSums{};     ///< Прогресс задач в порядке обхода
+    mutable FenwickTree m_runningCounts{};    ///< Выполняющиеся задачи в порядке обхода
+    mutable bool m_aggregatesDirty{true};     ///< Нумерация устарела после изменения состава
+    quint32 m_resyncMark{0};                  ///< Отметка задач при последней сверке с моделью
+};
@@ -0,0 +1,193 @@
+#include "workloadreplayer.h"
+#include "monotonicclock.h"
+#include "taskmodel.h"
+#include "taskproxymodel.h"
+#include <QListView>
+#include <QScrollBar>
+#include <QTimer>
+#include <limits>
+
+WorkloadReplayer::WorkloadReplayer(TaskModel *model, TaskProxyModel *proxy, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_proxy(proxy)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &WorkloadReplayer::replayNext);
+}
+
+bool WorkloadReplayer::start(const QString &path, Speed speed, QString *error)
+{
+    QString loadError;
+    m_entries = WorkloadTrace::load(path, &loadError);
+    if (error)
+        *error = loadError;
+    if (m_entries.isEmpty() && !loadError.isEmpty())
+        return false;
+
+    m_cursor = 0;
+    m_speed = speed;
+    m_ids.clear();
+    m_report = Report();
+    m_report.traceUs = m_entries.isEmpty() ? 0 : m_entries.last().timeUs;
+    m_startNs = MonotonicClock::nsecs();
+    m_timer->start(0);
+    return true;
+}
+
+QStringList WorkloadReplayer::formatReport(const Report &report)
+{
+    QStringList lines;
+    lines.append(QString("%1 операций за %2 мс (трасса %3 мс), задач не найдено: %4")
+                     .arg(report.operations)
+                     .arg(report.wallNs / 1e6, 0, 'f', 1)
+                     .arg(report.traceUs / 1e3, 0, 'f', 1)
+                     .arg(report.missingTasks));
+    if (report.lag.count() > 0)
+    {
+        lines.append(QString("  опоздание: p50 %1 мс, p99 %2 мс, max %3 мс")
+                         .arg(report.lag.percentile(0.50) / 1e6, 0, 'f', 2)
+                         .arg(report.lag.percentile(0.99) / 1e6, 0, 'f', 2)
+                         .arg(report.lag.max() / 1e6, 0, 'f', 2));
+    }
+
+    for (int operation = 0; operation < WorkloadTrace::OperationCount; ++operation)
+    {
+        const LatencyHistogram &durations = report.durations[operation];
+        if (durations.count() == 0)
+            continue;
+        lines.append(QString("  %1 %2 x, всего %3 мс, p50 %4 мс, p99 %5 мс, max %6 мс")
+                         .arg(WorkloadTrace::operationName(static_cast<WorkloadTrace::Operation>(operation)), -7)
+                         .arg(durations.count(), 6)
+                         .arg(durations.sum() / 1e6, 0, 'f', 1)
+                         .arg(durations.percentile(0.50) / 1e6, 0, 'f', 2)
+                         .arg(durations.percentile(0.99) / 1e6, 0, 'f', 2)
+                         .arg(durations.max() / 1e6, 0, 'f', 2));
+    }
+    return lines;
+}
+
+void WorkloadReplayer::replayNext()
+{
+    // В исходном темпе выполняются все наступившие операции, с максимальной скоростью - одна
+    while (m_cursor < m_entries.count())
+    {
+        const WorkloadTrace::Entry &entry = m_entries.at(m_cursor);
+        const qint64 now = MonotonicClock::nsecs();
+        if (m_speed == Original)
+        {
+            const qint64 dueNs = m_startNs + entry.timeUs * 1000;
+            if (dueNs > now)
+            {
+                m_timer->start(static_cast<int>(qMin<qint64>((dueNs - now + 999999) / 1000000,
+                                                             std::numeric_limits<int>::max())));
+                return;
+            }
+            m_report.lag.record(now - dueNs);
+        }
+
+        execute(entry);
+        m_report.durations[entry.operation].record(MonotonicClock::nsecs() - now);
+        ++m_report.operations;
+        ++m_cursor;
+        emit operationReplayed(entry.operation, entry.value, m_cursor, static_cast<int>(m_entries.count()));
+
+        if (m_speed == Maximum && m_cursor < m_entries.count())
+        {
+            m_timer->start(0);
+            return;
+        }
+    }
+
+    m_report.wallNs = MonotonicClock::nsecs() - m_startNs;
+    m_entries.clear();
+    m_cursor = 0;
+    emit finished();
+}
+
+void WorkloadReplayer::execute(const WorkloadTrace::Entry &entry)
+{
+    switch (entry.operation)
+    {
+    case WorkloadTrace::Add:
+    {
+        const QList<quint64> ids = m_model->addTasks(entry.names);
+        for (int i = 0; i < ids.count() && i < entry.ids.count(); ++i)
+        {
+            if (ids.at(i) != 0)
+                m_ids.insert(entry.ids.at(i), ids.at(i));
+        }
+        break;
+    }
+    case WorkloadTrace::Restore:
+    {
+        QList<SessionSnapshot::Entry> restored;
+        restored.reserve(entry.names.count());
+        for (int i = 0; i < entry.names.count(); ++i)
+        {
+            restored.append({entry.names.at(i), QDateTime::fromMSecsSinceEpoch(entry.datesMs.value(i)),
+                             entry.progress.value(i)});
+        }
+        const QList<quint64> ids = m_model->restoreTasks(restored);
+        for (int i = 0; i < ids.count() && i < entry.ids.count(); ++i)
+        {
+            if (ids.at(i) != 0)
+                m_ids.insert(entry.ids.at(i), ids.at(i));
+        }
+        break;
+    }
+    case WorkloadTrace::Remove:
+        m_model->removeTasks(rowsOf(entry.ids));
+        break;
+    case WorkloadTrace::Start:
+        m_model->startTasks(rowsOf(entry.ids));
+        break;
+    case WorkloadTrace::Stop:
+        m_model->stopTasks(rowsOf(entry.ids));
+        break;
+    case WorkloadTrace::Filter:
+        m_proxy->setFilterType(static_cast<TaskProxyModel::FilterType>(entry.value));
+        break;
+    case WorkloadTrace::Sort:
+        m_proxy->setSortMode(static_cast<TaskProxyModel::SortMode>(entry.value));
+        break;
+    case WorkloadTrace::Scroll:
+        scrollTo(entry.value);
+        break;
+    default:
+        break;
+    }
+}
+
+QList<int> WorkloadReplayer::rowsOf(const QList<quint64> &ids)
+{
+    QList<int> rows;
+    rows.reserve(ids.count());
+    for (quint64 id : ids)
+    {
+        const int row = m_model->rowOfTask(m_ids.value(id));
+        if (row >= 0)
+            rows.append(row);
+        else
+            ++m_report.missingTasks;
+    }
+    return rows;
+}
+
+void WorkloadReplayer::scrollTo(int firstRow)
+{
+    if (m_view)
+    {
+        m_view->verticalScrollBar()->setValue(firstRow);
+        return;
+    }
+
+    // Без окна видимыми считаются строки прокси, начиная с firstRow
+    QList<int> rows;
+    const int lastRow = qMin(firstRow + HEADLESS_VIEWPORT_ROWS, m_proxy->rowCount());
+    for (int row = qMax(0, firstRow); row < lastRow; ++row)
+        rows.append(m_proxy->mapToSource(m_proxy->index(row, 0)).row());
+    m_model->setViewportRows(rows);
+}
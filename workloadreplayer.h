@@ -0,0 +1,158 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <array>
+#include "latencyhistogram.h"
+#include "workloadtrace.h"
+
+class QListView;
+class QTimer;
+class TaskModel;
+class TaskProxyModel;
+
+/**
+ * @class WorkloadReplayer
+ * @brief Воспроизведение трассы WorkloadTrace
+ *
+ * Выполняет операции трассы над моделью и прокси-моделью в исходном темпе
+ * или с максимальной скоростью. Между операциями управление возвращается
+ * циклу событий, поэтому отложенная работа модели и отрисовка списка
+ * выполняются так же, как при записи.
+ *
+ * Идентификаторы задач трассы сопоставляются с идентификаторами,
+ * выданными при воспроизведении добавления. Задачи-команды
+ * воспроизводятся как обычные задачи. Прокрутка выполняется полосой
+ * прокрутки представления (setView()), а без представления - передачей
+ * модели HEADLESS_VIEWPORT_ROWS видимых строк.
+ */
+class WorkloadReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Количество видимых строк при воспроизведении без представления
+    static constexpr int HEADLESS_VIEWPORT_ROWS = 20;
+
+    /**
+     * @enum Speed
+     * @brief Темп воспроизведения
+     */
+    enum Speed {
+        Original,  ///< С исходными интервалами между операциями
+        Maximum    ///< Операции подряд, по одной за итерацию цикла событий
+    };
+
+    /**
+     * @struct Report
+     * @brief Итоги воспроизведения
+     */
+    struct Report
+    {
+        std::array<LatencyHistogram, WorkloadTrace::OperationCount> durations{}; ///< Длительность операций по типам (нс)
+        LatencyHistogram lag{};   ///< Опоздание операций относительно трассы (нс, только Original)
+        qint64 traceUs{0};        ///< Длительность записанной трассы (мкс)
+        qint64 wallNs{0};         ///< Длительность воспроизведения (нс)
+        int operations{0};        ///< Выполнено операций
+        int missingTasks{0};      ///< Задачи операций, не найденные в модели
+    };
+
+    /**
+     * @brief Конструктор
+     * @param model Модель задач
+     * @param proxy Прокси-модель представления
+     * @param parent Родительский объект
+     */
+    WorkloadReplayer(TaskModel *model, TaskProxyModel *proxy, QObject *parent = nullptr);
+
+    /**
+     * @brief Задать представление для воспроизведения прокрутки
+     * @param view Список задач (nullptr - без представления)
+     */
+    void setView(QListView *view) { m_view = view; }
+
+    /**
+     * @brief Прочитать трассу и начать воспроизведение
+     * @param path Путь к файлу трассы
+     * @param speed Темп воспроизведения
+     * @param error Описание ошибки (выходной параметр, может быть nullptr)
+     * @return false если трассу не удалось прочитать
+     *
+     * Оборванная трасса воспроизводится до места обрыва; error при этом
+     * описывает обрыв.
+     */
+    bool start(const QString &path, Speed speed, QString *error = nullptr);
+
+    /**
+     * @brief Проверить, идёт ли воспроизведение
+     * @return true если остались невыполненные операции
+     */
+    bool isRunning() const { return m_cursor < m_entries.count(); }
+
+    /**
+     * @brief Получить итоги воспроизведения
+     * @return Итоги (во время воспроизведения - промежуточные)
+     */
+    const Report &report() const { return m_report; }
+
+    /**
+     * @brief Сформировать текстовый отчёт
+     * @param report Итоги воспроизведения
+     * @return Строки отчёта: общие итоги и перцентили по типам операций
+     */
+    static QStringList formatReport(const Report &report);
+
+signals:
+    /**
+     * @brief Сигнал о выполненной операции
+     * @param operation Тип операции
+     * @param value Значение операции представления
+     * @param done Выполнено операций
+     * @param total Всего операций в трассе
+     */
+    void operationReplayed(WorkloadTrace::Operation operation, int value, int done, int total);
+
+    /**
+     * @brief Сигнал о завершении воспроизведения
+     */
+    void finished();
+
+private slots:
+    /**
+     * @brief Выполнить наступившие операции и запланировать следующую
+     */
+    void replayNext();
+
+private:
+    /**
+     * @brief Выполнить одну операцию
+     * @param entry Операция трассы
+     */
+    void execute(const WorkloadTrace::Entry &entry);
+
+    /**
+     * @brief Найти строки задач трассы
+     * @param ids Идентификаторы задач трассы
+     * @return Строки исходной модели
+     */
+    QList<int> rowsOf(const QList<quint64> &ids);
+
+    /**
+     * @brief Прокрутить список к строке
+     * @param firstRow Первая видимая строка прокси-модели
+     */
+    void scrollTo(int firstRow);
+
+    TaskModel *m_model;                      ///< Модель задач
+    TaskProxyModel *m_proxy;                 ///< Прокси-модель
+    QPointer<QListView> m_view;              ///< Представление (nullptr - без окна)
+    QTimer *m_timer{nullptr};                ///< Таймер следующей операции
+    QList<WorkloadTrace::Entry> m_entries{}; ///< Операции трассы
+    int m_cursor{0};                         ///< Следующая операция
+    Speed m_speed{Original};                 ///< Темп воспроизведения
+    qint64 m_startNs{0};                     ///< Начало воспроизведения (MonotonicClock, нс)
+    QHash<quint64, quint64> m_ids{};         ///< Идентификаторы трассы -> идентификаторы модели
+    Report m_report{};                       ///< Итоги воспроизведения
+};
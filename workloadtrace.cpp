@@ -0,0 +1,242 @@
+#include "workloadtrace.h"
+#include "monotonicclock.h"
+#include <algorithm>
+#include <cstring>
+
+WorkloadTrace *WorkloadTrace::s_active = nullptr;
+
+namespace {
+
+/// Прочитать число varint; false при выходе за конец данных
+bool readVarint(const char *&cursor, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7)
+    {
+        const quint8 byte = static_cast<quint8>(*cursor++);
+        value |= quint64(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+WorkloadTrace::WorkloadTrace(const QString &path)
+    : m_file(path)
+{
+}
+
+WorkloadTrace::~WorkloadTrace()
+{
+    stop();
+}
+
+bool WorkloadTrace::start()
+{
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    m_file.write(MAGIC, static_cast<qint64>(std::strlen(MAGIC)));
+    writeVarint(FORMAT_VERSION);
+
+    m_startNs = MonotonicClock::nsecs();
+    m_lastUs = 0;
+    m_recorded = 0;
+    s_active = this;
+    return true;
+}
+
+void WorkloadTrace::stop()
+{
+    if (s_active == this)
+        s_active = nullptr;
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+QList<WorkloadTrace::Entry> WorkloadTrace::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = file.errorString();
+        return {};
+    }
+
+    const QByteArray data = file.readAll();
+    const char *cursor = data.constData();
+    const char *end = cursor + data.size();
+
+    const qint64 magicSize = static_cast<qint64>(std::strlen(MAGIC));
+    quint64 version = 0;
+    if (data.size() < magicSize || std::memcmp(cursor, MAGIC, magicSize) != 0)
+    {
+        if (error)
+            *error = "Неверная сигнатура трассы";
+        return {};
+    }
+    cursor += magicSize;
+    // Трассы версии 1 отличаются только отсутствием операции Restore
+    if (!readVarint(cursor, end, version) || version < 1 || version > FORMAT_VERSION)
+    {
+        if (error)
+            *error = QString("Неподдерживаемая версия трассы %1").arg(version);
+        return {};
+    }
+
+    QList<Entry> entries;
+    qint64 timeUs = 0;
+    while (cursor < end)
+    {
+        Entry entry;
+        const quint8 operation = static_cast<quint8>(*cursor++);
+        quint64 delta = 0;
+        bool ok = operation < OperationCount && readVarint(cursor, end, delta);
+        timeUs += static_cast<qint64>(delta);
+        entry.timeUs = timeUs;
+        entry.operation = static_cast<Operation>(operation);
+
+        quint64 value = 0;
+        if (ok && (entry.operation == Filter || entry.operation == Sort || entry.operation == Scroll))
+        {
+            ok = readVarint(cursor, end, value);
+            entry.value = static_cast<int>(value);
+        }
+        else if (ok)
+        {
+            quint64 count = 0;
+            ok = readVarint(cursor, end, count) && count <= quint64(end - cursor);
+            entry.ids.reserve(static_cast<int>(count));
+
+            // Идентификаторы Add и Restore хранятся в порядке добавления, остальные - приращениями
+            const bool added = entry.operation == Add || entry.operation == Restore;
+            quint64 id = 0;
+            for (quint64 i = 0; ok && i < count; ++i)
+            {
+                ok = readVarint(cursor, end, value);
+                id = added ? value : id + value;
+                entry.ids.append(id);
+
+                if (ok && added)
+                {
+                    quint64 length = 0;
+                    ok = readVarint(cursor, end, length) && length <= quint64(end - cursor);
+                    if (ok)
+                    {
+                        entry.names.append(QString::fromUtf8(cursor, static_cast<int>(length)));
+                        cursor += length;
+                    }
+                }
+                if (ok && entry.operation == Restore)
+                {
+                    quint64 dateMs = 0;
+                    quint64 progress = 0;
+                    ok = readVarint(cursor, end, dateMs) && readVarint(cursor, end, progress);
+                    entry.datesMs.append(static_cast<qint64>(dateMs));
+                    entry.progress.append(static_cast<int>(progress));
+                }
+            }
+        }
+
+        if (!ok)
+        {
+            // Запись прервана (например, при аварийном завершении) - возвращаем прочитанное
+            if (error)
+                *error = QString("Трасса обрывается после %1 операций").arg(entries.count());
+            break;
+        }
+        entries.append(std::move(entry));
+    }
+    return entries;
+}
+
+QString WorkloadTrace::operationName(Operation operation)
+{
+    switch (operation)
+    {
+    case Add:
+        return "add";
+    case Remove:
+        return "remove";
+    case Start:
+        return "start";
+    case Stop:
+        return "stop";
+    case Filter:
+        return "filter";
+    case Sort:
+        return "sort";
+    case Scroll:
+        return "scroll";
+    case Restore:
+        return "restore";
+    default:
+        return "unknown";
+    }
+}
+
+void WorkloadTrace::writeHeader(Operation operation)
+{
+    const qint64 nowUs = (MonotonicClock::nsecs() - m_startNs) / 1000;
+    const char type = static_cast<char>(operation);
+    m_file.write(&type, 1);
+    writeVarint(static_cast<quint64>(qMax<qint64>(0, nowUs - m_lastUs)));
+    m_lastUs = qMax(m_lastUs, nowUs);
+    ++m_recorded;
+}
+
+void WorkloadTrace::writeAdd(const QList<quint64> &ids, const QStringList &names,
+                             const QList<qint64> *datesMs, const QList<int> *progress)
+{
+    writeHeader(datesMs ? Restore : Add);
+    writeVarint(static_cast<quint64>(ids.count()));
+    for (int i = 0; i < ids.count(); ++i)
+    {
+        const QByteArray name = names.value(i).toUtf8();
+        writeVarint(ids.at(i));
+        writeVarint(static_cast<quint64>(name.size()));
+        m_file.write(name);
+        if (datesMs)
+        {
+            writeVarint(static_cast<quint64>(datesMs->value(i)));
+            writeVarint(static_cast<quint64>(qMax(0, progress->value(i))));
+        }
+    }
+}
+
+void WorkloadTrace::writeIds(Operation operation, QList<quint64> ids)
+{
+    // Упорядоченные идентификаторы кодируются короткими приращениями
+    std::sort(ids.begin(), ids.end());
+
+    writeHeader(operation);
+    writeVarint(static_cast<quint64>(ids.count()));
+    quint64 previous = 0;
+    for (quint64 id : std::as_const(ids))
+    {
+        writeVarint(id - previous);
+        previous = id;
+    }
+}
+
+void WorkloadTrace::writeValue(Operation operation, int value)
+{
+    writeHeader(operation);
+    writeVarint(static_cast<quint64>(qMax(0, value)));
+}
+
+void WorkloadTrace::writeVarint(quint64 value)
+{
+    char buffer[10];
+    int size = 0;
+    while (value >= 0x80)
+    {
+        buffer[size++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = static_cast<char>(value);
+    m_file.write(buffer, size);
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class WorkloadTrace
+ * @brief Запись операций пользователя над задачами для воспроизведения
+ *
+ * Фиксирует операции над TaskModel и TaskManager (добавление, восстановление
+ * из снимка сессии, удаление, запуск, остановка, смена фильтра и сортировки,
+ * прокрутка) с монотонными
+ * временными метками в компактный двоичный файл. Записанную трассу
+ * воспроизводит WorkloadReplayer.
+ *
+ * Формат: заголовок MAGIC и FORMAT_VERSION, затем записи "тип (1 байт),
+ * приращение времени (мкс, varint), данные". Задачи идентифицируются
+ * идентификаторами модели; списки идентификаторов хранятся упорядоченными
+ * приращениями varint, названия - в UTF-8 с длиной varint. Восстановленные
+ * задачи дополнительно хранят дату создания и прогресс, чтобы воспроизведение
+ * начиналось с того же состояния.
+ *
+ * Когда запись не активна, точка записи сводится к проверке одного
+ * указателя; списки для записи строятся только при isActive().
+ */
+class WorkloadTrace
+{
+public:
+    /// Сигнатура файла трассы
+    static constexpr char MAGIC[] = "DRWTRACE";
+
+    /// Версия формата
+    static constexpr quint32 FORMAT_VERSION = 2;
+
+    /**
+     * @enum Operation
+     * @brief Типы операций
+     */
+    enum Operation : quint8 {
+        Add,     ///< Добавление задач (идентификаторы и названия)
+        Remove,  ///< Удаление задач
+        Start,   ///< Запуск задач
+        Stop,    ///< Остановка задач
+        Filter,  ///< Смена фильтра (TaskProxyModel::FilterType)
+        Sort,    ///< Смена сортировки (TaskProxyModel::SortMode)
+        Scroll,  ///< Прокрутка списка (первая видимая строка)
+        Restore, ///< Восстановление задач из снимка (идентификаторы, названия, даты, прогресс; с версии 2)
+        OperationCount
+    };
+
+    /**
+     * @struct Entry
+     * @brief Прочитанная операция трассы
+     */
+    struct Entry
+    {
+        qint64 timeUs{0};          ///< Время от начала записи (мкс)
+        Operation operation{Add};  ///< Тип операции
+        int value{0};              ///< Значение для Filter, Sort и Scroll
+        QList<quint64> ids{};      ///< Идентификаторы задач
+        QStringList names{};       ///< Названия добавленных задач (для Add и Restore)
+        QList<qint64> datesMs{};   ///< Даты создания, мс от эпохи (для Restore)
+        QList<int> progress{};     ///< Прогресс задач (для Restore)
+    };
+
+    /**
+     * @brief Конструктор
+     * @param path Путь к файлу трассы
+     */
+    explicit WorkloadTrace(const QString &path);
+
+    /**
+     * @brief Деструктор
+     *
+     * Завершает запись, если она активна.
+     */
+    ~WorkloadTrace();
+
+    WorkloadTrace(const WorkloadTrace &) = delete;
+    WorkloadTrace &operator=(const WorkloadTrace &) = delete;
+
+    /**
+     * @brief Открыть файл и сделать запись активной
+     * @return false если файл не удалось открыть
+     */
+    bool start();
+
+    /**
+     * @brief Завершить запись и закрыть файл
+     */
+    void stop();
+
+    /**
+     * @brief Получить описание последней ошибки
+     * @return Текст ошибки
+     */
+    QString errorString() const { return m_file.errorString(); }
+
+    /**
+     * @brief Получить количество записанных операций
+     * @return Количество операций
+     */
+    qint64 recorded() const { return m_recorded; }
+
+    /**
+     * @brief Проверить, ведётся ли запись
+     * @return true если есть активная трасса
+     */
+    static bool isActive() { return s_active != nullptr; }
+
+    /**
+     * @brief Записать добавление задач
+     * @param ids Идентификаторы добавленных задач
+     * @param names Названия добавленных задач
+     */
+    static void recordAdd(const QList<quint64> &ids, const QStringList &names)
+    {
+        if (Q_UNLIKELY(s_active != nullptr))
+            s_active->writeAdd(ids, names);
+    }
+
+    /**
+     * @brief Записать восстановление задач из снимка сессии
+     * @param ids Идентификаторы восстановленных задач
+     * @param names Названия
+     * @param datesMs Даты создания (мс от эпохи)
+     * @param progress Прогресс
+     */
+    static void recordRestore(const QList<quint64> &ids, const QStringList &names,
+                              const QList<qint64> &datesMs, const QList<int> &progress)
+    {
+        if (Q_UNLIKELY(s_active != nullptr))
+            s_active->writeAdd(ids, names, &datesMs, &progress);
+    }
+
+    /**
+     * @brief Записать операцию над задачами
+     * @param operation Remove, Start или Stop
+     * @param ids Идентификаторы задач
+     */
+    static void record(Operation operation, QList<quint64> ids)
+    {
+        if (Q_UNLIKELY(s_active != nullptr))
+            s_active->writeIds(operation, std::move(ids));
+    }
+
+    /**
+     * @brief Записать операцию представления
+     * @param operation Filter, Sort или Scroll
+     * @param value Значение
+     */
+    static void record(Operation operation, int value)
+    {
+        if (Q_UNLIKELY(s_active != nullptr))
+            s_active->writeValue(operation, value);
+    }
+
+    /**
+     * @brief Прочитать трассу
+     * @param path Путь к файлу трассы
+     * @param error Описание ошибки (выходной параметр, может быть nullptr)
+     * @return Операции в порядке записи; при ошибке - прочитанные до неё
+     */
+    static QList<Entry> load(const QString &path, QString *error = nullptr);
+
+    /**
+     * @brief Получить название операции для отчётов
+     * @param operation Тип операции
+     * @return Название
+     */
+    static QString operationName(Operation operation);
+
+private:
+    /**
+     * @brief Записать заголовок операции
+     * @param operation Тип операции
+     */
+    void writeHeader(Operation operation);
+
+    /**
+     * @brief Записать добавление или восстановление задач
+     * @param datesMs Даты создания для Restore (nullptr - операция Add)
+     * @param progress Прогресс для Restore
+     */
+    void writeAdd(const QList<quint64> &ids, const QStringList &names,
+                  const QList<qint64> *datesMs = nullptr, const QList<int> *progress = nullptr);
+
+    /**
+     * @brief Записать операцию над задачами
+     */
+    void writeIds(Operation operation, QList<quint64> ids);
+
+    /**
+     * @brief Записать операцию представления
+     */
+    void writeValue(Operation operation, int value);
+
+    /**
+     * @brief Дописать беззнаковое число в формате varint
+     * @param value Число
+     */
+    void writeVarint(quint64 value);
+
+    static WorkloadTrace *s_active;  ///< Активная трасса или nullptr
+
+    QFile m_file;              ///< Файл трассы
+    qint64 m_startNs{0};       ///< Начало записи (MonotonicClock, нс)
+    qint64 m_lastUs{0};        ///< Время предыдущей операции (мкс от начала)
+    qint64 m_recorded{0};      ///< Записано операций
+};